@@ -0,0 +1,194 @@
+#include "bplustree.h"
+#include "datagen.h"
+#include "parallel_build.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Suíte de benchmark da BPlusTree sobre dados sintéticos: para cada tamanho
+// de CSV gerado e cada carga (inc, bus, range, mixed), sorteia a sequência de
+// comandos, grava-a no formato de entrada do main e a executa direto na
+// árvore. Cada linha da saída (CSV) traz vazão, latências p50/p99 por
+// comando, contadores de E/S de TreeStats e o tamanho final do índice.
+//
+// As cargas bus, range e mixed começam com o índice completo (carga em bloco,
+// como BUILD:1); inc começa vazio. Um INC insere todas as linhas da chave,
+// como no main, mas as linhas vêm de um mapa em memória em vez de uma leitura
+// do CSV por comando, para medir só a árvore.
+//
+// Uso: ./suite [--rows 10000,100000] [--dup 0.99] [--skew 0]
+//              [--workloads inc,bus,range,mixed] [--ops 200] [--page 4096]
+//              [--seed 1] [--keep]
+
+using Clock = chrono::steady_clock;
+
+static double elapsedMicros(Clock::time_point start) {
+  return chrono::duration<double, micro>(Clock::now() - start).count();
+}
+
+static vector<string> splitList(const string &list) {
+  vector<string> items;
+  stringstream ss(list);
+  string item;
+  while (getline(ss, item, ','))
+    if (!item.empty())
+      items.push_back(item);
+  return items;
+}
+
+static double percentile(vector<double> &sortedSamples, double fraction) {
+  if (sortedSamples.empty())
+    return 0.0;
+  size_t n = sortedSamples.size();
+  size_t index = static_cast<size_t>(ceil(fraction * static_cast<double>(n)));
+  return sortedSamples[min(n - 1, index > 0 ? index - 1 : 0)];
+}
+
+static void runWorkload(const DatasetSpec &spec, Workload workload,
+                        long long operations, int pageSize,
+                        const string &csvPath,
+                        const vector<pair<int, RecordPointer>> &entries,
+                        bool keepFiles) {
+  string indexPath = "suite_index.txt";
+  filesystem::remove(indexPath);
+  bool startWithBuild = workload != Workload::INSERT;
+  vector<BenchCommand> commands = generateCommands(workload, operations, spec);
+  string commandsPath = "suite_cmds_" + to_string(spec.rows) + "_" +
+                        workloadName(workload) + ".txt";
+  writeCommandFile(commandsPath, "PAG/" + to_string(pageSize), startWithBuild,
+                   commands);
+
+  vector<double> latencies;
+  latencies.reserve(commands.size());
+  TreeStats before, after;
+  double totalMicros = 0.0;
+  {
+    BPlusTree tree(0, indexPath, csvPath, pageSize);
+    if (startWithBuild)
+      tree.bulkLoad(entries);
+    before = tree.getStats();
+    auto byKey = [](const pair<int, RecordPointer> &e, int key) {
+      return e.first < key;
+    };
+    auto total = Clock::now();
+    for (const BenchCommand &c : commands) {
+      auto start = Clock::now();
+      if (c.type == 'I') {
+        for (auto it = lower_bound(entries.begin(), entries.end(), c.key, byKey);
+             it != entries.end() && it->first == c.key; ++it) {
+          tree.insert(it->first, it->second);
+        }
+      } else if (c.type == 'B') {
+        tree.search(c.key);
+      } else {
+        tree.countRange(c.key, c.highKey);
+      }
+      latencies.push_back(elapsedMicros(start));
+    }
+    totalMicros = elapsedMicros(total);
+    after = tree.getStats();
+  }
+  sort(latencies.begin(), latencies.end());
+
+  cout << spec.rows << "," << spec.distinctKeys() << "," << spec.skew << ","
+       << workloadName(workload) << "," << commands.size() << ","
+       << (totalMicros > 0 ? commands.size() * 1e6 / totalMicros : 0.0) << ","
+       << percentile(latencies, 0.50) << "," << percentile(latencies, 0.99)
+       << "," << after.nodeReads - before.nodeReads << ","
+       << after.nodeWrites - before.nodeWrites << ","
+       << after.bytesRead - before.bytesRead << ","
+       << after.bytesWritten - before.bytesWritten << ","
+       << filesystem::file_size(indexPath) << endl;
+  filesystem::remove(indexPath);
+  if (!keepFiles)
+    filesystem::remove(commandsPath);
+}
+
+int main(int argc, char *argv[]) {
+  vector<long long> rowCounts = {10000};
+  vector<Workload> workloads = {Workload::INSERT, Workload::SEARCH,
+                                Workload::RANGE, Workload::MIXED};
+  DatasetSpec spec;
+  long long operations = 200;
+  int pageSize = 4096;
+  bool keepFiles = false;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      string option = argv[i];
+      string value = i + 1 < argc ? argv[i + 1] : "";
+      if (option == "--keep") {
+        keepFiles = true;
+        continue;
+      }
+      if (value.empty()) {
+        cerr << "Erro: Opção sem valor: " << option << endl;
+        return 1;
+      }
+      ++i;
+      if (option == "--rows") {
+        rowCounts.clear();
+        for (const string &item : splitList(value))
+          rowCounts.push_back(stoll(item));
+      } else if (option == "--dup") {
+        spec.duplicateRatio = stod(value);
+      } else if (option == "--skew") {
+        spec.skew = stod(value);
+      } else if (option == "--workloads") {
+        workloads.clear();
+        for (const string &item : splitList(value)) {
+          Workload w;
+          if (!parseWorkload(item, w)) {
+            cerr << "Erro: Carga desconhecida: " << item << endl;
+            return 1;
+          }
+          workloads.push_back(w);
+        }
+      } else if (option == "--ops") {
+        operations = stoll(value);
+      } else if (option == "--page") {
+        pageSize = stoi(value);
+      } else if (option == "--seed") {
+        spec.seed = static_cast<unsigned>(stoul(value));
+      } else {
+        cerr << "Aviso: Opção desconhecida: " << option << endl;
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Erro ao analisar as opções: " << e.what() << endl;
+    return 1;
+  }
+  if (!BPlusTree::isValidPageSize(pageSize)) {
+    cerr << "Erro: tamanho de página inválido: " << pageSize << endl;
+    return 1;
+  }
+
+  cout << "linhas,chaves_distintas,skew,carga,operacoes,ops_por_s,p50_us,"
+          "p99_us,nos_lidos,nos_gravados,bytes_lidos,bytes_gravados,"
+          "bytes_indice"
+       << endl;
+  int threads = max(1u, thread::hardware_concurrency());
+  for (long long rows : rowCounts) {
+    spec.rows = rows;
+    string csvPath = "suite_vinhos_" + to_string(rows) + ".csv";
+    auto start = Clock::now();
+    if (!generateWinesCsv(csvPath, spec))
+      return 1;
+    vector<pair<int, RecordPointer>> entries =
+        mergeSortedRuns(extractSortedRuns(csvPath, threads));
+    cerr << rows << " linhas geradas e ordenadas em "
+         << elapsedMicros(start) / 1000.0 << " ms (" << csvPath << ")"
+         << endl;
+    for (Workload workload : workloads)
+      runWorkload(spec, workload, operations, pageSize, csvPath, entries,
+                  keepFiles);
+    if (!keepFiles)
+      filesystem::remove(csvPath);
+  }
+  return 0;
+}
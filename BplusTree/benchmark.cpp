@@ -0,0 +1,244 @@
+#include "bplustree.h"
+#include "learned_index.h"
+#include "leaf_encoding.h"
+#include "memtree.h"
+#include "parallel_build.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Benchmark de compressão de folhas: constrói o mesmo índice sobre
+// ano_colheita de vinhos.csv com folhas em texto e com folhas comprimidas, e
+// compara tamanho do arquivo, número de folhas, altura, tempo de construção e
+// tempo de busca. Mede também o custo isolado de codificar/decodificar folhas
+// e compara com a árvore em memória (construção, snapshot e busca), com o
+// índice aprendido (memória e busca) e o tempo da construção paralela
+// (extração + ordenação + carga em bloco) por número de threads.
+//
+// Uso: ./bench [vinhos.csv] [tamanho_da_pagina]
+
+using Clock = chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start) {
+  return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// Lê (ano_colheita, número da linha) de todas as linhas do CSV.
+static vector<pair<int, RecordPointer>> loadEntries(const string &csvPath) {
+  vector<pair<int, RecordPointer>> entries;
+  ifstream csv(csvPath);
+  string line;
+  RecordPointer lineNumber = 0;
+  if (getline(csv, line))
+    lineNumber++; // cabeçalho
+  while (getline(csv, line)) {
+    lineNumber++;
+    stringstream ss(line);
+    string field;
+    for (int col = 0; col <= 2 && getline(ss, field, ','); ++col) {
+      if (col == 2) {
+        try {
+          entries.push_back({stoi(field), lineNumber});
+        } catch (const exception &) {
+        }
+      }
+    }
+  }
+  return entries;
+}
+
+static void runTree(const string &label, bool compress, int pageSize,
+                    const string &csvPath,
+                    const vector<pair<int, RecordPointer>> &entries,
+                    const vector<int> &distinctKeys) {
+  string indexPath = "bench_index_" + label + ".txt";
+  filesystem::remove(indexPath);
+
+  auto start = Clock::now();
+  {
+    BPlusTree tree(0, indexPath, csvPath, pageSize, compress);
+    for (const auto &e : entries)
+      tree.insert(e.first, e.second);
+  }
+  double buildMs = elapsedMs(start);
+
+  BPlusTree tree(0, indexPath, csvPath, pageSize, compress);
+  LayoutStats layout = tree.computeLayoutStats();
+  start = Clock::now();
+  size_t found = 0;
+  for (int key : distinctKeys)
+    found += tree.search(key).size();
+  double searchMs = elapsedMs(start);
+
+  cout << label << "," << pageSize << "," << filesystem::file_size(indexPath)
+       << "," << layout.leafCount << "," << layout.height << "," << buildMs
+       << "," << searchMs * 1000.0 / max<size_t>(1, distinctKeys.size())
+       << "," << found << endl;
+}
+
+// Árvore em memória com a mesma ordem da árvore em disco: a linha do CSV usa
+// o tamanho do snapshot como bytes do índice (folhas e altura ficam vazias).
+static void runMemTree(int pageSize, const vector<pair<int, RecordPointer>> &entries,
+                       const vector<int> &distinctKeys) {
+  string snapshotPath = "bench_index_memoria.snap";
+  auto start = Clock::now();
+  MemBPlusTree built(BPlusTree::orderForPageSize(pageSize));
+  for (const auto &e : entries)
+    built.insert(e.first, e.second);
+  double buildMs = elapsedMs(start);
+
+  start = Clock::now();
+  built.saveSnapshot(snapshotPath);
+  double saveMs = elapsedMs(start);
+
+  start = Clock::now();
+  MemBPlusTree tree(3);
+  tree.loadSnapshot(snapshotPath);
+  double loadMs = elapsedMs(start);
+
+  start = Clock::now();
+  size_t found = 0;
+  for (int key : distinctKeys)
+    found += tree.search(key).size();
+  double searchMs = elapsedMs(start);
+
+  cout << "memoria," << pageSize << "," << filesystem::file_size(snapshotPath)
+       << ",,," << buildMs << ","
+       << searchMs * 1000.0 / max<size_t>(1, distinctKeys.size()) << ","
+       << found << endl;
+  cerr << "snapshot em memória: " << tree.memoryBytes()
+       << " bytes em arenas; gravação " << saveMs << " ms, carga " << loadMs
+       << " ms" << endl;
+}
+
+// Índice aprendido sobre as entradas ordenadas, comparado com a mesma
+// BPlusTree carregada em bloco: a linha do CSV usa os bytes em memória do
+// índice aprendido; a comparação com a árvore vai para stderr.
+static void runLearned(int pageSize, const string &csvPath,
+                       const vector<pair<int, RecordPointer>> &entries,
+                       const vector<int> &distinctKeys) {
+  vector<pair<int, RecordPointer>> sorted = entries;
+  sort(sorted.begin(), sorted.end());
+
+  auto start = Clock::now();
+  LearnedIndex learned;
+  learned.build(sorted);
+  double buildMs = elapsedMs(start);
+
+  // as buscas no índice aprendido levam menos de 1 us: repete para medir
+  const int rounds = 100;
+  start = Clock::now();
+  size_t found = 0;
+  for (int r = 0; r < rounds; ++r) {
+    found = 0;
+    for (int key : distinctKeys)
+      found += learned.search(key).size();
+  }
+  double searchMs = elapsedMs(start) / rounds;
+
+  string indexPath = "bench_index_aprendido.txt";
+  filesystem::remove(indexPath);
+  BPlusTree tree(0, indexPath, csvPath, pageSize);
+  tree.bulkLoad(sorted);
+  start = Clock::now();
+  size_t treeFound = 0;
+  for (int key : distinctKeys)
+    treeFound += tree.search(key).size();
+  double treeSearchMs = elapsedMs(start);
+
+  size_t keyCount = max<size_t>(1, distinctKeys.size());
+  cout << "aprendido," << pageSize << "," << learned.memoryBytes() << ",,,"
+       << buildMs << "," << searchMs * 1000.0 / keyCount << "," << found
+       << endl;
+  cerr << "índice aprendido: " << learned.segmentCount()
+       << " segmento(s) com erro máximo " << learned.getMaxError() << ", "
+       << learned.memoryBytes() << " bytes em memória contra "
+       << filesystem::file_size(indexPath)
+       << " bytes da árvore carregada em bloco; busca "
+       << searchMs * 1000.0 / keyCount << " us contra "
+       << treeSearchMs * 1000.0 / keyCount << " us na árvore (" << treeFound
+       << " ponteiros)" << endl;
+}
+
+int main(int argc, char *argv[]) {
+  string csvPath = argc > 1 ? argv[1] : "vinhos.csv";
+  int pageSize = argc > 2 ? stoi(argv[2]) : 4096;
+  if (!BPlusTree::isValidPageSize(pageSize)) {
+    cerr << "Erro: tamanho de página inválido: " << pageSize << endl;
+    return 1;
+  }
+
+  vector<pair<int, RecordPointer>> entries = loadEntries(csvPath);
+  set<int> keySet;
+  for (const auto &e : entries)
+    keySet.insert(e.first);
+  vector<int> distinctKeys(keySet.begin(), keySet.end());
+  cerr << entries.size() << " entradas, " << distinctKeys.size()
+       << " chaves distintas" << endl;
+
+  cout << "modo,pagina,bytes_indice,folhas,altura,construcao_ms,busca_us_por_"
+          "chave,ponteiros_encontrados"
+       << endl;
+  runTree("texto", false, pageSize, csvPath, entries, distinctKeys);
+  runTree("comprimido", true, pageSize, csvPath, entries, distinctKeys);
+  runMemTree(pageSize, entries, distinctKeys);
+  runLearned(pageSize, csvPath, entries, distinctKeys);
+
+  // Construção paralela: extração e ordenação por bloco, intercalação e
+  // carga em bloco de uma árvore.
+  int maxThreads = max(1u, thread::hardware_concurrency());
+  for (int threads = 1; threads <= maxThreads; threads *= 2) {
+    string indexPath = "bench_index_paralelo.txt";
+    filesystem::remove(indexPath);
+    auto start = Clock::now();
+    vector<pair<int, RecordPointer>> merged =
+        mergeSortedRuns(extractSortedRuns(csvPath, threads));
+    double extractMs = elapsedMs(start);
+    {
+      BPlusTree tree(0, indexPath, csvPath, pageSize);
+      tree.bulkLoad(merged);
+    }
+    cerr << "construção paralela com " << threads << " thread(s): "
+         << merged.size() << " entradas, extração e ordenação " << extractMs
+         << " ms, total " << elapsedMs(start) << " ms" << endl;
+  }
+
+  // Custo isolado do codec: codifica e decodifica uma folha com as primeiras
+  // entradas ordenadas, repetidamente.
+  vector<pair<int, RecordPointer>> sorted = entries;
+  sort(sorted.begin(), sorted.end());
+  int n = min<int>(sorted.size(), BPlusTree::orderForPageSize(pageSize) - 1);
+  vector<int> keys;
+  vector<RecordPointer> pointers;
+  for (int i = 0; i < n; ++i) {
+    keys.push_back(sorted[i].first);
+    pointers.push_back(sorted[i].second);
+  }
+  const int rounds = 20000;
+  string bytes;
+  LeafEncoding encoding = chooseLeafEncoding(keys, pointers, n, bytes);
+  vector<int> outKeys;
+  vector<RecordPointer> outPointers;
+  auto start = Clock::now();
+  for (int r = 0; r < rounds; ++r)
+    decodeLeafEntries(bytes, n, encoding, outKeys, outPointers);
+  double decodeMs = elapsedMs(start);
+  start = Clock::now();
+  for (int r = 0; r < rounds; ++r)
+    chooseLeafEncoding(keys, pointers, n, bytes);
+  double encodeMs = elapsedMs(start);
+  cerr << "folha de " << n << " entradas: " << bytes.size() << " bytes ("
+       << static_cast<char>(encoding) << ") contra " << n * 8
+       << " bytes sem compressão; decodificação "
+       << decodeMs * 1000.0 / rounds << " us, codificação "
+       << encodeMs * 1000.0 / rounds << " us" << endl;
+  return 0;
+}
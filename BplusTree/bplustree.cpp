@@ -1,9 +1,12 @@
 #include "bplustree.h"
+#include <chrono>
 #include <filesystem> // Para filesystem::file_size
+#include <functional>
 #include <limits>
 #include <cmath> // Para ceil
-
-#define HEADER_LINES 2
+#include <climits>
+#include <map>
+#include <stdexcept>
 
 using namespace std;
 /**
@@ -14,13 +17,24 @@ using namespace std;
  * (número máximo de filhos para nós internos). indexFileName O nome do arquivo
  * que armazenará o índice da árvore B+ dataFileName O nome do arquivo CSV que
  * contém os dados a serem indexados (vinhos.csv)
+ * pageSize Tamanho da página em bytes; usado para derivar a ordem quando
+ * order é 0. Num arquivo existente a ordem vem do superbloco e é validada.
+ * compressLeafNodes Grava as folhas de um índice novo com chaves e ponteiros
+ * comprimidos (delta + varint ou frame of reference).
  */
 BPlusTree::BPlusTree(int order, const string &indexFileName,
-                     const string &dataFileName)
-    : treeOrder(order), rootNodeId(0), indexFilePath(indexFileName),
+                     const string &dataFileName, int pageSizeBytes,
+                     bool compressLeafNodes)
+    : treeOrder(order), pageSize(pageSizeBytes),
+      compressLeaves(compressLeafNodes),
+      pointerSize(pointerSizeFor(dataFileName)), pointerWidthWarned(false),
+      rootNodeId(0),
+      indexFilePath(indexFileName),
       dataFilePath(dataFileName),
       nextNodeIdCounter(
           1), // Contador para o ID do próximo nó a ser criado, começa em 1.
+      committedVersion(0), // Nenhuma inserção confirmada nesta sessão.
+      committedRootId(0),  // Publicada ao final do construtor.
       currentIndexNodeInRam(
           nullptr), // Ponteiro para o nó de índice atualmente em buffer (RAM).
       currentIndexNodeInRamId(0), // ID do nó de índice atualmente em buffer.
@@ -30,6 +44,15 @@ BPlusTree::BPlusTree(int order, const string &indexFileName,
                                     // atualmente em buffer.
       currentDataRecordInRamId(
           0) { // ID (número da linha) do registro de dados em buffer.
+  if (treeOrder > 0) {
+    pageSize = 0; // FLH/<ordem> sobrepõe o tamanho de página.
+  } else if (isValidPageSize(pageSize)) {
+    treeOrder = orderForPageSize(pageSize, pointerSize); // Fan-out máximo da página.
+  } else {
+    throw invalid_argument("Tamanho de página inválido: " +
+                           to_string(pageSize));
+  }
+
   initializeIndexFile(); // Garante que o arquivo de índice exista e tenha o
                          // cabeçalho básico.
 
@@ -38,7 +61,7 @@ BPlusTree::BPlusTree(int order, const string &indexFileName,
   if (!rootLine.empty() &&
       rootLine.rfind("ROOT_ID:", 0) == 0) { // rfind para verificar o prefixo
     try {
-      rootNodeId = stoi(rootLine.substr(8)); // Extrai o ID após "ROOT_ID:"
+      rootNodeId = stoll(rootLine.substr(8)); // Extrai o ID após "ROOT_ID:"
     } catch (const exception &e) {
       cerr << "Erro ao analisar ROOT_ID: " << e.what() << endl;
       rootNodeId = 0; // Fallback: considera que não há raiz se houver erro.
@@ -52,8 +75,7 @@ BPlusTree::BPlusTree(int order, const string &indexFileName,
   string nextIdLine = readLineFromFile(indexFilePath, 2);
   if (!nextIdLine.empty() && nextIdLine.rfind("NEXT_NODE_ID:", 0) == 0) {
     try {
-      nextNodeIdCounter = stoi(nextIdLine.substr(13)); // Extrai o ID após "NEXT_NODE_ID:"
-      cout << "nextNodeIdCounter: " << nextNodeIdCounter << endl;
+      nextNodeIdCounter = stoll(nextIdLine.substr(13)); // Extrai o ID após "NEXT_NODE_ID:"
     } catch (const exception &e) {
       cerr << "Erro ao analisar NEXT_NODE_ID: " << e.what() << endl;
       nextNodeIdCounter = 1; // Fallback: começa em 1 se houver erro.
@@ -62,15 +84,238 @@ BPlusTree::BPlusTree(int order, const string &indexFileName,
     nextNodeIdCounter = 1; // Se não houver linha NEXT_NODE_ID ou o arquivo
                            // acabou de ser inicializado.
   }
+
+  loadSuperblock(); // Ordem, tamanho de página e codificação gravados
+                    // prevalecem.
+
+  // Índices gravados antes das contagens por filho não as possuem; elas são
+  // recalculadas uma única vez a partir das folhas.
+  Node *root = accessNode(rootNodeId);
+  if (root && !root->isLeaf &&
+      root->childCounts.size() != root->childNodeIds.size()) {
+    rebuildSubtreeCounts(rootNodeId);
+  }
+  committedRootId = rootNodeId; // Versão 0: o índice como foi aberto.
+  headerOnDisk = formatHeaderLines(); // Os campos acabaram de ser lidos do arquivo
+}
+
+/**
+ * Calcula a maior ordem m tal que um nó cabe em uma página de pageSize bytes.
+ * Um nó interno ocupa o cabeçalho, (m-1) chaves e m pares (ponteiro de filho,
+ * contagem da subárvore); uma folha ocupa o cabeçalho, os ponteiros ant/prox
+ * e (m-1) pares chave/ponteiro de dados. Ponteiros e contagens têm
+ * pointerSize bytes. Retorna a menor das duas ordens.
+ */
+int BPlusTree::orderForPageSize(int pageSize, int pointerSize) {
+  int available = pageSize - NODE_HEADER_SIZE;
+  // Interno: (m-1)*KEY_SIZE + m*(2*pointerSize) <= available
+  int internalOrder = (available + KEY_SIZE) / (KEY_SIZE + 2 * pointerSize);
+  // Folha: 2*pointerSize + (m-1)*(KEY_SIZE+pointerSize) <= available
+  int leafOrder =
+      (available - 2 * pointerSize) / (KEY_SIZE + pointerSize) + 1;
+  return min(internalOrder, leafOrder);
+}
+
+/**
+ * Largura compacta de IDs e ponteiros para um índice novo: 4 bytes bastam
+ * enquanto o arquivo de dados tiver menos de 2 GB, pois nem o número de linhas
+ * nem o de nós do índice passa do tamanho do arquivo em bytes.
+ */
+int BPlusTree::pointerSizeFor(const string &dataFileName) {
+  error_code ec;
+  uintmax_t dataSize = filesystem::file_size(dataFileName, ec);
+  return !ec && dataSize > static_cast<uintmax_t>(INT_MAX) ? WIDE_POINTER_SIZE
+                                                           : NARROW_POINTER_SIZE;
+}
+
+/**
+ * Aceita potências de 2 entre 512 bytes e 64 KB (tipicamente 4, 8 ou 16 KB).
+ */
+bool BPlusTree::isValidPageSize(int pageSize) {
+  return pageSize >= 512 && pageSize <= 65536 &&
+         (pageSize & (pageSize - 1)) == 0;
+}
+
+/**
+ * Monta as linhas do cabeçalho (superbloco) do arquivo de índice, na ordem em
+ * que são gravadas: ROOT_ID, NEXT_NODE_ID, ORDER, PAGE_SIZE, KEY_SIZE,
+ * PTR_SIZE, LEAF_ENCODING e FREE_PAGES (IDs separados por vírgula).
+ */
+vector<string> BPlusTree::formatHeaderLines() const {
+  string freePages;
+  for (size_t i = 0; i < freePageIds.size(); ++i) {
+    freePages += (i > 0 ? "," : "") + to_string(freePageIds[i]);
+  }
+  return {"ROOT_ID:" + to_string(rootNodeId),
+          "NEXT_NODE_ID:" + to_string(nextNodeIdCounter),
+          "ORDER:" + to_string(treeOrder),
+          "PAGE_SIZE:" + to_string(pageSize),
+          "KEY_SIZE:" + to_string(KEY_SIZE),
+          "PTR_SIZE:" + to_string(pointerSize),
+          string("LEAF_ENCODING:") + (compressLeaves ? "COMPRESSED" : "PLAIN"),
+          "FREE_PAGES:" + freePages};
+}
+
+/**
+ * Lê o superbloco do arquivo de índice: as linhas "NOME:valor" do topo, antes
+ * da primeira linha de nó ("T;..."). Campos ausentes vêm de formatos antigos e
+ * recebem os valores atuais; nesse caso o cabeçalho é regravado completo. Num
+ * arquivo existente a ordem e a codificação gravadas prevalecem sobre as
+ * pedidas; o superbloco é rejeitado se as larguras de chave/ponteiro não
+ * baterem com as deste binário ou se a ordem não couber na página.
+ */
+void BPlusTree::loadSuperblock() {
+  map<string, string> fields;
+  int headerLinesInFile = 0;
+  ifstream file(indexFilePath);
+  string line;
+  while (getline(file, line)) {
+    size_t colonPos = line.find(':');
+    if (colonPos == string::npos || line.find(';') != string::npos)
+      break; // primeira linha de nó
+    fields[line.substr(0, colonPos)] = line.substr(colonPos + 1);
+    headerLinesInFile++;
+  }
+  file.close();
+
+  int storedOrder = treeOrder, storedPageSize = pageSize,
+      storedKeySize = KEY_SIZE, storedPtrSize = pointerSize;
+  bool storedCompressLeaves = compressLeaves;
+  try {
+    if (fields.count("ORDER")) {
+      // Sem ORDER o arquivo é do formato antigo e adota a ordem atual.
+      storedOrder = stoi(fields["ORDER"]);
+      storedPageSize = stoi(fields.at("PAGE_SIZE"));
+      storedKeySize = stoi(fields.at("KEY_SIZE"));
+      storedPtrSize = stoi(fields.at("PTR_SIZE"));
+    }
+    if (fields.count("LEAF_ENCODING")) {
+      storedCompressLeaves = fields["LEAF_ENCODING"] == "COMPRESSED";
+    }
+    freePageIds.clear();
+    stringstream freePages(fields["FREE_PAGES"]);
+    string freeId;
+    while (getline(freePages, freeId, ',')) {
+      freePageIds.push_back(stoll(freeId));
+    }
+  } catch (const exception &e) {
+    throw runtime_error("Superbloco corrompido em " + indexFilePath + ": " +
+                        e.what());
+  }
+
+  if (storedKeySize != KEY_SIZE || (storedPtrSize != NARROW_POINTER_SIZE &&
+                                    storedPtrSize != WIDE_POINTER_SIZE)) {
+    throw runtime_error("Larguras de chave/ponteiro do índice (" +
+                        to_string(storedKeySize) + "/" +
+                        to_string(storedPtrSize) +
+                        ") não correspondem às deste binário");
+  }
+  if (storedOrder < 3 ||
+      (storedPageSize != 0 &&
+       (!isValidPageSize(storedPageSize) ||
+        storedOrder > orderForPageSize(storedPageSize, storedPtrSize)))) {
+    throw runtime_error("Ordem " + to_string(storedOrder) +
+                        " inválida para a página de " +
+                        to_string(storedPageSize) + " bytes");
+  }
+
+  if (storedOrder != treeOrder) {
+    cerr << "Aviso: o índice " << indexFilePath << " foi criado com ordem "
+         << storedOrder << "; ignorando a ordem " << treeOrder << " pedida."
+         << endl;
+  }
+  if (storedCompressLeaves != compressLeaves) {
+    cerr << "Aviso: o índice " << indexFilePath << " usa folhas "
+         << (storedCompressLeaves ? "comprimidas" : "sem compressão")
+         << "; mantendo a codificação gravada." << endl;
+  }
+  treeOrder = storedOrder;
+  pageSize = storedPageSize;
+  pointerSize = storedPtrSize;
+  compressLeaves = storedCompressLeaves;
+
+  if (headerLinesInFile < HEADER_LINES) {
+    upgradeHeader(headerLinesInFile);
+  }
+}
+
+/**
+ * Converte um arquivo de índice com cabeçalho de formato antigo (por exemplo,
+ * apenas ROOT_ID e NEXT_NODE_ID) substituindo as oldHeaderLines primeiras
+ * linhas pelo superbloco completo. Os nós não mudam de posição relativa.
+ */
+void BPlusTree::upgradeHeader(int oldHeaderLines) {
+  vector<string> lines;
+  ifstream inFile(indexFilePath);
+  string currentLine;
+  while (getline(inFile, currentLine)) {
+    lines.push_back(currentLine);
+  }
+  inFile.close();
+
+  vector<string> header = formatHeaderLines();
+  lines.erase(lines.begin(),
+              lines.begin() + min(lines.size(),
+                                  static_cast<size_t>(oldHeaderLines)));
+  lines.insert(lines.begin(), header.begin(), header.end());
+
+  ofstream outFile(indexFilePath, ios::trunc);
+  if (!outFile.is_open()) {
+    cerr << "Erro: Não foi possível converter o cabeçalho de "
+         << indexFilePath << endl;
+    return;
+  }
+  for (const auto &l : lines) {
+    outFile << l << "\n";
+  }
+}
+
+/**
+ * Espaço, em bytes, para as entradas de uma folha numa página: descontados o
+ * cabeçalho do nó e os ponteiros ant/prox. 0 se a ordem for explícita.
+ */
+int BPlusTree::leafPayloadCapacity() const {
+  return pageSize > 0 ? pageSize - NODE_HEADER_SIZE - 2 * pointerSize : 0;
+}
+
+/**
+ * Indica se uma folha não comporta a entrada (key, dataRecordId). Sem
+ * compressão (ou com ordem explícita) o limite é ordem-1 entradas. Com folhas
+ * comprimidas e tamanho de página definido, o limite é o próprio espaço da
+ * página: a folha é codificada já com a nova entrada, porque o crescimento
+ * depende dos vizinhos dela (deltas de ponteiro de até 10 bytes) e pode mudar
+ * a largura de todos os ponteiros em FRAME_OF_REFERENCE.
+ */
+bool BPlusTree::isLeafFull(const Node *leaf, int key,
+                           RecordPointer dataRecordId) const {
+  if (!compressLeaves || pageSize == 0) {
+    return leaf->numKeys >= treeOrder - 1;
+  }
+  vector<int> keys(leaf->keys.begin(), leaf->keys.begin() + leaf->numKeys);
+  vector<RecordPointer> dataPointers(
+      leaf->dataPointers.begin(), leaf->dataPointers.begin() + leaf->numKeys);
+  auto it = lower_bound(keys.begin(), keys.end(), key);
+  int insertPos = distance(keys.begin(), it);
+  keys.insert(keys.begin() + insertPos, key);
+  dataPointers.insert(dataPointers.begin() + insertPos, dataRecordId);
+  string encoded;
+  chooseLeafEncoding(keys, dataPointers, leaf->numKeys + 1, encoded);
+  return static_cast<int>(encoded.size()) > leafPayloadCapacity();
 }
 
 /**
  * Destrutor da classe BPlusTree.
  * Garante que o nó de índice atualmente em buffer (se existir e estiver
  * modificado) seja salvo em disco. Atualiza as informações de cabeçalho (ID da
- * raiz e próximo ID de nó) no arquivo de índice.
+ * raiz, próximo ID de nó e páginas livres) no arquivo de índice, se mudaram.
+ * Snapshots não sobrevivem à árvore, então toda página substituída passa a ser
+ * livre.
  */
 BPlusTree::~BPlusTree() {
+  lock_guard<mutex> lock(snapshotMutex);
+  pinnedVersions.clear();
+  reclaimRetiredPages();
+
   // Salva o nó de índice em RAM se estiver sujo (modificado).
   if (currentIndexNodeInRam != nullptr && currentIndexNodeDirty) {
     saveNodeToFile(currentIndexNodeInRam);
@@ -78,6 +323,30 @@ BPlusTree::~BPlusTree() {
   delete currentIndexNodeInRam; // Libera a memória do nó em buffer.
   currentIndexNodeInRam = nullptr;
 
+  writeHeaderIfChanged();
+}
+
+/**
+ * Grava o nó em buffer e o cabeçalho, para que o arquivo reflita a última
+ * versão confirmada sem fechar a árvore (usado pelo modo servidor).
+ */
+void BPlusTree::sync() {
+  lock_guard<mutex> lock(snapshotMutex);
+  flushAndClearNodeBuffer();
+  writeHeaderIfChanged();
+}
+
+/**
+ * Regrava o cabeçalho (ID da raiz, próximo ID de nó e páginas livres) se ele
+ * mudou desde a última gravação. Como as linhas do cabeçalho não têm tamanho
+ * fixo, o arquivo inteiro é reescrito; uma sessão só de buscas não paga isso.
+ */
+void BPlusTree::writeHeaderIfChanged() {
+  vector<string> header = formatHeaderLines();
+  if (header == headerOnDisk) {
+    return;
+  }
+
   // Lê todas as linhas do arquivo de índice para atualizar o cabeçalho.
   vector<string> lines;
   ifstream inFile(indexFilePath);
@@ -89,32 +358,26 @@ BPlusTree::~BPlusTree() {
     inFile.close();
   }
 
-  // Prepara as strings de cabeçalho atualizadas.
-  string rootStr = "ROOT_ID:" + to_string(rootNodeId);
-  string nextIdStr = "NEXT_NODE_ID:" + to_string(nextNodeIdCounter);
-
-  // Atualiza ou adiciona as linhas de cabeçalho.
-  if (lines.size() >= 2) {
-    lines[0] = rootStr;
-    lines[1] = nextIdStr;
-  } else if (lines.size() == 1) {
-    lines[0] = rootStr;
-    lines.push_back(nextIdStr);
-  } else {
-    lines.push_back(rootStr);
-    lines.push_back(nextIdStr);
+  // Atualiza ou adiciona as linhas de cabeçalho (superbloco).
+  for (size_t i = 0; i < header.size(); ++i) {
+    if (i < lines.size()) {
+      lines[i] = header[i];
+    } else {
+      lines.push_back(header[i]);
+    }
   }
 
   // Escreve todas as linhas de volta no arquivo de índice, sobrescrevendo-o.
   ofstream outFile(indexFilePath, ios::trunc);
   if (outFile.is_open()) {
     for (const auto &l : lines) {
-      outFile << l << endl;
+      outFile << l << "\n";
     }
     outFile.close();
+    headerOnDisk = header;
   } else {
     cerr << "Erro: Não foi possível abrir o arquivo de índice "
-              << indexFilePath << " para salvar root/next ID no destrutor."
+              << indexFilePath << " para salvar root/next ID."
               << endl;
   }
 }
@@ -122,7 +385,8 @@ BPlusTree::~BPlusTree() {
 /**
  * Inicializa o arquivo de índice se ele não existir ou estiver vazio.
  * Cria o arquivo com as linhas de cabeçalho para ROOT_ID (inicializado como 0)
- * e NEXT_NODE_ID (inicializado como 1).
+ * e NEXT_NODE_ID (inicializado como 1), seguidas do superbloco com a ordem,
+ * o tamanho de página e as larguras de chave/ponteiro.
  */
 void BPlusTree::initializeIndexFile() {
   ifstream fileCheck(indexFilePath);
@@ -141,11 +405,12 @@ void BPlusTree::initializeIndexFile() {
     ofstream file(indexFilePath,
                        ios::trunc); // Cria/sobrescreve o arquivo.
     if (file.is_open()) {
-      file << "ROOT_ID:0\n";      // Raiz inicialmente 0 (árvore vazia).
-      file << "NEXT_NODE_ID:1\n"; // Próximo ID de nó começa em 1.
+      rootNodeId = 0;        // Raiz inicialmente 0 (árvore vazia).
+      nextNodeIdCounter = 1; // Próximo ID de nó começa em 1.
+      for (const auto &l : formatHeaderLines()) {
+        file << l << "\n";
+      }
       file.close();
-      rootNodeId = 0; // Atualiza o estado interno.
-      nextNodeIdCounter = 1;
     } else {
       cerr
           << "Erro: Não foi possível criar ou inicializar o arquivo de índice: "
@@ -163,14 +428,16 @@ void BPlusTree::initializeIndexFile() {
  * Ponteiro para o nó no buffer de índice, ou nullptr se o nodeId for 0 ou o nó
  * não puder ser carregado.
  */
-Node *BPlusTree::accessNode(int nodeId) {
+Node *BPlusTree::accessNode(NodeId nodeId) {
   if (nodeId == 0)
     return nullptr; // ID 0 é inválido ou representa nulo.
 
   // Se o nó desejado já está no buffer, retorna-o.
   if (currentIndexNodeInRam != nullptr && currentIndexNodeInRamId == nodeId) {
+    countStat(&TreeStats::bufferHits);
     return currentIndexNodeInRam;
   }
+  countStat(&TreeStats::bufferMisses);
 
   // Se há um nó no buffer e ele está sujo, salva-o antes de carregar outro.
   if (currentIndexNodeInRam != nullptr && currentIndexNodeDirty) {
@@ -204,7 +471,8 @@ void BPlusTree::markCurrentNodeDirty() {
 /**
  * Cria um novo nó (folha ou interno) e o coloca no buffer de índice.
  * Se houver um nó sujo no buffer, ele é salvo primeiro.
- * O novo nó recebe um ID do `nextNodeIdCounter`, é colocado no buffer, marcado
+ * O novo nó recebe um ID da lista de páginas livres ou, se ela estiver vazia,
+ * do `nextNodeIdCounter`, é colocado no buffer, marcado
  * como sujo e salvo imediatamente no arquivo de índice para garantir sua
  * persistência inicial. isLeaf True se o novo nó deve ser uma folha, False caso
  * contrário. retorna Ponteiro para o novo nó criado, agora no buffer de índice.
@@ -216,8 +484,15 @@ Node *BPlusTree::createNewBufferedNode(bool isLeaf) {
   }
   delete currentIndexNodeInRam; // Libera o nó antigo do buffer.
 
-  int newNodeId =
-      nextNodeIdCounter++; // Obtém e incrementa o ID para o novo nó.
+  NodeId newNodeId;
+  if (!freePageIds.empty()) {
+    newNodeId = freePageIds.back(); // Reaproveita uma página recuperada.
+    freePageIds.pop_back();
+  } else {
+    newNodeId = nextNodeIdCounter++; // Obtém e incrementa o ID para o novo nó.
+  }
+  // O nó pertence à versão em construção; nenhum snapshot o enxerga ainda.
+  nodeBirthVersion[newNodeId] = committedVersion + 1;
   currentIndexNodeInRam =
       new Node(treeOrder, isLeaf, newNodeId); // Cria o novo nó.
   currentIndexNodeInRamId = newNodeId;        // Atualiza o ID do nó em buffer.
@@ -237,7 +512,7 @@ Node *BPlusTree::createNewBufferedNode(bool isLeaf) {
  * contendo o registro de dados, ou string vazia se o recordLineNumber for 0 ou
  * o registro não puder ser lido.
  */
-string BPlusTree::accessDataRecord(int recordLineNumber) {
+string BPlusTree::accessDataRecord(RecordPointer recordLineNumber) {
   if (recordLineNumber == 0)
     return ""; // Número de linha 0 é inválido.
 
@@ -266,7 +541,8 @@ string BPlusTree::accessDataRecord(int recordLineNumber) {
  * ser aberto ou a linha não existir.
  */
 string BPlusTree::readLineFromFile(const string &filePath,
-                                        int lineNumber) {
+                                        long long lineNumber,
+                                        long long *bytesScanned) {
   ifstream file(filePath);
   string lineContent;
   if (!file.is_open()) {
@@ -274,13 +550,15 @@ string BPlusTree::readLineFromFile(const string &filePath,
     // filePath << endl;
     return "";
   }
-  for (int i = 1; i <= lineNumber; ++i) {
+  for (long long i = 1; i <= lineNumber; ++i) {
     if (!getline(file, lineContent)) {
       // cerr << "Debug: Falha ao ler a linha " << lineNumber << " de " <<
       // filePath << endl;
       file.close();
       return "";
     }
+    if (bytesScanned)
+      *bytesScanned += static_cast<long long>(lineContent.size()) + 1;
   }
   file.close();
   return lineContent;
@@ -292,10 +570,13 @@ string BPlusTree::readLineFromFile(const string &filePath,
  * preenchido com linhas vazias até a linha alvo. filePath O caminho para o
  * arquivo. targetLineNumber O número da linha (1-based) onde o conteúdo deve
  * ser escrito. content A string a ser escrita na linha.
+ * O arquivo novo é escrito ao lado e renomeado por cima do antigo, para que
+ * leitores de snapshots em outras threads nunca o vejam pela metade.
  */
 void BPlusTree::writeLineToFile(const string &filePath,
-                                int targetLineNumber,
-                                const string &content) {
+                                long long targetLineNumber,
+                                const string &content,
+                                long long *bytesWritten) {
   vector<string> allLines;
   ifstream inFile(filePath);
   string currentLineText;
@@ -317,19 +598,23 @@ void BPlusTree::writeLineToFile(const string &filePath,
   }
   allLines[targetLineNumber - 1] = content; // Define o conteúdo da linha alvo.
 
-  // Escreve todas as linhas de volta no arquivo, sobrescrevendo-o.
-  ofstream outFile(filePath, ios::trunc);
+  // Escreve todas as linhas numa cópia e a renomeia sobre o arquivo.
+  string tempPath = filePath + ".tmp";
+  ofstream outFile(tempPath, ios::trunc);
   if (outFile.is_open()) {
     for (size_t i = 0; i < allLines.size(); ++i) {
       // Evita adicionar uma nova linha extra se a última linha for vazia e for
       // realmente a última.
       outFile << allLines[i]
               << (i == allLines.size() - 1 && allLines[i].empty() &&
-                          targetLineNumber == static_cast<int>(allLines.size())
+                          targetLineNumber == static_cast<long long>(allLines.size())
                       ? ""
                       : "\n");
     }
+    if (bytesWritten)
+      *bytesWritten += static_cast<long long>(outFile.tellp());
     outFile.close();
+    filesystem::rename(tempPath, filePath);
   } else {
     cerr
         << "Erro: Não foi possível abrir o arquivo para escrever a linha: "
@@ -343,11 +628,11 @@ void BPlusTree::writeLineToFile(const string &filePath,
  * retorna O número de linhas no arquivo, ou 0 se o arquivo não puder ser
  * aberto.
  */
-int BPlusTree::countLinesInFile(const string &filePath) {
+long long BPlusTree::countLinesInFile(const string &filePath) {
   ifstream file(filePath);
   if (!file.is_open())
     return 0;
-  int lineCount = 0;
+  long long lineCount = 0;
   string lineText;
   while (getline(file, lineText)) {
     lineCount++;
@@ -361,19 +646,25 @@ int BPlusTree::countLinesInFile(const string &filePath) {
  * A linha lida do arquivo é então passada para `parseNodeString` * objeto Node carregado, ou nullptr se o ID for 0, a linha estiver vazia ou
  * houver erro no parsing.
  */
-Node *BPlusTree::loadNodeFromFile(int nodeIdToLoad) {
+Node *BPlusTree::loadNodeFromFile(NodeId nodeIdToLoad) {
   if (nodeIdToLoad == 0)
     return nullptr;
   // Os IDs dos nós no arquivo de índice são armazenados após as linhas de
   // cabeçalho.
-  string nodeString =
-      readLineFromFile(indexFilePath, nodeIdToLoad + HEADER_LINES);
-  if (nodeString.empty()) {
-    // cerr << "Debug: String vazia ao carregar nó ID " << nodeIdToLoad <<
-    // endl;
-    return nullptr;
-  }
-  return parseNodeString(nodeString, nodeIdToLoad);
+  auto start = chrono::steady_clock::now();
+  long long bytesScanned = 0;
+  string nodeString = readLineFromFile(
+      indexFilePath, nodeIdToLoad + HEADER_LINES, &bytesScanned);
+  Node *node = nodeString.empty() ? nullptr
+                                  : parseNodeString(nodeString, nodeIdToLoad);
+  double micros = chrono::duration<double, micro>(
+                      chrono::steady_clock::now() - start)
+                      .count();
+  lock_guard<mutex> lock(statsMutex);
+  stats.nodeReads++;
+  stats.bytesRead += bytesScanned;
+  stats.readLatency.record(micros);
+  return node;
 }
 
 /**
@@ -387,23 +678,34 @@ void BPlusTree::saveNodeToFile(Node *nodeToSave) {
               << endl;
     return;
   }
+  auto start = chrono::steady_clock::now();
   string nodeStr = formatNodeString(nodeToSave);
   // Os IDs dos nós no arquivo de índice são armazenados após as linhas de
   // cabeçalho.
-  writeLineToFile(indexFilePath, nodeToSave->id + HEADER_LINES, nodeStr);
+  long long bytesWritten = 0;
+  writeLineToFile(indexFilePath, nodeToSave->id + HEADER_LINES, nodeStr,
+                  &bytesWritten);
+  double micros = chrono::duration<double, micro>(
+                      chrono::steady_clock::now() - start)
+                      .count();
+  lock_guard<mutex> lock(statsMutex);
+  stats.nodeWrites++;
+  stats.bytesWritten += bytesWritten;
+  stats.writeLatency.record(micros);
 }
 
 /**
  * Analisa (faz parsing) uma string lida do arquivo de índice para reconstruir
  * um objeto Node. A string deve estar no formato:
  * "T;numChaves;chave1;...;chaveN;ponteiro1;...;ponteiroN[;ant;prox]" para
- * folhas ou "T;numChaves;chave1;...;chaveN;filhoID1;...;filhoID(N+1)" para nós
- * internos. line A string contendo a representação do nó. nodeIdFromFile O ID
+ * folhas sem compressão, "T;numChaves;ant;prox;base64" para folhas
+ * comprimidas (T = D ou F, ver LeafEncoding) ou "T;numChaves;chave1;...;chaveN;filhoID1;...;filhoID(N+1);
+ * contagem1;...;contagem(N+1)" para nós internos. line A string contendo a representação do nó. nodeIdFromFile O ID
  * do nó, conforme lido do arquivo (usado para consistência). retorna Ponteiro
  * para o objeto Node reconstruído, ou nullptr se a string estiver vazia ou
  * houver erro no parsing.
  */
-Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
+Node *BPlusTree::parseNodeString(const string &line, NodeId nodeIdFromFile) {
   if (line.empty())
     return nullptr;
   stringstream ss(line);
@@ -411,7 +713,8 @@ Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
   char typeChar;
   int numKeysInString;
 
-  // Lê o tipo do nó (L para folha, I para interno).
+  // Lê o tipo do nó (I para interno; L, D ou F para folha, conforme a
+  // LeafEncoding da página).
   if (!getline(ss, segment, ';')) { /*delete currentIndexNodeInRam;
                                             currentIndexNodeInRam = nullptr;*/
     return nullptr;
@@ -422,7 +725,7 @@ Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
   }
   typeChar = segment[0];
 
-  Node *parsedNode = new Node(treeOrder, (typeChar == 'L'), nodeIdFromFile);
+  Node *parsedNode = new Node(treeOrder, (typeChar != 'I'), nodeIdFromFile);
 
   // Lê o número de chaves.
   if (!getline(ss, segment, ';')) {
@@ -437,6 +740,31 @@ Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
   }
   parsedNode->numKeys = numKeysInString;
 
+  // Folha comprimida: "T;numChaves;ant;prox;<conteúdo em base64>;".
+  if (typeChar == static_cast<char>(LeafEncoding::DELTA_VARINT) ||
+      typeChar == static_cast<char>(LeafEncoding::FRAME_OF_REFERENCE)) {
+    string prevSegment, nextSegment, payload, bytes;
+    if (!getline(ss, prevSegment, ';') || !getline(ss, nextSegment, ';') ||
+        !getline(ss, payload, ';') || !fromBase64(payload, bytes)) {
+      delete parsedNode;
+      return nullptr;
+    }
+    try {
+      parsedNode->prevLeafId = stoll(prevSegment);
+      parsedNode->nextLeafId = stoll(nextSegment);
+    } catch (const exception &) {
+      delete parsedNode;
+      return nullptr;
+    }
+    if (!decodeLeafEntries(bytes, parsedNode->numKeys,
+                           static_cast<LeafEncoding>(typeChar),
+                           parsedNode->keys, parsedNode->dataPointers)) {
+      delete parsedNode;
+      return nullptr;
+    }
+    return parsedNode;
+  }
+
   // Lê as chaves.
   parsedNode->keys.resize(parsedNode->numKeys);
   for (int i = 0; i < parsedNode->numKeys; ++i) {
@@ -461,7 +789,7 @@ Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
         return nullptr;
       }
       try {
-        parsedNode->dataPointers[i] = stoi(segment);
+        parsedNode->dataPointers[i] = stoll(segment);
       } catch (const exception &) {
         delete parsedNode;
         return nullptr;
@@ -473,7 +801,7 @@ Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
       return nullptr;
     }
     try {
-      parsedNode->prevLeafId = stoi(segment);
+      parsedNode->prevLeafId = stoll(segment);
     } catch (const exception &) {
       delete parsedNode;
       return nullptr;
@@ -484,14 +812,15 @@ Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
       return nullptr;
     }
     try {
-      parsedNode->nextLeafId = stoi(segment);
+      parsedNode->nextLeafId = stoll(segment);
     } catch (const exception &) {
       delete parsedNode;
       return nullptr;
     }
   } else { // Nó Interno
     // Se for interno, lê os IDs dos nós filhos.
-    int numChildren = parsedNode->numKeys + 1;
+    // Um nó interno recém-criado (ainda sem chaves) é salvo sem filhos.
+    int numChildren = parsedNode->numKeys == 0 ? 0 : parsedNode->numKeys + 1;
     parsedNode->childNodeIds.resize(numChildren);
     for (int i = 0; i < numChildren; ++i) {
       if (!getline(ss, segment, ';')) {
@@ -499,12 +828,24 @@ Node *BPlusTree::parseNodeString(const string &line, int nodeIdFromFile) {
         return nullptr;
       }
       try {
-        parsedNode->childNodeIds[i] = stoi(segment);
+        parsedNode->childNodeIds[i] = stoll(segment);
       } catch (const exception &) {
         delete parsedNode;
         return nullptr;
       }
     }
+    // Contagens por filho; ausentes em índices gravados antes delas.
+    for (int i = 0; i < numChildren && getline(ss, segment, ';'); ++i) {
+      try {
+        parsedNode->childCounts.push_back(stoll(segment));
+      } catch (const exception &) {
+        delete parsedNode;
+        return nullptr;
+      }
+    }
+    if (static_cast<int>(parsedNode->childCounts.size()) != numChildren) {
+      parsedNode->childCounts.clear();
+    }
   }
   return parsedNode;
 }
@@ -519,6 +860,16 @@ string BPlusTree::formatNodeString(Node *node) {
   if (!node)
     return "";
   stringstream ss;
+  if (node->isLeaf && compressLeaves && node->numKeys > 0) {
+    // A etiqueta da página diz qual codificação foi escolhida.
+    string bytes;
+    LeafEncoding encoding = chooseLeafEncoding(node->keys, node->dataPointers,
+                                               node->numKeys, bytes);
+    ss << static_cast<char>(encoding) << ";" << node->numKeys << ";"
+       << node->prevLeafId << ";" << node->nextLeafId << ";" << toBase64(bytes)
+       << ";";
+    return ss.str();
+  }
   ss << (node->isLeaf ? 'L' : 'I') << ";";
   ss << node->numKeys << ";";
   for (int i = 0; i < node->numKeys; ++i) {
@@ -534,6 +885,9 @@ string BPlusTree::formatNodeString(Node *node) {
     for (size_t i = 0; i < node->childNodeIds.size(); ++i) {
       ss << node->childNodeIds[i] << ";";
     }
+    for (size_t i = 0; i < node->childCounts.size(); ++i) {
+      ss << node->childCounts[i] << ";";
+    }
   }
   return ss.str();
 }
@@ -546,8 +900,28 @@ string BPlusTree::formatNodeString(Node *node) {
  * Se o nó folha estiver cheio, realiza a divisão (split) do nó e insere a
  * chave. key A chave a ser inserida (ano_colheita). dataRecordId O ponteiro
  * para o registro de dados (número da linha em vinhos.csv).
+ * Cada inserção é confirmada como uma nova versão da árvore.
+ */
+void BPlusTree::insert(int key, RecordPointer dataRecordId) {
+  lock_guard<mutex> lock(snapshotMutex);
+  insertEntry(key, dataRecordId);
+  commitVersion();
+}
+
+/**
+ * Corpo da inserção, sem confirmar a versão (ver insert).
  */
-void BPlusTree::insert(int key, int dataRecordId) {
+void BPlusTree::insertEntry(int key, RecordPointer dataRecordId) {
+  // Índices de 4 bytes estimam a página com IDs de 32 bits; valores maiores
+  // continuam funcionando, mas as páginas podem passar do tamanho previsto.
+  if (pointerSize == NARROW_POINTER_SIZE && !pointerWidthWarned &&
+      max(dataRecordId, nextNodeIdCounter) > INT32_MAX) {
+    cerr << "Aviso: IDs acima de 32 bits num índice com PTR_SIZE:"
+         << pointerSize << "; recrie o índice para usar ponteiros de "
+         << WIDE_POINTER_SIZE << " bytes." << endl;
+    pointerWidthWarned = true;
+  }
+
   // Se a árvore está vazia (sem raiz), cria uma nova raiz que é uma folha.
   if (rootNodeId == 0) {
     Node *newRoot =
@@ -561,10 +935,11 @@ void BPlusTree::insert(int key, int dataRecordId) {
     return;
   }
 
-  vector<int>
+  vector<NodeId>
       pathNodeIds; // Vetor para armazenar o caminho da raiz até a folha.
-  int leafNodeId = findLeafNodeIdToInsert(
-      key, pathNodeIds); // Encontra o ID da folha para inserção.
+  NodeId leafNodeId = findLeafNodeIdToInsert(
+      key, pathNodeIds, true); // Encontra o ID da folha para inserção e já
+                               // contabiliza a nova entrada no caminho.
 
   if (leafNodeId == 0) {
     cerr
@@ -581,7 +956,7 @@ void BPlusTree::insert(int key, int dataRecordId) {
   }
 
   // Verifica se a folha está cheia.
-  if (leafNode->isFull()) {
+  if (isLeafFull(leafNode, key, dataRecordId)) {
     splitAndInsertLeaf(leafNodeId, key, dataRecordId,
                        pathNodeIds); // Divide a folha e insere.
   } else {
@@ -595,15 +970,21 @@ void BPlusTree::insert(int key, int dataRecordId) {
  * Percorre a árvore da raiz até um nó folha, seguindo os ponteiros apropriados
  * com base na chave. key A chave a ser inserida. pathNodeIds Vetor de
  * referência que será preenchido com os IDs dos nós no caminho da raiz até a
- * folha. retorna O ID do nó folha encontrado, ou 0 se a árvore estiver vazia ou
- * ocorrer um erro.
+ * folha. forInsert Se verdadeiro, torna gravável cada nó do caminho
+ * (copiando os que algum snapshot enxerga, o que pode trocar a raiz) e soma 1
+ * à contagem do filho seguido em cada nó interno. retorna O ID do nó folha
+ * encontrado, ou 0 se a árvore estiver vazia ou ocorrer um erro.
  */
-int BPlusTree::findLeafNodeIdToInsert(int key, vector<int> &pathNodeIds) {
+NodeId BPlusTree::findLeafNodeIdToInsert(int key, vector<NodeId> &pathNodeIds,
+                                      bool forInsert) {
   pathNodeIds.clear();
   if (rootNodeId == 0)
     return 0; // Árvore vazia.
 
-  int currentNodeId = rootNodeId;
+  if (forInsert) {
+    rootNodeId = copyOnWrite(rootNodeId); // Nova raiz, se a antiga é fixada.
+  }
+  NodeId currentNodeId = rootNodeId;
   pathNodeIds.push_back(currentNodeId); // Adiciona a raiz ao caminho.
   Node *tempNode =
       accessNode(currentNodeId); // Carrega o nó atual para o buffer.
@@ -624,13 +1005,34 @@ int BPlusTree::findLeafNodeIdToInsert(int key, vector<int> &pathNodeIds) {
           << tempNode->id << endl;
       return 0;
     }
-    currentNodeId = tempNode->childNodeIds[childIdx]; // Move para o filho.
+    NodeId childNodeId = tempNode->childNodeIds[childIdx];
+    if (forInsert) {
+      tempNode->childCounts[childIdx]++;
+      markCurrentNodeDirty();
+      // O pai já é gravável; se o filho foi copiado, o pai passa a apontar
+      // para a cópia.
+      NodeId writableChildId = copyOnWrite(childNodeId);
+      if (writableChildId != childNodeId) {
+        tempNode = accessNode(currentNodeId);
+        if (!tempNode)
+          return 0;
+        tempNode->childNodeIds[childIdx] = writableChildId;
+        markCurrentNodeDirty();
+        childNodeId = writableChildId;
+      }
+    }
+    currentNodeId = childNodeId; // Move para o filho.
     pathNodeIds.push_back(currentNodeId); // Adiciona o filho ao caminho.
     tempNode = accessNode(currentNodeId); // Carrega o próximo nó.
   }
 
   if (tempNode == nullptr)
     return 0;          // Erro ao acessar um nó no caminho.
+  {
+    lock_guard<mutex> lock(statsMutex);
+    stats.descents++;
+    stats.height = static_cast<int>(pathNodeIds.size());
+  }
   return tempNode->id; // Retorna o ID do nó folha encontrado.
 }
 
@@ -640,10 +1042,10 @@ int BPlusTree::findLeafNodeIdToInsert(int key, vector<int> &pathNodeIds) {
  * chaves. leafNodeId O ID do nó folha onde a inserção ocorrerá. key A chave a
  * ser inserida. dataRecordId O ponteiro de dados associado à chave.
  */
-void BPlusTree::insertIntoLeafNonFull(int leafNodeId, int key,
-                                      int dataRecordId) {
+void BPlusTree::insertIntoLeafNonFull(NodeId leafNodeId, int key,
+                                      RecordPointer dataRecordId) {
   Node *leaf = accessNode(leafNodeId); // Carrega a folha para o buffer.
-  if (!leaf || !leaf->isLeaf || leaf->isFull()) {
+  if (!leaf || !leaf->isLeaf || isLeafFull(leaf, key, dataRecordId)) {
     cerr << "Erro: Não é possível inserir em nó não folha, folha cheia ou "
                  "folha nula."
               << endl;
@@ -672,9 +1074,9 @@ void BPlusTree::insertIntoLeafNonFull(int leafNodeId, int key,
  * dataPtrToInsert O ponteiro de dados associado à chave a ser inserida.
  * pathNodeIds O caminho da raiz até o nó pai da folha que está sendo dividida.
  */
-void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
-                                   int dataPtrToInsert,
-                                   vector<int> &pathNodeIds) {
+void BPlusTree::splitAndInsertLeaf(NodeId leafNodeId, int keyToInsert,
+                                   RecordPointer dataPtrToInsert,
+                                   vector<NodeId> &pathNodeIds) {
   Node *leaf =
       accessNode(leafNodeId); // Carrega a folha original para o buffer.
   if (!leaf)
@@ -683,7 +1085,7 @@ void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
   // Cria vetores temporários com todas as chaves e ponteiros (incluindo o novo
   // par).
   vector<int> tempKeys = leaf->keys;
-  vector<int> tempDataPointers = leaf->dataPointers;
+  vector<RecordPointer> tempDataPointers = leaf->dataPointers;
   auto it_k = lower_bound(tempKeys.begin(), tempKeys.end(), keyToInsert);
   int insertPos = distance(tempKeys.begin(), it_k);
   tempKeys.insert(tempKeys.begin() + insertPos, keyToInsert);
@@ -691,8 +1093,9 @@ void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
                           dataPtrToInsert);
 
   // Cria um novo nó folha (este será o nó da direita após a divisão).
+  countStat(&TreeStats::leafSplits);
   Node *newLeafBufferPtr = createNewBufferedNode(true);
-  int newLeafId = newLeafBufferPtr->id;
+  NodeId newLeafId = newLeafBufferPtr->id;
 
   leaf =
       accessNode(leafNodeId); // Reacessa o nó folha original (pode ter sido
@@ -711,6 +1114,7 @@ void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
                             tempDataPointers.begin() + numItemsInOldLeaf);
   leaf->numKeys = numItemsInOldLeaf;
   markCurrentNodeDirty();
+  NodeId oldNextLeafId = leaf->nextLeafId; // `leaf` deixa de ser válido abaixo.
 
   // Atualiza o novo nó folha (nó da direita).
   Node *newLeafNodePtr =
@@ -726,9 +1130,12 @@ void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
 
   // Atualiza os ponteiros de vizinhança.
   newLeafNodePtr->nextLeafId =
-      leaf->nextLeafId; // O próximo do novo é o antigo próximo do original.
-  newLeafNodePtr->prevLeafId = leaf->id; // O anterior do novo é o nó original.
+      oldNextLeafId; // O próximo do novo é o antigo próximo do original.
+  newLeafNodePtr->prevLeafId = leafNodeId; // O anterior do novo é o nó original.
   markCurrentNodeDirty();
+  // Guarda o necessário do novo nó antes que o buffer seja reutilizado.
+  NodeId nextOfNewLeafId = newLeafNodePtr->nextLeafId;
+  int keyToPushUp = newLeafNodePtr->keys[0];
 
   leaf = accessNode(leafNodeId); // Reacessa o nó folha original.
   if (!leaf) {
@@ -739,8 +1146,8 @@ void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
 
   // Se o novo nó folha tem um vizinho à direita, atualiza o ponteiro `prev`
   // desse vizinho.
-  if (newLeafNodePtr->nextLeafId != 0) {
-    Node *nextNextLeaf = accessNode(newLeafNodePtr->nextLeafId);
+  if (nextOfNewLeafId != 0) {
+    Node *nextNextLeaf = accessNode(nextOfNewLeafId);
     if (nextNextLeaf) {
       nextNextLeaf->prevLeafId = newLeafId;
       markCurrentNodeDirty();
@@ -748,10 +1155,10 @@ void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
   }
 
   // A primeira chave do novo nó folha (da direita) é promovida para o pai.
-  int keyToPushUp = newLeafNodePtr->keys[0];
   pathNodeIds.pop_back(); // Remove o ID da folha dividida do caminho, o último
                           // ID no path é o pai.
-  insertIntoParent(leafNodeId, keyToPushUp, newLeafId, pathNodeIds);
+  insertIntoParent(leafNodeId, keyToPushUp, newLeafId, pathNodeIds,
+                   numItemsInOldLeaf, numItemsInNewLeaf);
 }
 
 /**
@@ -763,19 +1170,22 @@ void BPlusTree::splitAndInsertLeaf(int leafNodeId, int keyToInsert,
  * da chave promovida). keyToPushUp A chave promovida da divisão do filho.
  * newChildNodeId O ID do novo filho criado na divisão (à direita da chave
  * promovida). pathNodeIds O caminho da raiz até o avô do nó que foi
- * originalmente dividido (ou vazio se o pai é a raiz).
+ * originalmente dividido (ou vazio se o pai é a raiz). leftCount e rightCount
+ * O número de entradas nas subárvores do filho original e do novo filho.
  */
-void BPlusTree::insertIntoParent(int oldChildNodeId, int keyToPushUp,
-                                 int newChildNodeId,
-                                 vector<int> &pathNodeIds) {
+void BPlusTree::insertIntoParent(NodeId oldChildNodeId, int keyToPushUp,
+                                 NodeId newChildNodeId,
+                                 vector<NodeId> &pathNodeIds,
+                                 long long leftCount, long long rightCount) {
   // Se pathNodeIds está vazio, significa que o nó dividido era a raiz, ou o pai
   // da folha dividida era a raiz. Neste caso, uma nova raiz precisa ser criada.
   if (pathNodeIds.empty()) {
-    createNewRootAndUpdate(oldChildNodeId, keyToPushUp, newChildNodeId);
+    createNewRootAndUpdate(oldChildNodeId, keyToPushUp, newChildNodeId,
+                           leftCount, rightCount);
     return;
   }
 
-  int parentNodeId = pathNodeIds.back(); // Pega o ID do nó pai.
+  NodeId parentNodeId = pathNodeIds.back(); // Pega o ID do nó pai.
   pathNodeIds.pop_back(); // Remove o pai do caminho para a próxima chamada
                           // recursiva, se houver.
   Node *parent = accessNode(parentNodeId); // Carrega o pai para o buffer.
@@ -785,29 +1195,45 @@ void BPlusTree::insertIntoParent(int oldChildNodeId, int keyToPushUp,
     return;
   }
 
-  // Encontra a posição correta para inserir a chave promovida no nó pai.
-  auto it = lower_bound(parent->keys.begin(),
-parent->keys.begin() + parent->numKeys, keyToPushUp);
-  int insertPos = distance(parent->keys.begin(), it);
+  // A chave promovida entra logo à direita do filho que foi dividido. Com
+  // chaves duplicadas, um lower_bound sobre as chaves do pai poderia escolher
+  // uma posição à esquerda desse filho e quebrar a ordem dos separadores.
+  auto it = find(parent->childNodeIds.begin(), parent->childNodeIds.end(),
+                 oldChildNodeId);
+  if (it == parent->childNodeIds.end()) {
+    cerr << "Erro: Filho " << oldChildNodeId << " não encontrado no nó pai "
+         << parentNodeId << endl;
+    return;
+  }
+  int insertPos = distance(parent->childNodeIds.begin(), it);
 
   // Se o pai não está cheio, insere a chave e o novo filho.
   if (parent->numKeys < treeOrder - 1) {
     parent->keys.insert(parent->keys.begin() + insertPos, keyToPushUp);
     parent->childNodeIds.insert(parent->childNodeIds.begin() + insertPos + 1,
                                 newChildNodeId);
+    // A contagem do filho original já inclui a nova entrada; ela é repartida
+    // entre as duas metades.
+    parent->childCounts[insertPos] = leftCount;
+    parent->childCounts.insert(parent->childCounts.begin() + insertPos + 1,
+                               rightCount);
     parent->numKeys++;
     markCurrentNodeDirty();
   } else { // O pai está cheio, precisa ser dividido.
     // Cria vetores temporários com todas as chaves e filhos (incluindo o novo
     // par).
     vector<int> tempKeys = parent->keys;
-    vector<int> tempChildren = parent->childNodeIds;
+    vector<NodeId> tempChildren = parent->childNodeIds;
+    vector<long long> tempCounts = parent->childCounts;
     tempKeys.insert(tempKeys.begin() + insertPos, keyToPushUp);
     tempChildren.insert(tempChildren.begin() + insertPos + 1, newChildNodeId);
+    tempCounts[insertPos] = leftCount;
+    tempCounts.insert(tempCounts.begin() + insertPos + 1, rightCount);
 
     // Cria um novo nó interno.
+    countStat(&TreeStats::internalSplits);
     Node *newInternalBufferPtr = createNewBufferedNode(false);
-    int newInternalNodeId = newInternalBufferPtr->id;
+    NodeId newInternalNodeId = newInternalBufferPtr->id;
 
     parent = accessNode(parentNodeId); // Reacessa o pai.
     if (!parent) {
@@ -826,6 +1252,9 @@ parent->keys.begin() + parent->numKeys, keyToPushUp);
     parent->childNodeIds.assign(tempChildren.begin(),
                                 tempChildren.begin() +
                                     internalSplitPointKeyIdx + 1);
+    parent->childCounts.assign(tempCounts.begin(),
+                               tempCounts.begin() + internalSplitPointKeyIdx +
+                                   1);
     parent->numKeys = internalSplitPointKeyIdx;
     markCurrentNodeDirty();
 
@@ -840,13 +1269,22 @@ parent->keys.begin() + parent->numKeys, keyToPushUp);
     newInternalNodePtr->childNodeIds.assign(tempChildren.begin() +
                                                 internalSplitPointKeyIdx + 1,
                                             tempChildren.end());
+    newInternalNodePtr->childCounts.assign(tempCounts.begin() +
+                                               internalSplitPointKeyIdx + 1,
+                                           tempCounts.end());
     newInternalNodePtr->numKeys =
         tempKeys.size() - (internalSplitPointKeyIdx + 1);
     markCurrentNodeDirty();
 
     // Chama recursivamente para inserir a `keyToPushFurtherUp` no avô.
+    long long leftTotal = 0, rightTotal = 0;
+    for (size_t i = 0; i < tempCounts.size(); ++i) {
+      (static_cast<int>(i) <= internalSplitPointKeyIdx ? leftTotal
+                                                        : rightTotal) +=
+          tempCounts[i];
+    }
     insertIntoParent(parentNodeId, keyToPushFurtherUp, newInternalNodeId,
-                     pathNodeIds);
+                     pathNodeIds, leftTotal, rightTotal);
   }
 }
 
@@ -857,15 +1295,21 @@ parent->keys.begin() + parent->numKeys, keyToPushUp);
  * o `oldRightChildId`, separados pela `key`. oldLeftChildId O ID do filho à
  * esquerda da chave na nova raiz. key A chave que separará os dois filhos na
  * nova raiz. oldRightChildId O ID do filho à direita da chave na nova raiz.
+ * leftCount e rightCount O número de entradas em cada uma das subárvores.
  */
-void BPlusTree::createNewRootAndUpdate(int oldLeftChildId, int key,
-                                       int oldRightChildId) {
+void BPlusTree::createNewRootAndUpdate(NodeId oldLeftChildId, int key,
+                                       NodeId oldRightChildId,
+                                       long long leftCount,
+                                       long long rightCount) {
+  countStat(&TreeStats::rootSplits);
   Node *newRoot =
       createNewBufferedNode(false); // Cria um novo nó interno para ser a raiz.
   rootNodeId = newRoot->id;         // Atualiza o ID da raiz da árvore.
   newRoot->keys.push_back(key);
   newRoot->childNodeIds.push_back(oldLeftChildId);
   newRoot->childNodeIds.push_back(oldRightChildId);
+  newRoot->childCounts.push_back(leftCount);
+  newRoot->childCounts.push_back(rightCount);
   newRoot->numKeys = 1;
   markCurrentNodeDirty();
 }
@@ -877,14 +1321,14 @@ void BPlusTree::createNewRootAndUpdate(int oldLeftChildId, int key,
  * vinhos.csv) associados à chave. retorna um vetor vazio se a chave não for
  * encontrada ou a árvore estiver vazia.
  */
-vector<int> BPlusTree::search(int key) {
-  vector<int> resultRecordIds;
+vector<RecordPointer> BPlusTree::search(int key) {
+  vector<RecordPointer> resultRecordIds;
   if (rootNodeId == 0)
     return resultRecordIds; // Árvore vazia.
 
-  vector<int>
+  vector<NodeId>
       path; // Não usado aqui, mas findLeafNodeIdToInsert o preenche.
-  int leafNodeId = findLeafNodeIdToInsert(
+  NodeId leafNodeId = findLeafNodeIdToInsert(
       key, path); // Encontra a folha onde a chave deveria estar.
   if (leafNodeId == 0)
     return resultRecordIds; // Chave não pode estar na árvore.
@@ -898,6 +1342,14 @@ vector<int> BPlusTree::search(int key) {
                              leafNode->keys.begin() + leafNode->numKeys, key);
   int keyPos = distance(leafNode->keys.begin(), it);
 
+  // A chave pode ser igual ao separador do pai e estar apenas na folha
+  // seguinte; nesse caso a busca continua no início da próxima folha.
+  if (keyPos >= leafNode->numKeys && leafNode->nextLeafId != 0) {
+    countStat(&TreeStats::leafHops);
+    leafNode = accessNode(leafNode->nextLeafId);
+    keyPos = 0;
+  }
+
   // Itera pela folha e pelas folhas seguintes (se necessário) para coletar
   // todos os dataPointers da chave.
   while (leafNode != nullptr && keyPos < leafNode->numKeys &&
@@ -907,11 +1359,12 @@ vector<int> BPlusTree::search(int key) {
     // Se chegou ao fim das chaves na folha atual, tenta ir para a próxima
     // folha.
     if (keyPos >= leafNode->numKeys) {
-      int nextLeafIdToSearch = leafNode->nextLeafId;
+      NodeId nextLeafIdToSearch = leafNode->nextLeafId;
       if (nextLeafIdToSearch == 0) {
         leafNode = nullptr;
         break;
       }                                          // não há mais folhas
+      countStat(&TreeStats::leafHops);
       leafNode = accessNode(nextLeafIdToSearch); // carrega a próxima folha
       if (!leafNode)
         break;    // erro ao carregar próxima folha
@@ -926,6 +1379,839 @@ vector<int> BPlusTree::search(int key) {
   return resultRecordIds;
 }
 
+/**
+ * Retorna o número total de entradas (chave, ponteiro) na árvore, somando as
+ * contagens por filho da raiz (ou o número de chaves, se a raiz for folha).
+ */
+long long BPlusTree::totalEntries() {
+  Node *root = accessNode(rootNodeId);
+  if (!root)
+    return 0;
+  if (root->isLeaf)
+    return root->numKeys;
+  long long total = 0;
+  for (long long c : root->childCounts)
+    total += c;
+  return total;
+}
+
+/**
+ * Conta as entradas com chave estritamente menor que `key` (o rank de `key`).
+ * Desce o mesmo caminho da busca: em cada nó interno, os filhos à esquerda do
+ * filho seguido só contêm chaves menores que `key` e entram inteiros na soma
+ * pelas suas contagens; na folha final contam-se as chaves menores. Custa
+ * O(altura) acessos a nós.
+ */
+long long BPlusTree::countLess(int key) {
+  long long result = 0;
+  Node *node = accessNode(rootNodeId);
+  while (node != nullptr && !node->isLeaf) {
+    auto it = lower_bound(node->keys.begin(),
+                          node->keys.begin() + node->numKeys, key);
+    int childIdx = distance(node->keys.begin(), it);
+    for (int i = 0; i < childIdx; ++i) {
+      result += node->childCounts[i];
+    }
+    node = accessNode(node->childNodeIds[childIdx]);
+  }
+  if (node != nullptr) {
+    result += distance(node->keys.begin(),
+                       lower_bound(node->keys.begin(),
+                                   node->keys.begin() + node->numKeys, key));
+  }
+  return result;
+}
+
+/**
+ * Conta as entradas com lowKey <= chave <= highKey como a diferença entre dois
+ * ranks. retorna 0 se o intervalo for vazio.
+ */
+long long BPlusTree::countRange(int lowKey, int highKey) {
+  if (rootNodeId == 0 || lowKey > highKey)
+    return 0;
+  long long upTo = highKey == numeric_limits<int>::max()
+                      ? totalEntries()
+                      : countLess(highKey + 1);
+  return upTo - countLess(lowKey);
+}
+
+/**
+ * Encontra a chave da n-ésima entrada (base 1) na ordem das chaves, descendo
+ * pelas contagens por filho até a folha que a contém. n O índice desejado.
+ * keyOut Recebe a chave encontrada. retorna false se n estiver fora de
+ * [1, totalEntries()].
+ */
+bool BPlusTree::nthKey(long long n, int &keyOut) {
+  if (n < 1)
+    return false;
+  long long remaining = n;
+  Node *node = accessNode(rootNodeId);
+  while (node != nullptr && !node->isLeaf) {
+    size_t childIdx = 0;
+    while (childIdx < node->childCounts.size() &&
+           remaining > node->childCounts[childIdx]) {
+      remaining -= node->childCounts[childIdx];
+      childIdx++;
+    }
+    if (childIdx == node->childCounts.size())
+      return false; // n maior que o total de entradas
+    node = accessNode(node->childNodeIds[childIdx]);
+  }
+  if (node == nullptr || remaining > node->numKeys)
+    return false;
+  keyOut = node->keys[remaining - 1];
+  return true;
+}
+
+/**
+ * Recalcula recursivamente as contagens por filho da subárvore de `nodeId` e
+ * grava os nós internos atualizados. Usada uma única vez ao abrir índices
+ * gravados antes de as contagens existirem. retorna O número de entradas da
+ * subárvore.
+ */
+long long BPlusTree::rebuildSubtreeCounts(NodeId nodeId) {
+  Node *node = accessNode(nodeId);
+  if (!node)
+    return 0;
+  if (node->isLeaf)
+    return node->numKeys;
+
+  vector<NodeId> children = node->childNodeIds; // o buffer será reutilizado
+  vector<long long> counts;
+  long long total = 0;
+  for (NodeId childId : children) {
+    counts.push_back(rebuildSubtreeCounts(childId));
+    total += counts.back();
+  }
+
+  node = accessNode(nodeId);
+  if (node) {
+    node->childCounts = counts;
+    markCurrentNodeDirty();
+  }
+  return total;
+}
+
+/**
+ * Salva o nó em buffer, se estiver sujo, e esvazia o buffer. Usado antes de
+ * operações que leem ou reescrevem o arquivo de índice inteiro.
+ */
+void BPlusTree::flushAndClearNodeBuffer() {
+  if (currentIndexNodeInRam != nullptr && currentIndexNodeDirty) {
+    saveNodeToFile(currentIndexNodeInRam);
+  }
+  delete currentIndexNodeInRam;
+  currentIndexNodeInRam = nullptr;
+  currentIndexNodeInRamId = 0;
+  currentIndexNodeDirty = false;
+}
+
+/**
+ * Lê o arquivo de índice inteiro numa única passada sequencial e devolve os
+ * nós em memória: a posição i guarda o nó de ID i+1 (nullptr se a linha
+ * estiver vazia ou não puder ser analisada). O chamador libera os nós.
+ */
+vector<Node *> BPlusTree::readAllNodesSequentially() {
+  vector<Node *> nodes;
+  ifstream file(indexFilePath);
+  string line;
+  long long lineNumber = 0;
+  while (getline(file, line)) {
+    lineNumber++;
+    if (lineNumber <= HEADER_LINES)
+      continue;
+    NodeId nodeId = lineNumber - HEADER_LINES;
+    nodes.push_back(parseNodeString(line, nodeId));
+  }
+  return nodes;
+}
+
+/**
+ * Mede a disposição física das folhas: segue o encadeamento a partir da folha
+ * mais à esquerda (em memória, após uma leitura sequencial do índice) e conta
+ * quantos saltos vão para o nó imediatamente seguinte no arquivo.
+ */
+LayoutStats BPlusTree::computeLayoutStats() {
+  LayoutStats stats;
+  if (rootNodeId == 0)
+    return stats;
+  flushAndClearNodeBuffer();
+  vector<Node *> nodes = readAllNodesSequentially();
+  auto nodeAt = [&](NodeId id) -> Node * {
+    return (id >= 1 && id <= static_cast<NodeId>(nodes.size())) ? nodes[id - 1]
+                                                                : nullptr;
+  };
+
+  // Desce pelo primeiro filho até a folha mais à esquerda.
+  Node *node = nodeAt(rootNodeId);
+  while (node != nullptr) {
+    stats.height++;
+    if (node->isLeaf || node->childNodeIds.empty())
+      break;
+    node = nodeAt(node->childNodeIds[0]);
+  }
+
+  // Com folhas comprimidas numa página, a ocupação é medida em bytes.
+  bool fillInBytes = compressLeaves && pageSize > 0;
+  long long encodedBytes = 0;
+  size_t visited = 0;
+  while (node != nullptr && node->isLeaf && visited++ < nodes.size()) {
+    stats.leafCount++;
+    stats.entries += node->numKeys;
+    if (fillInBytes) {
+      string bytes;
+      chooseLeafEncoding(node->keys, node->dataPointers, node->numKeys, bytes);
+      encodedBytes += bytes.size();
+    }
+    if (node->nextLeafId != 0) {
+      if (node->nextLeafId == node->id + 1)
+        stats.sequentialHops++;
+      stats.totalHopDistance += abs(node->nextLeafId - node->id);
+    }
+    node = nodeAt(node->nextLeafId);
+  }
+  if (stats.leafCount > 0) {
+    stats.avgLeafFill =
+        fillInBytes
+            ? static_cast<double>(encodedBytes) /
+                  (static_cast<double>(stats.leafCount) * leafPayloadCapacity())
+            : static_cast<double>(stats.entries) /
+                  (static_cast<double>(stats.leafCount) * (treeOrder - 1));
+  }
+
+  for (Node *n : nodes)
+    delete n;
+  return stats;
+}
+
+/**
+ * Verifica a integridade do índice com uma única leitura sequencial do
+ * arquivo: todos os nós vão para a memória e a árvore é percorrida a partir
+ * da raiz sem novas leituras. Confere, para cada nó alcançável, o formato
+ * (número de chaves, filhos e contagens), a ordem das chaves, os limites de
+ * ocupação, os separadores dos pais, as contagens por filho e a profundidade
+ * das folhas; depois, o encadeamento ant/prox das folhas na ordem das chaves
+ * e as páginas livres. Nós inalcançáveis fora da lista livre (e não retidos
+ * por snapshots) são contados como páginas perdidas.
+ */
+VerifyReport BPlusTree::verify() {
+  lock_guard<mutex> lock(snapshotMutex);
+  flushAndClearNodeBuffer();
+  VerifyReport report;
+  vector<Node *> nodes = readAllNodesSequentially();
+  report.nodesRead = static_cast<long long>(nodes.size());
+  auto addError = [&](NodeId id, const string &message) {
+    report.errorCount++;
+    if (report.errors.size() < VerifyReport::MAX_REPORTED_ERRORS) {
+      report.errors.push_back("no " + to_string(id) + ": " + message);
+    }
+  };
+  auto nodeAt = [&](NodeId id) -> Node * {
+    return (id >= 1 && id <= static_cast<NodeId>(nodes.size())) ? nodes[id - 1]
+                                                                : nullptr;
+  };
+
+  // Percurso em profundidade, da esquerda para a direita: as folhas saem na
+  // ordem das chaves. Cada filho recebe os separadores vizinhos como limites.
+  vector<char> reached(nodes.size(), 0);
+  vector<NodeId> leavesInOrder;
+  int leafDepth = 0;
+  function<long long(NodeId, int, const int *, const int *)> visit =
+      [&](NodeId id, int depth, const int *low, const int *high) -> long long {
+    Node *node = nodeAt(id);
+    if (!node) {
+      addError(id, "ausente ou ilegivel");
+      if (id >= 1 && id <= static_cast<NodeId>(nodes.size()))
+        reached[id - 1] = 1; // Já relatado; não repete como página perdida
+      return 0;
+    }
+    if (reached[id - 1]) {
+      addError(id, "alcancado por mais de um pai");
+      return 0;
+    }
+    reached[id - 1] = 1;
+    report.reachableNodes++;
+
+    int n = node->numKeys;
+    if (n < 0 || static_cast<size_t>(n) != node->keys.size()) {
+      addError(id, "numero de chaves (" + to_string(n) +
+                       ") difere das chaves lidas (" +
+                       to_string(node->keys.size()) + ")");
+      return 0;
+    }
+    if (n == 0 && id != rootNodeId) {
+      addError(id, "no vazio");
+    }
+    if (!is_sorted(node->keys.begin(), node->keys.end())) {
+      addError(id, "chaves fora de ordem");
+    }
+    auto range = minmax_element(node->keys.begin(), node->keys.end());
+    if (n > 0 && ((low && *range.first < *low) ||
+                  (high && *range.second > *high))) {
+      addError(id, "chaves fora dos separadores do pai");
+    }
+
+    if (node->isLeaf) {
+      bool overfull;
+      if (compressLeaves && pageSize > 0) {
+        string encoded;
+        chooseLeafEncoding(node->keys, node->dataPointers, n, encoded);
+        overfull = static_cast<int>(encoded.size()) > leafPayloadCapacity();
+      } else {
+        overfull = n > treeOrder - 1;
+      }
+      if (overfull) {
+        addError(id, "folha acima da capacidade");
+      }
+      if (node->dataPointers.size() != node->keys.size()) {
+        addError(id, "ponteiros de dados em numero diferente das chaves");
+      }
+      if (leafDepth == 0) {
+        leafDepth = depth;
+      } else if (depth != leafDepth) {
+        addError(id, "folha na profundidade " + to_string(depth) +
+                         ", esperada " + to_string(leafDepth));
+      }
+      leavesInOrder.push_back(id);
+      report.leaves++;
+      report.entries += n;
+      return n;
+    }
+
+    if (n > treeOrder - 1) {
+      addError(id, "no interno acima da capacidade");
+    }
+    if (node->childNodeIds.size() != static_cast<size_t>(n) + 1 ||
+        node->childCounts.size() != node->childNodeIds.size()) {
+      addError(id, "filhos/contagens em numero diferente de chaves + 1");
+      return 0;
+    }
+    // O buffer de nós não é usado: `node` continua válido durante a recursão.
+    long long total = 0;
+    for (int i = 0; i <= n; ++i) {
+      const int *childLow = i > 0 ? &node->keys[i - 1] : low;
+      const int *childHigh = i < n ? &node->keys[i] : high;
+      long long childEntries =
+          visit(node->childNodeIds[i], depth + 1, childLow, childHigh);
+      if (childEntries != node->childCounts[i]) {
+        addError(id, "contagem do filho " + to_string(node->childNodeIds[i]) +
+                         " e " + to_string(node->childCounts[i]) +
+                         ", mas a subarvore tem " + to_string(childEntries));
+      }
+      total += childEntries;
+    }
+    return total;
+  };
+  if (rootNodeId != 0) {
+    visit(rootNodeId, 1, nullptr, nullptr);
+  }
+  report.height = leafDepth;
+
+  // Encadeamento das folhas: deve seguir exatamente a ordem do percurso.
+  for (size_t i = 0; i < leavesInOrder.size(); ++i) {
+    Node *leaf = nodeAt(leavesInOrder[i]);
+    NodeId expectedPrev = i > 0 ? leavesInOrder[i - 1] : 0;
+    NodeId expectedNext =
+        i + 1 < leavesInOrder.size() ? leavesInOrder[i + 1] : 0;
+    if (leaf->prevLeafId != expectedPrev) {
+      addError(leaf->id, "ant = " + to_string(leaf->prevLeafId) +
+                             ", esperado " + to_string(expectedPrev));
+    }
+    if (leaf->nextLeafId != expectedNext) {
+      addError(leaf->id, "prox = " + to_string(leaf->nextLeafId) +
+                             ", esperado " + to_string(expectedNext));
+    }
+  }
+
+  // Páginas livres não podem estar na árvore; as demais inalcançáveis devem
+  // ser livres ou estar retidas por snapshots.
+  vector<char> accounted(nodes.size(), 0);
+  for (NodeId freeId : freePageIds) {
+    if (freeId < 1 || freeId >= nextNodeIdCounter) {
+      addError(freeId, "pagina livre fora do arquivo");
+      continue;
+    }
+    if (freeId <= static_cast<NodeId>(nodes.size())) {
+      if (reached[freeId - 1]) {
+        addError(freeId, "pagina livre alcancavel a partir da raiz");
+      }
+      accounted[freeId - 1] = 1;
+    }
+    report.freePages++;
+  }
+  for (const auto &retired : retiredPages) {
+    if (retired.second >= 1 &&
+        retired.second <= static_cast<NodeId>(nodes.size()) &&
+        !accounted[retired.second - 1]) {
+      accounted[retired.second - 1] = 1;
+      report.retainedPages++;
+    }
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    NodeId id = static_cast<NodeId>(i) + 1;
+    if (id >= nextNodeIdCounter) {
+      addError(id, "alem de NEXT_NODE_ID (" + to_string(nextNodeIdCounter) +
+                       ")");
+    } else if (!reached[i] && !accounted[i]) {
+      if (nodes[i] == nullptr) {
+        addError(id, "linha ilegivel fora da arvore");
+      } else {
+        report.leakedPages++;
+      }
+    }
+  }
+
+  for (Node *n : nodes)
+    delete n;
+  return report;
+}
+
+/**
+ * Reescreve o índice em ordem de chave: as folhas recebem os IDs 1..n, na
+ * ordem do encadeamento, com até fillFactor*(ordem-1) entradas cada, e os
+ * níveis internos vêm em seguida, do mais baixo até a raiz. IDs de filhos e de
+ * vizinhos são remapeados e as contagens por filho recalculadas. O novo
+ * arquivo é escrito à parte e substitui o antigo ao final.
+ * fillFactor Fração (0, 1] de ocupação desejada para folhas e nós internos.
+ */
+void BPlusTree::reorganize(double fillFactor) {
+  lock_guard<mutex> lock(snapshotMutex);
+  if (!pinnedVersions.empty()) {
+    // A reescrita troca todos os IDs e invalidaria os snapshots fixados.
+    cerr << "Erro: REORG não é permitido enquanto houver snapshots fixados."
+         << endl;
+    return;
+  }
+  flushAndClearNodeBuffer();
+
+  // Coleta todas as entradas em ordem, seguindo o encadeamento de folhas.
+  vector<Node *> nodes = readAllNodesSequentially();
+  auto nodeAt = [&](NodeId id) -> Node * {
+    return (id >= 1 && id <= static_cast<NodeId>(nodes.size())) ? nodes[id - 1]
+                                                                : nullptr;
+  };
+  vector<int> allKeys;
+  vector<RecordPointer> allPointers;
+  Node *node = nodeAt(rootNodeId);
+  while (node != nullptr && !node->isLeaf && !node->childNodeIds.empty()) {
+    node = nodeAt(node->childNodeIds[0]);
+  }
+  size_t visited = 0;
+  while (node != nullptr && node->isLeaf && visited++ < nodes.size()) {
+    allKeys.insert(allKeys.end(), node->keys.begin(),
+                   node->keys.begin() + node->numKeys);
+    allPointers.insert(allPointers.end(), node->dataPointers.begin(),
+                       node->dataPointers.begin() + node->numKeys);
+    node = nodeAt(node->nextLeafId);
+  }
+  for (Node *n : nodes)
+    delete n;
+
+  writeBulkIndex(allKeys, allPointers, fillFactor);
+}
+
+/**
+ * Substitui todo o conteúdo do índice pelas entradas dadas, já ordenadas por
+ * (chave, ponteiro), com a mesma construção de baixo para cima de
+ * reorganize. Usado na construção paralela a partir do CSV inteiro.
+ * retorna false se houver snapshots fixados ou o arquivo não puder ser escrito.
+ */
+bool BPlusTree::bulkLoad(const vector<pair<int, RecordPointer>> &sortedEntries,
+                         double fillFactor) {
+  lock_guard<mutex> lock(snapshotMutex);
+  if (!pinnedVersions.empty()) {
+    cerr << "Erro: A carga em bloco não é permitida enquanto houver "
+            "snapshots fixados."
+         << endl;
+    return false;
+  }
+  flushAndClearNodeBuffer();
+  vector<int> allKeys;
+  vector<RecordPointer> allPointers;
+  allKeys.reserve(sortedEntries.size());
+  allPointers.reserve(sortedEntries.size());
+  for (const auto &entry : sortedEntries) {
+    allKeys.push_back(entry.first);
+    allPointers.push_back(entry.second);
+  }
+  return writeBulkIndex(allKeys, allPointers, fillFactor);
+}
+
+/**
+ * Constrói o índice de baixo para cima a partir das entradas ordenadas e o
+ * grava num arquivo novo que substitui o atual. Chamado com snapshotMutex
+ * travado e o buffer de nó vazio. retorna false se o arquivo não puder ser
+ * criado (o índice antigo continua valendo).
+ */
+bool BPlusTree::writeBulkIndex(const vector<int> &allKeys,
+                               const vector<RecordPointer> &allPointers,
+                               double fillFactor) {
+  fillFactor = min(1.0, max(0.01, fillFactor));
+  int perLeaf = max(1, min(treeOrder - 1,
+                           static_cast<int>(fillFactor * (treeOrder - 1))));
+  int perInternal =
+      max(2, min(treeOrder, static_cast<int>(fillFactor * treeOrder)));
+
+  // Cada nó de um nível, na ordem das chaves: ID, menor chave e entradas.
+  struct LevelEntry {
+    NodeId id;
+    int minKey;
+    long long count;
+  };
+  vector<string> nodeLines;
+  vector<LevelEntry> level;
+
+  // Folhas: distribui as entradas igualmente entre ceil(E/perLeaf) folhas.
+  // Com folhas comprimidas numa página, enche cada folha até fillFactor do
+  // espaço da página, medido pelo tamanho da codificação delta + varint.
+  long long totalEntries = static_cast<long long>(allKeys.size());
+  vector<int> leafSizes;
+  if (compressLeaves && pageSize > 0) {
+    int budget = max(1, static_cast<int>(fillFactor * leafPayloadCapacity()) -
+                            MAX_ENCODED_ENTRY_GROWTH);
+    int bytes = 0, size = 0;
+    for (long long i = 0; i < totalEntries; ++i) {
+      int entryBytes =
+          size == 0 ? zigzagVarintSize(allKeys[i]) +
+                          zigzagVarintSize(allPointers[i])
+                    : varintSize(static_cast<unsigned long long>(
+                          static_cast<long long>(allKeys[i]) - allKeys[i - 1])) +
+                          zigzagVarintSize(static_cast<long long>(allPointers[i]) -
+                                           allPointers[i - 1]);
+      if (size > 0 && bytes + entryBytes > budget) {
+        leafSizes.push_back(size);
+        size = 0;
+        bytes = zigzagVarintSize(allKeys[i]) + zigzagVarintSize(allPointers[i]);
+      } else {
+        bytes += entryBytes;
+      }
+      size++;
+    }
+    if (size > 0)
+      leafSizes.push_back(size);
+  } else {
+    long long numLeaves = (totalEntries + perLeaf - 1) / perLeaf;
+    for (long long i = 0; i < numLeaves; ++i) {
+      leafSizes.push_back(static_cast<int>(totalEntries / numLeaves +
+                                           (i < totalEntries % numLeaves)));
+    }
+  }
+  long long numLeaves = static_cast<long long>(leafSizes.size());
+  for (long long i = 0, pos = 0; i < numLeaves; ++i) {
+    int size = leafSizes[i];
+    Node leaf(treeOrder, true, i + 1);
+    leaf.keys.assign(allKeys.begin() + pos, allKeys.begin() + pos + size);
+    leaf.dataPointers.assign(allPointers.begin() + pos,
+                             allPointers.begin() + pos + size);
+    leaf.numKeys = size;
+    leaf.prevLeafId = i > 0 ? i : 0;
+    leaf.nextLeafId = i < numLeaves - 1 ? i + 2 : 0;
+    nodeLines.push_back(formatNodeString(&leaf));
+    level.push_back({leaf.id, leaf.keys[0], size});
+    pos += size;
+  }
+
+  // Níveis internos: agrupa os nós do nível abaixo até restar a raiz. O
+  // número de grupos é limitado para que nenhum nó fique com um só filho.
+  while (level.size() > 1) {
+    long long n = static_cast<long long>(level.size());
+    long long groups = max(1LL, min((n + perInternal - 1) / perInternal, n / 2));
+    vector<LevelEntry> upper;
+    for (long long g = 0, pos = 0; g < groups; ++g) {
+      long long size = n / groups + (g < n % groups);
+      Node internal(treeOrder, false, static_cast<NodeId>(nodeLines.size()) + 1);
+      long long total = 0;
+      for (long long j = pos; j < pos + size; ++j) {
+        if (j > pos)
+          internal.keys.push_back(level[j].minKey);
+        internal.childNodeIds.push_back(level[j].id);
+        internal.childCounts.push_back(level[j].count);
+        total += level[j].count;
+      }
+      internal.numKeys = static_cast<int>(size - 1);
+      nodeLines.push_back(formatNodeString(&internal));
+      upper.push_back({internal.id, level[pos].minKey, total});
+      pos += size;
+    }
+    level = upper;
+  }
+
+  NodeId oldRootNodeId = rootNodeId, oldNextNodeIdCounter = nextNodeIdCounter;
+  vector<NodeId> oldFreePageIds;
+  oldFreePageIds.swap(freePageIds); // o arquivo novo não tem páginas livres
+  rootNodeId = level.empty() ? 0 : level[0].id; // usados no novo cabeçalho
+  nextNodeIdCounter = static_cast<NodeId>(nodeLines.size()) + 1;
+
+  string tempPath = indexFilePath + ".reorg";
+  ofstream outFile(tempPath, ios::trunc);
+  if (!outFile.is_open()) {
+    cerr << "Erro: Não foi possível criar o arquivo " << tempPath << endl;
+    rootNodeId = oldRootNodeId; // o índice antigo continua valendo
+    nextNodeIdCounter = oldNextNodeIdCounter;
+    freePageIds.swap(oldFreePageIds);
+    return false;
+  }
+  for (const auto &l : formatHeaderLines())
+    outFile << l << "\n";
+  for (const auto &l : nodeLines)
+    outFile << l << "\n";
+  outFile.close();
+  filesystem::rename(tempPath, indexFilePath);
+  headerOnDisk = formatHeaderLines();
+
+  // Todos os nós foram regravados: nenhum é mais da versão em construção.
+  nodeBirthVersion.clear();
+  retiredPages.clear();
+  committedRootId = rootNodeId;
+  committedVersion++;
+  return true;
+}
+
+/**
+ * Indica se algum snapshot fixado pode enxergar o nó: o nó foi gravado numa
+ * versão já confirmada até a versão do snapshot mais recente. Nós criados
+ * depois disso (inclusive os da inserção em andamento) podem ser alterados no
+ * lugar.
+ */
+bool BPlusTree::isSharedWithSnapshot(NodeId nodeId) const {
+  if (pinnedVersions.empty())
+    return false;
+  auto it = nodeBirthVersion.find(nodeId);
+  long long birth = it == nodeBirthVersion.end() ? 0 : it->second;
+  return birth <= pinnedVersions.rbegin()->first;
+}
+
+/**
+ * Garante que o nó possa ser alterado pela inserção em andamento. Se algum
+ * snapshot o enxerga, grava uma cópia numa página nova, retira a página antiga
+ * (ela deixa de valer a partir da próxima versão) e retorna o ID da cópia; o
+ * chamador atualiza o ponteiro no pai. Para folhas, os vizinhos passam a
+ * apontar para a cópia no próprio lugar: snapshots não seguem esses ponteiros.
+ */
+NodeId BPlusTree::copyOnWrite(NodeId nodeId) {
+  if (!isSharedWithSnapshot(nodeId))
+    return nodeId;
+  Node *original = accessNode(nodeId);
+  if (!original)
+    return nodeId;
+  Node copy = *original; // o buffer será reutilizado
+
+  Node *fresh = createNewBufferedNode(copy.isLeaf);
+  NodeId copyId = fresh->id;
+  *fresh = copy;
+  fresh->id = copyId;
+  markCurrentNodeDirty();
+  retiredPages.push_back({committedVersion + 1, nodeId});
+
+  if (copy.isLeaf) {
+    if (Node *prev = accessNode(copy.prevLeafId)) {
+      prev->nextLeafId = copyId;
+      markCurrentNodeDirty();
+    }
+    if (Node *next = accessNode(copy.nextLeafId)) {
+      next->prevLeafId = copyId;
+      markCurrentNodeDirty();
+    }
+  }
+  return copyId;
+}
+
+/**
+ * Confirma a inserção em andamento: grava o nó em buffer, se estiver sujo,
+ * para que todas as páginas da nova versão estejam no arquivo, e só então
+ * publica a raiz de trabalho como raiz confirmada.
+ */
+void BPlusTree::commitVersion() {
+  if (currentIndexNodeInRam != nullptr && currentIndexNodeDirty) {
+    saveNodeToFile(currentIndexNodeInRam);
+    currentIndexNodeDirty = false;
+  }
+  committedRootId = rootNodeId;
+  committedVersion++;
+}
+
+/**
+ * Move para a lista livre as páginas retiradas que nenhum snapshot fixado
+ * enxerga: uma página retirada na versão v só é vista por snapshots de versão
+ * menor que v.
+ */
+void BPlusTree::reclaimRetiredPages() {
+  long long oldestPinned =
+      pinnedVersions.empty() ? LLONG_MAX : pinnedVersions.begin()->first;
+  size_t kept = 0;
+  for (const auto &retired : retiredPages) {
+    if (retired.first <= oldestPinned) {
+      freePageIds.push_back(retired.second);
+      nodeBirthVersion.erase(retired.second);
+    } else {
+      retiredPages[kept++] = retired;
+    }
+  }
+  retiredPages.resize(kept);
+}
+
+/**
+ * Fixa a última versão confirmada. Até releaseSnapshot, os nós alcançáveis a
+ * partir da raiz do snapshot não são alterados nem reaproveitados.
+ */
+TreeSnapshot BPlusTree::pinSnapshot() {
+  lock_guard<mutex> lock(snapshotMutex);
+  TreeSnapshot snapshot;
+  snapshot.version = committedVersion;
+  snapshot.rootNodeId = committedRootId;
+  pinnedVersions[snapshot.version]++;
+  return snapshot;
+}
+
+/**
+ * Libera um snapshot fixado e recupera as páginas que só ele segurava.
+ */
+void BPlusTree::releaseSnapshot(const TreeSnapshot &snapshot) {
+  lock_guard<mutex> lock(snapshotMutex);
+  auto it = pinnedVersions.find(snapshot.version);
+  if (it == pinnedVersions.end()) {
+    cerr << "Aviso: snapshot da versão " << snapshot.version
+         << " não está fixado." << endl;
+    return;
+  }
+  if (--it->second == 0) {
+    pinnedVersions.erase(it);
+  }
+  reclaimRetiredPages();
+}
+
+int BPlusTree::pinnedSnapshotCount() {
+  lock_guard<mutex> lock(snapshotMutex);
+  int total = 0;
+  for (const auto &pinned : pinnedVersions)
+    total += pinned.second;
+  return total;
+}
+
+int BPlusTree::freePageCount() {
+  lock_guard<mutex> lock(snapshotMutex);
+  return static_cast<int>(freePageIds.size());
+}
+
+TreeStats BPlusTree::getStats() {
+  lock_guard<mutex> lock(statsMutex);
+  return stats;
+}
+
+void BPlusTree::countStat(long long TreeStats::*counter) {
+  lock_guard<mutex> lock(statsMutex);
+  ++(stats.*counter);
+}
+
+void LatencyHistogram::record(double micros) {
+  int bucket = 0;
+  while (bucket < BUCKETS - 1 && micros >= static_cast<double>(1LL << bucket)) {
+    bucket++;
+  }
+  buckets[bucket]++;
+  samples++;
+  totalMicros += micros;
+}
+
+long long LatencyHistogram::percentileMicros(double fraction) const {
+  long long wanted = static_cast<long long>(ceil(fraction * samples));
+  long long seen = 0;
+  for (int bucket = 0; bucket < BUCKETS; ++bucket) {
+    seen += buckets[bucket];
+    if (seen >= wanted && seen > 0)
+      return 1LL << bucket;
+  }
+  return 0;
+}
+
+/**
+ * Uma linha de JSON com os contadores e, para cada histograma, o número de
+ * amostras, a média, p50/p99 e as faixas (limites superiores em us).
+ */
+string TreeStats::toJson() const {
+  auto histogramJson = [](const LatencyHistogram &h) {
+    stringstream out;
+    out << "{\"samples\":" << h.samples << ",\"mean\":" << h.meanMicros()
+        << ",\"p50\":" << h.percentileMicros(0.50)
+        << ",\"p99\":" << h.percentileMicros(0.99) << ",\"buckets\":{";
+    bool first = true;
+    for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+      if (h.buckets[bucket] == 0)
+        continue;
+      out << (first ? "" : ",") << "\"" << (1LL << bucket)
+          << "\":" << h.buckets[bucket];
+      first = false;
+    }
+    out << "}}";
+    return out.str();
+  };
+  stringstream out;
+  out << "{\"node_reads\":" << nodeReads << ",\"node_writes\":" << nodeWrites
+      << ",\"bytes_read\":" << bytesRead << ",\"bytes_written\":"
+      << bytesWritten << ",\"buffer_hits\":" << bufferHits
+      << ",\"buffer_misses\":" << bufferMisses << ",\"leaf_splits\":"
+      << leafSplits << ",\"internal_splits\":" << internalSplits
+      << ",\"root_splits\":" << rootSplits << ",\"descents\":" << descents
+      << ",\"leaf_hops\":" << leafHops << ",\"height\":" << height
+      << ",\"read_latency_us\":" << histogramJson(readLatency)
+      << ",\"write_latency_us\":" << histogramJson(writeLatency) << "}";
+  return out.str();
+}
+
+/**
+ * Lista, em ordem de chave, as entradas de um snapshot fixado no intervalo
+ * fechado [lowKey, highKey]. Lê os nós direto do arquivo, sem o buffer de nó
+ * e sem travas, descendo só pelos filhos que podem conter chaves do
+ * intervalo.
+ */
+vector<pair<int, RecordPointer>>
+BPlusTree::scanSnapshot(const TreeSnapshot &snapshot, int lowKey,
+                        int highKey) {
+  vector<pair<int, RecordPointer>> entries;
+  if (snapshot.rootNodeId != 0 && lowKey <= highKey) {
+    scanSubtree(snapshot.rootNodeId, lowKey, highKey, entries);
+  }
+  return entries;
+}
+
+/**
+ * Auxiliar recursiva de scanSnapshot. Num nó interno, o filho i só tem chaves
+ * <= keys[i] e >= keys[i-1], então bastam os filhos de lower_bound(lowKey) até
+ * upper_bound(highKey).
+ */
+void BPlusTree::scanSubtree(NodeId nodeId, int lowKey, int highKey,
+                            vector<pair<int, RecordPointer>> &out) {
+  Node *node = loadNodeFromFile(nodeId);
+  if (!node) {
+    cerr << "Erro: Não foi possível ler o nó " << nodeId
+         << " do snapshot." << endl;
+    return;
+  }
+  auto keysEnd = node->keys.begin() + node->numKeys;
+  if (node->isLeaf) {
+    for (auto it = lower_bound(node->keys.begin(), keysEnd, lowKey);
+         it != keysEnd && *it <= highKey; ++it) {
+      out.push_back({*it, node->dataPointers[it - node->keys.begin()]});
+    }
+  } else {
+    long first = lower_bound(node->keys.begin(), keysEnd, lowKey) -
+                 node->keys.begin();
+    long last = upper_bound(node->keys.begin(), keysEnd, highKey) -
+                node->keys.begin();
+    if (last >= static_cast<long>(node->childNodeIds.size())) {
+      last = static_cast<long>(node->childNodeIds.size()) - 1; // nó sem filhos
+    }
+    vector<NodeId> children(node->childNodeIds.begin() + first,
+                         node->childNodeIds.begin() + last + 1);
+    delete node;
+    node = nullptr;
+    for (NodeId childId : children) {
+      scanSubtree(childId, lowKey, highKey, out);
+    }
+  }
+  delete node;
+}
+
 /**
  * imprime a estrutura da árvore B+ para fins de depuração
  * mostra a ordem da árvore, o ID da raiz e o próximo ID de nó disponível
@@ -933,8 +2219,11 @@ vector<int> BPlusTree::search(int key) {
  * gerencia o buffer de nó para não interferir na impressão
  */
 void BPlusTree::printTreeForDebug() {
-  cout << "Estrutura da Árvore B+ (Ordem: " << treeOrder << ")"
-            << endl;
+  cout << "Estrutura da Árvore B+ (Ordem: " << treeOrder;
+  if (pageSize > 0) {
+    cout << ", Página: " << pageSize << " bytes";
+  }
+  cout << ")" << endl;
   if (rootNodeId == 0) {
     cout << "  Árvore está vazia." << endl;
     return;
@@ -942,10 +2231,17 @@ void BPlusTree::printTreeForDebug() {
   cout << "  ID do Nó Raiz: " << rootNodeId << endl;
   cout << "  Contador do Próximo ID de Nó para novos nós: "
             << nextNodeIdCounter << endl;
+  {
+    lock_guard<mutex> lock(snapshotMutex);
+    if (!freePageIds.empty() || !pinnedVersions.empty()) {
+      cout << "  Páginas livres: " << freePageIds.size()
+           << ", versões fixadas: " << pinnedVersions.size() << endl;
+    }
+  }
 
   // salva o estado do buffer de nó atual para restaurá-lo após a impressão
   Node *tempSavedNode = nullptr;
-  int tempSavedId = 0;
+  NodeId tempSavedId = 0;
   bool tempSavedDirty = false;
 
   if (currentIndexNodeInRam) {
@@ -988,7 +2284,7 @@ void BPlusTree::printTreeForDebug() {
  * nodeIdToPrint O ID do nó a ser impresso
  * level O nível de profundidade do nó na árvore (usado para indentação)
  */
-void BPlusTree::printNodeRecursive(int nodeIdToPrint, int level) {
+void BPlusTree::printNodeRecursive(NodeId nodeIdToPrint, int level) {
   if (nodeIdToPrint == 0)
     return;
   Node *node = accessNode(nodeIdToPrint); // carrega o nó para o buffer
@@ -1013,13 +2309,20 @@ void BPlusTree::printNodeRecursive(int nodeIdToPrint, int level) {
       cout << node->dataPointers[i] << (i == node->numKeys - 1 ? "" : ",");
     }
     cout << ") Ant: " << node->prevLeafId << " Prox: " << node->nextLeafId;
+  } else {
+    cout << " Entradas: (";
+    for (size_t i = 0; i < node->childCounts.size(); ++i) {
+      cout << node->childCounts[i]
+           << (i == node->childCounts.size() - 1 ? "" : ",");
+    }
+    cout << ")";
   }
   cout << endl;
 
   // se não for folha, imprime recursivamente os filhos
   if (!node->isLeaf) {
-    vector<int> children = node->childNodeIds;
-    for (int child_id : children) {
+    vector<NodeId> children = node->childNodeIds;
+    for (NodeId child_id : children) {
       if (child_id !=
           0) { // add verificação para não tentar imprimir filho com ID 0
         printNodeRecursive(child_id, level + 1);
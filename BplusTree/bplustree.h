@@ -8,28 +8,41 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath> // Para ceil
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include "leaf_encoding.h"
+
+using namespace std;
 
 // Declaração antecipada
 class BPlusTree;
 
+// IDs de nó (linha do nó no arquivo de índice) e ponteiros de registro (linha
+// em vinhos.csv) têm 64 bits. No arquivo continuam em decimal, e nas folhas
+// comprimidas em varint, então valores pequenos ocupam o mesmo espaço de antes.
+using NodeId = long long;
+using RecordPointer = long long;
+
 struct Node {
-    int id;         // Número da linha no arquivo de índice (base 1 para o ID do nó em si). 0 se ainda não persistido ou inválido.
+    NodeId id;      // Número da linha no arquivo de índice (base 1 para o ID do nó em si). 0 se ainda não persistido ou inválido.
     bool isLeaf;
     vector<int> keys;
     int numKeys;    // Número atual de chaves no nó
 
     // Para nós internos
-    vector<int> childNodeIds; // IDs (IDs dos nós) dos nós filhos
+    vector<NodeId> childNodeIds;   // IDs (IDs dos nós) dos nós filhos
+    vector<long long> childCounts; // Número de entradas na subárvore de cada filho
 
     // Para nós folha
-    vector<int> dataPointers; // Ponteiros (números de linha reais em vinhos.csv, base 1, incluindo cabeçalho)
-    int prevLeafId; // ID do nó folha anterior (0 se nenhum)
-    int nextLeafId; // ID do nó folha seguinte (0 se nenhum)
+    vector<RecordPointer> dataPointers; // Ponteiros (números de linha reais em vinhos.csv, base 1, incluindo cabeçalho)
+    NodeId prevLeafId; // ID do nó folha anterior (0 se nenhum)
+    NodeId nextLeafId; // ID do nó folha seguinte (0 se nenhum)
 
     int order;      // Número máximo de filhos (m) para um nó interno. Máximo de chaves é m-1.
     // bool dirty; // Isso será gerenciado pela classe BPlusTree para o nó em buffer
 
-    Node(int m, bool leaf, int nodeId = 0)
+    Node(int m, bool leaf, NodeId nodeId = 0)
         : id(nodeId), isLeaf(leaf), numKeys(0), prevLeafId(0), nextLeafId(0), order(m){
         // Máximo de chaves é order-1. Reserva espaço, +1 para estouro temporário durante a divisão.
         keys.reserve(m); 
@@ -37,6 +50,7 @@ struct Node {
             dataPointers.reserve(m); 
         } else {
             childNodeIds.reserve(m + 1); // Máximo de filhos da ordem
+            childCounts.reserve(m + 1);
         }
     }
 
@@ -59,67 +73,259 @@ struct Node {
             cout << "  IDs dos Filhos: ";
             for (size_t i = 0; i < childNodeIds.size(); ++i) cout << childNodeIds[i] << " ";
             cout << endl;
+            cout << "  Entradas por Filho: ";
+            for (size_t i = 0; i < childCounts.size(); ++i) cout << childCounts[i] << " ";
+            cout << endl;
         }
     }
 };
 
+// Métricas de disposição física das folhas no arquivo de índice
+struct LayoutStats {
+    int height = 0;             // Níveis da raiz até as folhas
+    long long leafCount = 0;
+    long long entries = 0;      // Entradas (chave, ponteiro) nas folhas
+    long long sequentialHops = 0; // Saltos para a próxima folha com nextLeafId == id + 1
+    long long totalHopDistance = 0; // Soma de |nextLeafId - id| ao longo do encadeamento
+    double avgLeafFill = 0.0;   // Entradas / (folhas * (ordem - 1)); em bytes se as folhas forem comprimidas
+
+    long long hops() const { return leafCount > 1 ? leafCount - 1 : 0; }
+    // Fração dos saltos entre folhas que não são para o nó seguinte no arquivo
+    double fragmentation() const { return hops() ? 1.0 - static_cast<double>(sequentialHops) / hops() : 0.0; }
+    double avgHopDistance() const { return hops() ? static_cast<double>(totalHopDistance) / hops() : 0.0; }
+};
+
+// Resultado de BPlusTree::verify
+struct VerifyReport {
+    static const size_t MAX_REPORTED_ERRORS = 50;
+
+    long long nodesRead = 0;      // Linhas de nó lidas do arquivo
+    long long reachableNodes = 0; // Nós alcançados a partir da raiz
+    long long leaves = 0;
+    long long entries = 0;
+    int height = 0;
+    long long freePages = 0;      // Páginas em FREE_PAGES
+    long long retainedPages = 0;  // Retiradas, ainda visíveis a snapshots fixados
+    long long leakedPages = 0;    // Inalcançáveis, sem estar livres nem retidas
+    long long errorCount = 0;
+    vector<string> errors;        // As primeiras MAX_REPORTED_ERRORS, "no <id>: <problema>"
+
+    bool ok() const { return errorCount == 0; }
+};
+
+// Histograma de latências em faixas de potência de 2: a faixa 0 conta as
+// amostras abaixo de 1 us e a faixa i, as de [2^(i-1), 2^i) us.
+struct LatencyHistogram {
+    static const int BUCKETS = 32;
+    long long buckets[BUCKETS] = {};
+    long long samples = 0;
+    double totalMicros = 0.0;
+
+    void record(double micros);
+    double meanMicros() const { return samples ? totalMicros / static_cast<double>(samples) : 0.0; }
+    long long percentileMicros(double fraction) const; // Limite superior da faixa que contém o percentil
+};
+
+// Contadores de custo da árvore desde a abertura do índice. Contam as leituras
+// e gravações de nós feitas pelo buffer e pelas varreduras de snapshots; REORG
+// e a carga em bloco leem e gravam o arquivo inteiro de uma vez e não entram.
+struct TreeStats {
+    long long nodeReads = 0;      // Chamadas a loadNodeFromFile
+    long long nodeWrites = 0;     // Chamadas a saveNodeToFile
+    long long bytesRead = 0;      // Bytes percorridos no arquivo de índice para ler nós
+    long long bytesWritten = 0;   // Bytes gravados no arquivo de índice ao salvar nós
+    long long bufferHits = 0;     // accessNode atendido pelo nó já em buffer
+    long long bufferMisses = 0;   // accessNode que precisou ler o nó
+    long long leafSplits = 0;
+    long long internalSplits = 0;
+    long long rootSplits = 0;     // Novas raízes (a altura cresce)
+    long long descents = 0;       // Descidas da raiz até uma folha (busca ou inserção)
+    long long leafHops = 0;       // Passagens para a folha seguinte durante buscas
+    int height = 0;               // Níveis percorridos na última descida
+    LatencyHistogram readLatency;  // Por chamada a loadNodeFromFile
+    LatencyHistogram writeLatency; // Por chamada a saveNodeToFile
+
+    string toJson() const;
+};
+
+// Versão confirmada da árvore fixada por um leitor (ver BPlusTree::pinSnapshot).
+struct TreeSnapshot {
+    long long version = 0; // Número de inserções confirmadas no momento da fixação
+    NodeId rootNodeId = 0; // Raiz daquela versão (0 se a árvore estava vazia)
+};
+
 class BPlusTree {
 public:
-    BPlusTree(int order, const string& indexFileName, const string& dataFileName);
+    // order > 0 fixa a ordem explicitamente (FLH/<ordem>). Com order == 0 a
+    // ordem é derivada de pageSize (em bytes) e das larguras de chave/ponteiro.
+    // Se o arquivo de índice já existir, a ordem gravada no superbloco prevalece.
+    // compressLeaves grava as folhas comprimidas; com pageSize definido, a folha
+    // passa a caber tantas entradas quanto a página comportar depois da compressão.
+    BPlusTree(int order, const string& indexFileName, const string& dataFileName, int pageSize = 0,
+              bool compressLeaves = false);
     ~BPlusTree();
 
-    void insert(int key, int dataRecordId); // dataRecordId é o número real da linha em vinhos.csv
-    vector<int> search(int key); // Retorna vetor de dataRecordIds (números de linha em vinhos.csv)
+    // Maior ordem (fan-out) cujos nós folha e internos cabem em uma página de
+    // pageSize bytes, com IDs de nó e ponteiros de registro de pointerSize bytes.
+    static int orderForPageSize(int pageSize, int pointerSize = 4);
+    static bool isValidPageSize(int pageSize);
+    int getOrder() const { return treeOrder; }
+    int getPageSize() const { return pageSize; } // 0 se a ordem foi dada explicitamente
+    bool leavesCompressed() const { return compressLeaves; }
+    int getPointerSize() const { return pointerSize; } // PTR_SIZE do superbloco (4 ou 8)
+
+    void insert(int key, RecordPointer dataRecordId); // dataRecordId é o número real da linha em vinhos.csv
+    vector<RecordPointer> search(int key); // Retorna vetor de dataRecordIds (números de linha em vinhos.csv)
     void printTreeForDebug(); // Para depuração da árvore
 
+    // Estatísticas de ordem: usam as contagens por filho dos nós internos e
+    // descem um único caminho raiz-folha, sem percorrer o encadeamento de
+    // folhas nem ler vinhos.csv.
+    long long totalEntries();            // Número total de entradas (chave, ponteiro)
+    long long countLess(int key);        // Entradas com chave < key (rank)
+    long long countRange(int lowKey, int highKey); // Entradas com lowKey <= chave <= highKey
+    bool nthKey(long long n, int &keyOut); // Chave da n-ésima entrada (base 1) na ordem
+
+    // Reorganização: reescreve o índice com as folhas contíguas em ordem de
+    // chave (IDs 1..n), cada uma preenchida até fillFactor, seguidas dos níveis
+    // internos. Varreduras pelo encadeamento de folhas viram leituras sequenciais.
+    LayoutStats computeLayoutStats();
+    // Verificação de integridade com uma única leitura sequencial do índice
+    VerifyReport verify();
+    void reorganize(double fillFactor);
+    // Substitui o conteúdo pelas entradas (chave, ponteiro) já ordenadas,
+    // construindo a árvore de baixo para cima como reorganize.
+    bool bulkLoad(const vector<pair<int, RecordPointer>> &sortedEntries, double fillFactor = 1.0);
+
+    // Snapshots (shadow paging): cada inserção é confirmada como uma nova
+    // versão, com a troca da raiz feita sob snapshotMutex. Enquanto houver
+    // snapshots fixados, os nós que eles enxergam nunca são alterados: a
+    // inserção copia o caminho até a raiz (copy-on-write) e as páginas
+    // substituídas só voltam à lista livre quando o último snapshot que as
+    // enxerga é liberado. Há um único escritor; outras threads podem fixar,
+    // varrer e liberar snapshots, e scanSnapshot não usa travas nem o buffer
+    // de nó. A varredura desce pelos filhos e não segue o encadeamento de
+    // folhas, cujos ponteiros ant/prox são corrigidos no lugar.
+    TreeSnapshot pinSnapshot();
+    void releaseSnapshot(const TreeSnapshot &snapshot);
+    // Entradas (chave, ponteiro) com lowKey <= chave <= highKey na versão fixada
+    vector<pair<int, RecordPointer>> scanSnapshot(const TreeSnapshot &snapshot, int lowKey, int highKey);
+    int pinnedSnapshotCount();
+    int freePageCount();
+
+    // Cópia dos contadores de E/S, buffer, splits e descidas
+    TreeStats getStats();
+
+    // Grava o nó em buffer e o cabeçalho sem fechar a árvore
+    void sync();
+
 private:
     int treeOrder;
-    int rootNodeId;
+    int pageSize;   // Tamanho da página em bytes usado para derivar a ordem (0 = FLH explícito)
+    bool compressLeaves; // Folhas gravadas com LeafEncoding::DELTA_VARINT/FRAME_OF_REFERENCE
+    int pointerSize;     // Largura de IDs de nó e ponteiros de registro no cálculo da página
+    bool pointerWidthWarned; // Aviso de valor acima de pointerSize já emitido
+    NodeId rootNodeId;
     string indexFilePath;
     string dataFilePath; // vinhos.csv
-    int nextNodeIdCounter;    // Rastreia o próximo ID disponível para um novo nó
+    NodeId nextNodeIdCounter; // Rastreia o próximo ID disponível para um novo nó
+    vector<NodeId> freePageIds; // IDs de nós recuperados, reutilizados antes de nextNodeIdCounter
+    vector<string> headerOnDisk; // Cabeçalho como está no arquivo; só é regravado se mudar
+
+    // Versões e snapshots (protegidos por snapshotMutex)
+    mutex snapshotMutex;
+    long long committedVersion;  // Inserções confirmadas nesta sessão
+    NodeId committedRootId;      // Raiz da última versão confirmada
+    map<long long, int> pinnedVersions; // Versão -> número de snapshots fixados nela
+    unordered_map<NodeId, long long> nodeBirthVersion; // Versão em que o nó foi gravado (ausente = 0)
+    vector<pair<long long, NodeId>> retiredPages; // (primeira versão sem a página, ID do nó)
+
+    // Contadores; as leituras de nós também vêm das threads de snapshot, por
+    // isso todo contador é somado sob statsMutex
+    mutex statsMutex;
+    TreeStats stats;
+    void countStat(long long TreeStats::*counter); // ++stats.*counter sob statsMutex
 
     // Buffer para um nó de índice
     Node* currentIndexNodeInRam;
-    int currentIndexNodeInRamId;
+    NodeId currentIndexNodeInRamId;
     bool currentIndexNodeDirty;
 
     // Buffer para uma página de dados (registro de vinhos.csv)
     string currentDataRecordInRam; // Armazena o conteúdo da linha
-    int currentDataRecordInRamId;   // Armazena o número da linha (base 1) de vinhos.csv
+    RecordPointer currentDataRecordInRamId; // Armazena o número da linha (base 1) de vinhos.csv
 
     // Gerenciamento de buffer de nó
-    Node* accessNode(int nodeId); // Garante que o nó esteja em currentIndexNodeInRam, retorna-o. Lida com carga/salvamento do anterior.
+    Node* accessNode(NodeId nodeId); // Garante que o nó esteja em currentIndexNodeInRam, retorna-o. Lida com carga/salvamento do anterior.
     void markCurrentNodeDirty();
     Node* createNewBufferedNode(bool isLeaf); // Cria um novo nó, coloca-o no buffer, atribui ID.
 
     // Gerenciamento de buffer de dados
-    string accessDataRecord(int recordLineNumber); // Garante que o registro de dados esteja em currentDataRecordInRam
+    string accessDataRecord(RecordPointer recordLineNumber); // Garante que o registro de dados esteja em currentDataRecordInRam
 
     // Operações centrais da Árvore B+ (usarão accessNode, markCurrentNodeDirty, createNewBufferedNode)
-    int findLeafNodeIdToInsert(int key, vector<int>& pathNodeIds);
-    void insertIntoLeafNonFull(int leafNodeId, int key, int dataRecordId);
-    void splitAndInsertLeaf(int leafNodeId, int key, int dataRecordId, vector<int>& pathNodeIds);
-    void insertIntoParent(int oldChildNodeId, int keyToPushUp, int newChildNodeId, vector<int>& pathNodeIds);
+    void insertEntry(int key, RecordPointer dataRecordId); // Inserção sem confirmar a versão
+    // Com forInsert, prepara o caminho para a inserção: copia os nós compartilhados
+    // com snapshots e soma 1 à contagem do filho seguido em cada nó interno.
+    NodeId findLeafNodeIdToInsert(int key, vector<NodeId>& pathNodeIds, bool forInsert = false);
+    void insertIntoLeafNonFull(NodeId leafNodeId, int key, RecordPointer dataRecordId);
+    void splitAndInsertLeaf(NodeId leafNodeId, int key, RecordPointer dataRecordId, vector<NodeId>& pathNodeIds);
+    // leftCount/rightCount: entradas nas subárvores dos dois nós resultantes da divisão
+    void insertIntoParent(NodeId oldChildNodeId, int keyToPushUp, NodeId newChildNodeId, vector<NodeId>& pathNodeIds,
+                          long long leftCount, long long rightCount);
     // splitInternalNode faz parte de insertIntoParent se o pai estiver cheio
-    void createNewRootAndUpdate(int oldLeftChildId, int key, int oldRightChildId);
+    void createNewRootAndUpdate(NodeId oldLeftChildId, int key, NodeId oldRightChildId, long long leftCount,
+                                long long rightCount);
+    long long rebuildSubtreeCounts(NodeId nodeId); // Recalcula as contagens de índices antigos; retorna o total
+    void flushAndClearNodeBuffer(); // Salva o nó em buffer (se sujo) e esvazia o buffer
+    vector<Node*> readAllNodesSequentially(); // Lê o arquivo de índice inteiro de uma vez; posição i = nó i+1
+    // Construção de baixo para cima usada por reorganize e bulkLoad
+    bool writeBulkIndex(const vector<int>& allKeys, const vector<RecordPointer>& allPointers, double fillFactor);
+
+    // Copy-on-write (chamados com snapshotMutex travado)
+    bool isSharedWithSnapshot(NodeId nodeId) const;
+    NodeId copyOnWrite(NodeId nodeId); // Retorna o ID gravável do nó (o mesmo, se não compartilhado)
+    void commitVersion();        // Grava o buffer e publica a raiz como nova versão
+    void reclaimRetiredPages();  // Libera as páginas que nenhum snapshot fixado enxerga
+    void scanSubtree(NodeId nodeId, int lowKey, int highKey, vector<pair<int, RecordPointer>>& out);
 
     // E/S de Arquivo e Análise (permanecem basicamente os mesmos, mas interagem com a lógica do buffer)
-    Node* loadNodeFromFile(int nodeId); // Lógica real de leitura de arquivo
+    Node* loadNodeFromFile(NodeId nodeId); // Lógica real de leitura de arquivo
     void saveNodeToFile(Node* node);   // Lógica real de escrita de arquivo
     void initializeIndexFile(); // Renomeado de initializeIndexFileIfEmpty para clareza
-    string readLineFromFile(const string& filePath, int lineNumber); 
-    void writeLineToFile(const string& filePath, int lineNumber, const string& content);
+    void loadSuperblock();      // Lê e valida ORDER/PAGE_SIZE/KEY_SIZE/PTR_SIZE/LEAF_ENCODING
+    static int pointerSizeFor(const string& dataFileName); // 4 ou 8 bytes, pelo tamanho do arquivo de dados
+    void upgradeHeader(int oldHeaderLines); // Regrava cabeçalhos de formatos antigos completos
+    vector<string> formatHeaderLines() const;
+    void writeHeaderIfChanged();
+    // bytesScanned/bytesWritten, se dados, recebem os bytes percorridos/gravados
+    string readLineFromFile(const string& filePath, long long lineNumber, long long* bytesScanned = nullptr);
+    void writeLineToFile(const string& filePath, long long lineNumber, const string& content,
+                         long long* bytesWritten = nullptr);
     void appendLineToFile(const string& filePath, const string& content); // Pode não ser necessário se writeLineToFile preencher
-    int countLinesInFile(const string& filePath); // Renomeado
+    long long countLinesInFile(const string& filePath); // Renomeado
 
-    Node* parseNodeString(const string& line, int nodeIdFromFile);
+    Node* parseNodeString(const string& line, NodeId nodeIdFromFile);
     string formatNodeString(Node* node);
 
+    // Capacidade das folhas
+    int leafPayloadCapacity() const; // Bytes para entradas numa página de folha
+    bool isLeafFull(const Node* leaf, int key, RecordPointer dataRecordId) const;
+
     // Auxiliares de depuração
-    void printNodeRecursive(int nodeId, int level);
+    void printNodeRecursive(NodeId nodeId, int level);
+
+    // Cabeçalho (superbloco): ROOT_ID, NEXT_NODE_ID, ORDER, PAGE_SIZE, KEY_SIZE, PTR_SIZE,
+    // LEAF_ENCODING e FREE_PAGES
+    static const int HEADER_LINES = 8;
 
-    static const int HEADER_LINES = 2; // Para ROOT_ID e NEXT_NODE_ID no arquivo de índice
+    // Larguras usadas no cálculo do fan-out de uma página. IDs de nó, ponteiros
+    // de registro e contagens usam a largura compacta gravada em PTR_SIZE:
+    // 4 bytes, ou 8 quando o arquivo de dados passa de 2 GB.
+    static const int KEY_SIZE = sizeof(int);
+    static const int NARROW_POINTER_SIZE = 4;
+    static const int WIDE_POINTER_SIZE = 8;
+    static const int NODE_HEADER_SIZE = 8; // Tipo do nó + numKeys
 };
 
 #endif // BPLUSTREE_H
@@ -0,0 +1,94 @@
+#include "command_parser.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+bool readWholeFile(const string &path, string &contents) {
+  ifstream file(path, ios::binary | ios::ate);
+  if (!file.is_open())
+    return false;
+  streamoff size = file.tellg();
+  contents.resize(size > 0 ? static_cast<size_t>(size) : 0);
+  file.seekg(0);
+  file.read(&contents[0], static_cast<streamsize>(contents.size()));
+  contents.resize(static_cast<size_t>(file.gcount()));
+  return true;
+}
+
+// Fim da linha que começa em `pos`, sem o '\r' de arquivos do Windows.
+static size_t lineEnd(const string &text, size_t pos, size_t &next) {
+  const char *start = text.data() + pos;
+  const void *newline = memchr(start, '\n', text.size() - pos);
+  size_t end = newline ? pos + static_cast<size_t>(
+                                   static_cast<const char *>(newline) - start)
+                       : text.size();
+  next = newline ? end + 1 : end;
+  if (end > pos && text[end - 1] == '\r')
+    --end;
+  return end;
+}
+
+string_view firstLine(const string &text, size_t &next) {
+  size_t end = lineEnd(text, 0, next);
+  return string_view(text).substr(0, end);
+}
+
+// Converte o início de [first, last) num int com as regras de stoi: ignora
+// espaços à esquerda, aceita '+' ou '-' e para no primeiro caractere que não
+// é dígito. false se não houver número ou ele não couber num int.
+static bool parseInt(const char *first, const char *last, int &value) {
+  while (first != last && isspace(static_cast<unsigned char>(*first)))
+    ++first;
+  if (last - first > 1 && first[0] == '+' && first[1] != '-')
+    ++first; // from_chars não aceita '+'
+  return from_chars(first, last, value).ec == errc();
+}
+
+static bool startsWith(const char *line, size_t length, const char *prefix,
+                       size_t prefixLength) {
+  return length >= prefixLength && memcmp(line, prefix, prefixLength) == 0;
+}
+
+vector<Command> parseCommands(const string &text, size_t start) {
+  vector<Command> commands;
+  // Estimativa de ~10 bytes por comando evita a maioria das realocações.
+  commands.reserve((text.size() - min(start, text.size())) / 10 + 1);
+  size_t pos = start;
+  while (pos < text.size()) {
+    size_t next;
+    size_t end = lineEnd(text, pos, next);
+    const char *line = text.data() + pos;
+    size_t length = end - pos;
+    if (length > 0 && line[0] != '#') {
+      Command command = {CommandType::OTHER, 0, 0,
+                         static_cast<unsigned>(length), pos};
+      const char *last = line + length;
+      if (startsWith(line, length, "INC:", 4)) {
+        if (parseInt(line + 4, last, command.key))
+          command.type = CommandType::INSERT;
+      } else if (startsWith(line, length, "BUS=:", 5)) {
+        if (parseInt(line + 5, last, command.key))
+          command.type = CommandType::SEARCH;
+      } else if (startsWith(line, length, "COUNT=:", 7)) {
+        if (parseInt(line + 7, last, command.key))
+          command.type = CommandType::COUNT_EQUAL;
+      } else if (startsWith(line, length, "RANK:", 5)) {
+        if (parseInt(line + 5, last, command.key))
+          command.type = CommandType::RANK;
+      } else if (startsWith(line, length, "COUNT[", 6) && line[length - 1] == ']') {
+        const char *comma =
+            static_cast<const char *>(memchr(line + 6, ',', length - 6));
+        if (comma && parseInt(line + 6, comma, command.key) &&
+            parseInt(comma + 1, last - 1, command.highKey))
+          command.type = CommandType::COUNT_RANGE;
+      }
+      commands.push_back(command);
+    }
+    pos = next;
+  }
+  return commands;
+}
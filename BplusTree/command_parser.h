@@ -0,0 +1,48 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Leitura dos arquivos de entrada do main: o arquivo é lido de uma vez e os
+// comandos são analisados no próprio texto, sem uma string por linha. Os
+// comandos frequentes (INC, BUS=, COUNT=, COUNT[, RANK) já saem com as chaves
+// convertidas; os demais guardam só a posição da linha e são analisados por
+// quem os executa.
+enum class CommandType : unsigned char {
+    INSERT,      // INC:<chave>
+    SEARCH,      // BUS=:<chave>
+    COUNT_EQUAL, // COUNT=:<chave>
+    COUNT_RANGE, // COUNT[<min>,<max>]
+    RANK,        // RANK:<chave>
+    OTHER        // Qualquer outra linha, inclusive as malformadas
+};
+
+struct Command {
+    CommandType type;
+    int key;            // Chave, ou o mínimo de COUNT[
+    int highKey;        // Máximo de COUNT[
+    unsigned length;    // Tamanho da linha
+    size_t offset;      // Início da linha no texto da entrada
+};
+
+// Lê o arquivo inteiro em `contents`. false se não puder ser aberto.
+bool readWholeFile(const string &path, string &contents);
+
+// Primeira linha do texto (FLH/ ou PAG/) e a posição logo após ela.
+string_view firstLine(const string &text, size_t &next);
+
+// Analisa as linhas a partir de `start`, ignorando as vazias e as
+// iniciadas por '#'. Os argumentos são lidos como stoi os leria; um comando
+// frequente cujo argumento stoi recusaria vira OTHER, para que a mensagem de
+// erro seja a de sempre.
+vector<Command> parseCommands(const string &text, size_t start);
+
+inline string_view commandLine(const string &text, const Command &command) {
+    return string_view(text).substr(command.offset, command.length);
+}
+
+#endif // COMMAND_PARSER_H
@@ -0,0 +1,155 @@
+#include "datagen.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+long long DatasetSpec::distinctKeys() const {
+  double ratio = min(1.0, max(0.0, duplicateRatio));
+  return max(1LL, static_cast<long long>(static_cast<double>(rows) *
+                                         (1.0 - ratio)));
+}
+
+KeySampler::KeySampler(const DatasetSpec &spec)
+    : keyCount(spec.distinctKeys()), skew(max(0.0, spec.skew)) {}
+
+/**
+ * Inversa da distribuição contínua com densidade proporcional a x^-skew em
+ * [1, keyCount + 1): o posto r = floor(x) - 1 segue aproximadamente Zipf.
+ */
+int KeySampler::next(mt19937_64 &rng) const {
+  double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+  double n = static_cast<double>(keyCount);
+  double x;
+  if (skew == 0.0) {
+    x = 1.0 + u * n;
+  } else if (fabs(skew - 1.0) < 1e-9) {
+    x = pow(n + 1.0, u);
+  } else {
+    double e = 1.0 - skew;
+    x = pow(1.0 + u * (pow(n + 1.0, e) - 1.0), 1.0 / e);
+  }
+  long long rank = min(keyCount - 1, max(0LL, static_cast<long long>(x) - 1));
+  return FIRST_KEY + static_cast<int>(rank);
+}
+
+const char *workloadName(Workload workload) {
+  switch (workload) {
+  case Workload::INSERT:
+    return "inc";
+  case Workload::SEARCH:
+    return "bus";
+  case Workload::RANGE:
+    return "range";
+  case Workload::MIXED:
+    return "mixed";
+  }
+  return "";
+}
+
+bool parseWorkload(const string &name, Workload &out) {
+  for (Workload w : {Workload::INSERT, Workload::SEARCH, Workload::RANGE,
+                     Workload::MIXED}) {
+    if (name == workloadName(w)) {
+      out = w;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Grava o CSV em blocos de ~1 MB. Rótulos e tipos vêm de listas fixas; o
+ * ano_colheita é sorteado pelo KeySampler.
+ */
+bool generateWinesCsv(const string &path, const DatasetSpec &spec) {
+  static const char *adjectives[] = {"teal",  "forward", "foggy", "null",
+                                     "quiet", "bold",    "amber", "late"};
+  static const char *grapes[] = {"barolo",     "claret", "chardonnay",
+                                 "bardolino",  "merlot", "malbec",
+                                 "sauvignon",  "syrah"};
+  static const char *types[] = {"tinto", "branco", "rosé"};
+
+  ofstream out(path, ios::binary | ios::trunc);
+  if (!out.is_open()) {
+    cerr << "Erro: Não foi possível criar o arquivo de dados: " << path
+         << endl;
+    return false;
+  }
+  mt19937_64 rng(spec.seed);
+  KeySampler sampler(spec);
+  string buffer = "vinho_id,rotulo,ano_colheita,tipo\n";
+  for (long long i = 0; i < spec.rows; ++i) {
+    unsigned long long bits = rng();
+    buffer += to_string(i);
+    buffer += ',';
+    buffer += adjectives[bits % 8];
+    buffer += '-';
+    buffer += grapes[(bits >> 3) % 8];
+    buffer += ',';
+    buffer += to_string(sampler.next(rng));
+    buffer += ',';
+    buffer += types[(bits >> 6) % 3];
+    buffer += '\n';
+    if (buffer.size() >= (1 << 20)) {
+      out << buffer;
+      buffer.clear();
+    }
+  }
+  out << buffer;
+  return static_cast<bool>(out);
+}
+
+vector<BenchCommand> generateCommands(Workload workload, long long operations,
+                                      const DatasetSpec &spec,
+                                      int rangeWidth) {
+  mt19937_64 rng(spec.seed + 1);
+  KeySampler sampler(spec);
+  vector<BenchCommand> commands;
+  commands.reserve(static_cast<size_t>(max(0LL, operations)));
+  for (long long i = 0; i < operations; ++i) {
+    char type = 'B';
+    if (workload == Workload::INSERT) {
+      type = 'I';
+    } else if (workload == Workload::RANGE) {
+      type = 'R';
+    } else if (workload == Workload::MIXED) {
+      unsigned roll = static_cast<unsigned>(rng() % 10);
+      type = roll < 6 ? 'B' : roll < 8 ? 'R' : 'I';
+    }
+    int key = sampler.next(rng);
+    int highKey = key;
+    if (type == 'R') {
+      highKey = min(sampler.maxKey(),
+                    key + static_cast<int>(rng() % max(1, rangeWidth)));
+    }
+    commands.push_back({type, key, highKey});
+  }
+  return commands;
+}
+
+bool writeCommandFile(const string &path, const string &firstLine,
+                      bool startWithBuild,
+                      const vector<BenchCommand> &commands) {
+  ofstream out(path, ios::trunc);
+  if (!out.is_open()) {
+    cerr << "Erro: Não foi possível criar o arquivo de comandos: " << path
+         << endl;
+    return false;
+  }
+  out << firstLine << "\n";
+  if (startWithBuild)
+    out << "BUILD:1\n";
+  for (const BenchCommand &c : commands) {
+    if (c.type == 'I') {
+      out << "INC:" << c.key << "\n";
+    } else if (c.type == 'B') {
+      out << "BUS=:" << c.key << "\n";
+    } else {
+      out << "COUNT[" << c.key << "," << c.highKey << "]\n";
+    }
+  }
+  return static_cast<bool>(out);
+}
@@ -0,0 +1,71 @@
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Gerador de dados sintéticos no formato de vinhos.csv
+// (vinho_id,rotulo,ano_colheita,tipo) e de sequências de comandos no formato
+// de entrada do main, para medir a árvore em escalas maiores que o CSV de
+// exemplo.
+struct DatasetSpec {
+    long long rows = 10000;       // Linhas de dados (sem o cabeçalho)
+    double duplicateRatio = 0.99; // Fração das linhas que repetem uma chave já usada
+    double skew = 0.0;            // Expoente de Zipf da popularidade das chaves (0 = uniforme)
+    unsigned seed = 1;
+
+    // Número de valores distintos de ano_colheita: rows * (1 - duplicateRatio)
+    long long distinctKeys() const;
+};
+
+// Sorteia chaves com distribuição de Zipf sobre distinctKeys valores
+// consecutivos a partir de FIRST_KEY: a chave FIRST_KEY + r tem peso
+// 1 / (r + 1)^skew. Usa a inversa da distribuição contínua, que dispensa
+// tabelas e vale para qualquer número de chaves.
+class KeySampler {
+public:
+    explicit KeySampler(const DatasetSpec &spec);
+    int next(mt19937_64 &rng) const;
+    int minKey() const { return FIRST_KEY; }
+    int maxKey() const { return FIRST_KEY + static_cast<int>(keyCount - 1); }
+
+    static const int FIRST_KEY = 1900;
+
+private:
+    long long keyCount;
+    double skew;
+};
+
+// Tipos de carga das sequências de comandos
+enum class Workload { INSERT, SEARCH, RANGE, MIXED };
+
+const char *workloadName(Workload workload);
+bool parseWorkload(const string &name, Workload &out);
+
+// Um comando da sequência: INC:<key>, BUS=:<key> ou COUNT[<key>,<highKey>]
+struct BenchCommand {
+    char type; // 'I', 'B' ou 'R'
+    int key;
+    int highKey;
+};
+
+// Grava o CSV com spec.rows linhas. retorna false se o arquivo não puder ser
+// criado.
+bool generateWinesCsv(const string &path, const DatasetSpec &spec);
+
+// Sorteia `operations` comandos da carga. INSERT só insere; SEARCH só busca;
+// RANGE conta intervalos de até rangeWidth chaves; MIXED faz 60% de buscas,
+// 20% de intervalos e 20% de inserções.
+vector<BenchCommand> generateCommands(Workload workload, long long operations,
+                                      const DatasetSpec &spec, int rangeWidth = 10);
+
+// Grava os comandos no formato de entrada do main: a primeira linha
+// (FLH/<ordem> ou PAG/<bytes>), BUILD:1 se a carga começa com o índice
+// completo, e um comando por linha.
+bool writeCommandFile(const string &path, const string &firstLine, bool startWithBuild,
+                      const vector<BenchCommand> &commands);
+
+#endif // DATAGEN_H
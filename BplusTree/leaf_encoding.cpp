@@ -0,0 +1,246 @@
+#include "leaf_encoding.h"
+#include <algorithm>
+#include <array>
+
+using namespace std;
+
+// Zigzag: mapeia inteiros com sinal em sem sinal (0,-1,1,-2... -> 0,1,2,3...)
+// para que deltas negativos pequenos também virem varints curtas.
+static unsigned long long zigzagEncode(long long value) {
+  return (static_cast<unsigned long long>(value) << 1) ^
+         static_cast<unsigned long long>(value >> 63);
+}
+
+static long long zigzagDecode(unsigned long long value) {
+  return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+}
+
+// Varint LEB128: 7 bits por byte, bit alto indica continuação.
+static void appendVarint(string &out, unsigned long long value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+static bool readVarint(const string &in, size_t &pos, unsigned long long &value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+    unsigned char byte = static_cast<unsigned char>(in[pos++]);
+    value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false; // truncado
+}
+
+int varintSize(unsigned long long value) {
+  int size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+int zigzagVarintSize(long long value) { return varintSize(zigzagEncode(value)); }
+
+/**
+ * Chaves: a primeira em zigzag + varint e as seguintes como deltas (sempre >= 0,
+ * pois as chaves estão ordenadas) em varint. Chaves repetidas custam 1 byte.
+ */
+static void appendKeys(string &out, const vector<int> &keys, int n) {
+  for (int i = 0; i < n; ++i) {
+    if (i == 0) {
+      appendVarint(out, zigzagEncode(keys[0]));
+    } else {
+      appendVarint(out, static_cast<unsigned long long>(
+                            static_cast<long long>(keys[i]) - keys[i - 1]));
+    }
+  }
+}
+
+string encodeLeafEntries(const vector<int> &keys,
+                         const vector<long long> &dataPointers, int n,
+                         LeafEncoding encoding) {
+  string out;
+  if (n <= 0)
+    return out;
+  appendKeys(out, keys, n);
+
+  if (encoding == LeafEncoding::DELTA_VARINT) {
+    // Ponteiros não são ordenados dentro da folha: delta com sinal em zigzag.
+    long long previous = 0;
+    for (int i = 0; i < n; ++i) {
+      appendVarint(out, zigzagEncode(dataPointers[i] - previous));
+      previous = dataPointers[i];
+    }
+  } else {
+    // Frame of reference: mínimo em varint, largura b em um byte e os valores
+    // (ponteiro - mínimo) empacotados em b bits cada.
+    long long minPtr = *min_element(dataPointers.begin(), dataPointers.begin() + n);
+    unsigned long long maxOffset = 0;
+    for (int i = 0; i < n; ++i) {
+      maxOffset = max(maxOffset,
+                      static_cast<unsigned long long>(dataPointers[i] - minPtr));
+    }
+    int width = 0;
+    while (width < 64 && (maxOffset >> width) != 0)
+      width++;
+    if (width > MAX_FRAME_OF_REFERENCE_WIDTH)
+      return string();
+    appendVarint(out, zigzagEncode(minPtr));
+    out.push_back(static_cast<char>(width));
+
+    // Com largura <= 56, o acumulador de 64 bits nunca transborda: no máximo
+    // 7 + 56 bits pendentes.
+    unsigned long long buffer = 0;
+    int bitsInBuffer = 0;
+    for (int i = 0; i < n; ++i) {
+      unsigned long long offset =
+          static_cast<unsigned long long>(dataPointers[i] - minPtr);
+      buffer |= offset << bitsInBuffer;
+      bitsInBuffer += width;
+      while (bitsInBuffer >= 8) {
+        out.push_back(static_cast<char>(buffer & 0xFF));
+        buffer >>= 8;
+        bitsInBuffer -= 8;
+      }
+    }
+    if (bitsInBuffer > 0)
+      out.push_back(static_cast<char>(buffer & 0xFF));
+  }
+  return out;
+}
+
+bool decodeLeafEntries(const string &bytes, int n, LeafEncoding encoding,
+                       vector<int> &keys, vector<long long> &dataPointers) {
+  keys.resize(n);
+  dataPointers.resize(n);
+  size_t pos = 0;
+  unsigned long long value;
+  long long current = 0;
+  for (int i = 0; i < n; ++i) {
+    if (!readVarint(bytes, pos, value))
+      return false;
+    current = (i == 0) ? zigzagDecode(value)
+                       : current + static_cast<long long>(value);
+    keys[i] = static_cast<int>(current);
+  }
+
+  if (encoding == LeafEncoding::DELTA_VARINT) {
+    current = 0;
+    for (int i = 0; i < n; ++i) {
+      if (!readVarint(bytes, pos, value))
+        return false;
+      current += zigzagDecode(value);
+      dataPointers[i] = current;
+    }
+    return true;
+  }
+
+  if (n == 0)
+    return true;
+  if (!readVarint(bytes, pos, value) || pos >= bytes.size())
+    return false;
+  long long minPtr = zigzagDecode(value);
+  int width = static_cast<unsigned char>(bytes[pos++]);
+  size_t packedBytes = (static_cast<size_t>(n) * width + 7) / 8;
+  if (width > MAX_FRAME_OF_REFERENCE_WIDTH || pos + packedBytes > bytes.size())
+    return false;
+  // Cada valor é lido de uma janela de 64 bits a partir do byte onde começa;
+  // com largura <= 56 e deslocamento < 8 a janela sempre o contém inteiro.
+  const unsigned char *packed =
+      reinterpret_cast<const unsigned char *>(bytes.data()) + pos;
+  unsigned long long mask = (1ULL << width) - 1;
+  size_t bitPos = 0;
+  for (int i = 0; i < n; ++i, bitPos += width) {
+    size_t byteIdx = bitPos >> 3;
+    unsigned long long window = 0;
+    for (size_t b = 0; b < 8 && byteIdx + b < packedBytes; ++b)
+      window |= static_cast<unsigned long long>(packed[byteIdx + b]) << (8 * b);
+    unsigned long long offset = (window >> (bitPos & 7)) & mask;
+    dataPointers[i] = minPtr + static_cast<long long>(offset);
+  }
+  return true;
+}
+
+LeafEncoding chooseLeafEncoding(const vector<int> &keys,
+                                const vector<long long> &dataPointers, int n,
+                                string &encodedOut) {
+  string delta = encodeLeafEntries(keys, dataPointers, n, LeafEncoding::DELTA_VARINT);
+  string frame = encodeLeafEntries(keys, dataPointers, n,
+                                   LeafEncoding::FRAME_OF_REFERENCE);
+  if (!frame.empty() && frame.size() < delta.size()) {
+    encodedOut = frame;
+    return LeafEncoding::FRAME_OF_REFERENCE;
+  }
+  encodedOut = delta;
+  return LeafEncoding::DELTA_VARINT;
+}
+
+static const char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+string toBase64(const string &bytes) {
+  string out;
+  out.reserve((bytes.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 2 < bytes.size(); i += 3) {
+    unsigned int chunk = (static_cast<unsigned char>(bytes[i]) << 16) |
+                         (static_cast<unsigned char>(bytes[i + 1]) << 8) |
+                         static_cast<unsigned char>(bytes[i + 2]);
+    out.push_back(BASE64_CHARS[(chunk >> 18) & 63]);
+    out.push_back(BASE64_CHARS[(chunk >> 12) & 63]);
+    out.push_back(BASE64_CHARS[(chunk >> 6) & 63]);
+    out.push_back(BASE64_CHARS[chunk & 63]);
+  }
+  size_t rest = bytes.size() - i;
+  if (rest > 0) {
+    unsigned int chunk = static_cast<unsigned char>(bytes[i]) << 16;
+    if (rest == 2)
+      chunk |= static_cast<unsigned char>(bytes[i + 1]) << 8;
+    out.push_back(BASE64_CHARS[(chunk >> 18) & 63]);
+    out.push_back(BASE64_CHARS[(chunk >> 12) & 63]);
+    out.push_back(rest == 2 ? BASE64_CHARS[(chunk >> 6) & 63] : '=');
+    out.push_back('=');
+  }
+  return out;
+}
+
+bool fromBase64(const string &text, string &bytesOut) {
+  // Inicializada uma única vez e de forma segura entre threads: os shards do
+  // BUILD são construídos em paralelo, cada um com a sua árvore
+  static const array<int, 256> table = [] {
+    array<int, 256> t;
+    t.fill(-1);
+    for (int c = 0; c < 64; ++c)
+      t[static_cast<unsigned char>(BASE64_CHARS[c])] = c;
+    return t;
+  }();
+  if (text.size() % 4 != 0)
+    return false;
+  bytesOut.clear();
+  bytesOut.reserve(text.size() / 4 * 3);
+  for (size_t i = 0; i < text.size(); i += 4) {
+    unsigned int chunk = 0;
+    int padding = 0;
+    for (int j = 0; j < 4; ++j) {
+      char c = text[i + j];
+      int v = 0;
+      if (c == '=') {
+        padding++;
+      } else if ((v = table[static_cast<unsigned char>(c)]) < 0) {
+        return false;
+      }
+      chunk = (chunk << 6) | v;
+    }
+    bytesOut.push_back(static_cast<char>((chunk >> 16) & 0xFF));
+    if (padding < 2)
+      bytesOut.push_back(static_cast<char>((chunk >> 8) & 0xFF));
+    if (padding < 1)
+      bytesOut.push_back(static_cast<char>(chunk & 0xFF));
+  }
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef LEAF_ENCODING_H
+#define LEAF_ENCODING_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Codificação de uma folha no arquivo de índice. O caractere é a etiqueta
+// (tag) gravada no início da linha do nó, então cada página diz como foi
+// codificada e folhas de formatos diferentes convivem no mesmo índice.
+enum class LeafEncoding : char {
+    PLAIN = 'L',              // Chaves e ponteiros em texto, como sempre foi
+    DELTA_VARINT = 'D',       // Chaves em delta + varint; ponteiros em delta zigzag + varint
+    FRAME_OF_REFERENCE = 'F'  // Chaves em delta + varint; ponteiros como (ponteiro - mínimo) em b bits
+};
+
+// Maior crescimento possível, em bytes, do conteúdo em DELTA_VARINT ao inserir
+// uma entrada: até 5 bytes para o delta da chave e 10 + 10 para os deltas
+// zigzag de ponteiros de 64 bits (o da nova entrada e o do vizinho seguinte).
+// É a folga que o carregamento em massa deixa em cada folha; a inserção mede a
+// folha já codificada com a entrada (ver BPlusTree::isLeafFull).
+const int MAX_ENCODED_ENTRY_GROWTH = 25;
+
+// Maior largura, em bits, dos deslocamentos em FRAME_OF_REFERENCE: cada valor
+// é lido de uma janela de 64 bits que começa em até 7 bits antes dele.
+const int MAX_FRAME_OF_REFERENCE_WIDTH = 56;
+
+// Codifica as n entradas ordenadas por chave no formato pedido (DELTA_VARINT ou
+// FRAME_OF_REFERENCE). Retorna os bytes crus do conteúdo, ou uma string vazia
+// se os ponteiros não couberem em FRAME_OF_REFERENCE.
+string encodeLeafEntries(const vector<int> &keys, const vector<long long> &dataPointers, int n,
+                         LeafEncoding encoding);
+
+// Decodifica n entradas. Retorna false se os bytes estiverem truncados.
+bool decodeLeafEntries(const string &bytes, int n, LeafEncoding encoding,
+                       vector<int> &keys, vector<long long> &dataPointers);
+
+// Escolhe, entre DELTA_VARINT e FRAME_OF_REFERENCE, a codificação mais curta
+// para as entradas, devolvendo também os bytes codificados.
+LeafEncoding chooseLeafEncoding(const vector<int> &keys, const vector<long long> &dataPointers, int n,
+                                string &encodedOut);
+
+// Tamanho em bytes de uma varint (após zigzag, se o valor for com sinal).
+int varintSize(unsigned long long value);
+int zigzagVarintSize(long long value);
+
+// Base64 sem quebras de linha, para guardar o conteúdo binário numa linha do índice.
+string toBase64(const string &bytes);
+bool fromBase64(const string &text, string &bytesOut);
+
+#endif // LEAF_ENCODING_H
@@ -0,0 +1,105 @@
+#include "learned_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+LearnedIndex::LearnedIndex(int maxError)
+    : maxError(max(1, maxError)), built(false) {}
+
+/**
+ * Ajusta os segmentos com o algoritmo do cone (FITing-tree): cada segmento
+ * começa na primeira entrada de uma chave e mantém o intervalo [lo, hi] de
+ * inclinações que ainda preveem todas as chaves já vistas com erro de até
+ * maxError posições. Quando a próxima chave sai do cone, o segmento é fechado
+ * com a inclinação do meio do cone e outro começa nela. Só a primeira entrada
+ * de cada chave entra no modelo; as repetidas são lidas em sequência.
+ */
+void LearnedIndex::build(const vector<pair<int, RecordPointer>> &sortedEntries) {
+  keys.clear();
+  rows.clear();
+  segments.clear();
+  insertedKeys.clear();
+  keys.reserve(sortedEntries.size());
+  rows.reserve(sortedEntries.size());
+  for (const auto &entry : sortedEntries) {
+    keys.push_back(entry.first);
+    rows.push_back(entry.second);
+  }
+
+  const double infinity = numeric_limits<double>::infinity();
+  Segment current = {0, 0.0, 0};
+  double lo = 0.0, hi = infinity;
+  for (size_t pos = 0; pos < keys.size(); ++pos) {
+    if (pos > 0 && keys[pos] == keys[pos - 1])
+      continue;
+    if (pos > 0) {
+      double dx = static_cast<double>(keys[pos]) - current.firstKey;
+      double dy = static_cast<double>(static_cast<long long>(pos) -
+                                      current.firstPos);
+      double slope = dy / dx;
+      if (slope >= lo && slope <= hi) {
+        hi = min(hi, (dy + maxError) / dx);
+        lo = max(lo, (dy - maxError) / dx);
+        continue;
+      }
+      current.slope = hi == infinity ? 0.0 : (lo + hi) / 2.0;
+      segments.push_back(current);
+    }
+    current = {keys[pos], 0.0, static_cast<long long>(pos)};
+    lo = 0.0;
+    hi = infinity;
+  }
+  if (!keys.empty()) {
+    current.slope = hi == infinity ? 0.0 : (lo + hi) / 2.0;
+    segments.push_back(current);
+  }
+  built = true;
+}
+
+/**
+ * Posição prevista da primeira entrada da chave, limitada ao vetor. O
+ * segmento é o último com firstKey <= key.
+ */
+long long LearnedIndex::predictPosition(int key) const {
+  auto it = upper_bound(
+      segments.begin(), segments.end(), key,
+      [](int k, const Segment &segment) { return k < segment.firstKey; });
+  if (it == segments.begin())
+    return -1;
+  const Segment &segment = *(it - 1);
+  double predicted =
+      segment.firstPos +
+      segment.slope * (static_cast<double>(key) - segment.firstKey);
+  long long last = static_cast<long long>(keys.size()) - 1;
+  return min(last, max(0LL, static_cast<long long>(floor(predicted))));
+}
+
+/**
+ * Busca binária só na janela de erro em volta da posição prevista (uma posição
+ * a mais de cada lado cobre o arredondamento) e leitura sequencial das
+ * entradas repetidas da chave.
+ */
+vector<RecordPointer> LearnedIndex::search(int key) const {
+  vector<RecordPointer> result;
+  long long predicted = predictPosition(key);
+  if (predicted < 0)
+    return result;
+  long long size = static_cast<long long>(keys.size());
+  long long first = max(0LL, predicted - maxError - 1);
+  long long last = min(size, predicted + maxError + 2);
+  size_t pos =
+      lower_bound(keys.begin() + first, keys.begin() + last, key) -
+      keys.begin();
+  while (pos < keys.size() && keys[pos] == key) {
+    result.push_back(rows[pos++]);
+  }
+  return result;
+}
+
+size_t LearnedIndex::memoryBytes() const {
+  return keys.capacity() * sizeof(int) +
+         rows.capacity() * sizeof(RecordPointer) +
+         segments.capacity() * sizeof(Segment);
+}
@@ -0,0 +1,54 @@
+#ifndef LEARNED_INDEX_H
+#define LEARNED_INDEX_H
+
+#include "bplustree.h"
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+// Índice aprendido só de leitura sobre as entradas ordenadas de uma carga em
+// bloco. As chaves e os ponteiros ficam em dois vetores contíguos, na ordem
+// das chaves; um modelo linear por partes prevê, a partir da chave, a posição
+// da sua primeira entrada com erro de no máximo maxError posições, e uma
+// busca binária na janela [prevista - maxError, prevista + maxError] corrige
+// a previsão. Chaves inseridas depois da construção não estão nos vetores: o
+// chamador as marca com markInserted e as busca na BPlusTree.
+class LearnedIndex {
+public:
+    explicit LearnedIndex(int maxError = 16);
+
+    // Ajusta o modelo sobre as entradas, ordenadas por (chave, ponteiro).
+    void build(const vector<pair<int, RecordPointer>> &sortedEntries);
+    // Chave inserida depois de build: as buscas passam a ir para a árvore
+    void markInserted(int key) { insertedKeys.insert(key); }
+    // false se o índice não foi construído ou a chave foi inserida depois
+    bool covers(int key) const { return built && insertedKeys.count(key) == 0; }
+
+    vector<RecordPointer> search(int key) const; // Mesmo resultado de BPlusTree::search
+
+    size_t entryCount() const { return keys.size(); }
+    size_t segmentCount() const { return segments.size(); }
+    int getMaxError() const { return maxError; }
+    size_t memoryBytes() const; // Vetores de entradas e segmentos
+
+private:
+    // Reta que cobre as chaves de firstKey até a primeira chave do próximo
+    // segmento: posição prevista = firstPos + slope * (chave - firstKey).
+    struct Segment {
+        int firstKey;
+        double slope;
+        long long firstPos;
+    };
+
+    int maxError;
+    bool built;
+    vector<int> keys;           // Chaves ordenadas
+    vector<RecordPointer> rows; // Ponteiro de cada chave, na mesma posição
+    vector<Segment> segments;   // Ordenados por firstKey
+    unordered_set<int> insertedKeys;
+
+    long long predictPosition(int key) const; // -1 se a chave for menor que todas
+};
+
+#endif // LEARNED_INDEX_H
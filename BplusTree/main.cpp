@@ -1,7 +1,17 @@
 #include "bplustree.h"
+#include "command_parser.h"
+#include "learned_index.h"
+#include "memtree.h"
+#include "parallel_build.h"
+#include "query_server.h"
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -20,12 +30,12 @@ vector<string> parseCSVLine(const string &line) {
 
 // função para encontrar números de linha em vinhos.csv para um dado
 // ano_colheita
-vector<int> findRecordLineNumbers(const string &csvFilePath,
-                                       int ano_colheita_to_find) {
-  vector<int> lineNumbers;
+vector<RecordPointer> findRecordLineNumbers(const string &csvFilePath,
+                                            int ano_colheita_to_find) {
+  vector<RecordPointer> lineNumbers;
   ifstream csvFile(csvFilePath);
   string line;
-  int currentLineNumber = 0;
+  RecordPointer currentLineNumber = 0;
 
   if (!csvFile.is_open()) {
     cerr << "Erro: Não foi possível abrir o arquivo de dados: "
@@ -58,26 +68,133 @@ vector<int> findRecordLineNumbers(const string &csvFilePath,
   return lineNumbers;
 }
 
+// imprime o resultado de BUS= no formato de saída esperado
+void printSearchResult(int key, const vector<RecordPointer> &results) {
+  cout << formatSearchResult(key, results) << '\n';
+}
+
+// modo --memory: a árvore vive em memória, é carregada do snapshot com uma
+// leitura sequencial (se existir) e gravada de volta ao final. Atende INC e
+// BUS=; os demais comandos dependem do índice em disco.
+int runInMemory(const string &inputText, const vector<Command> &commands,
+                int order, const string &snapshotPath,
+                const string &dataFileName, bool quiet) {
+  MemBPlusTree memTree(order);
+  if (filesystem::exists(snapshotPath)) {
+    if (!memTree.loadSnapshot(snapshotPath)) {
+      return 1;
+    }
+    if (memTree.getOrder() != order) {
+      cerr << "Aviso: snapshot gravado com ordem " << memTree.getOrder()
+           << "; a ordem " << order << " da entrada foi ignorada." << endl;
+    }
+  }
+
+  auto insertKey = [&](int key) {
+    for (RecordPointer recLine : findRecordLineNumbers(dataFileName, key)) {
+      memTree.insert(key, recLine);
+    }
+  };
+  for (const Command &command : commands) {
+    if (command.type == CommandType::INSERT) {
+      insertKey(command.key);
+    } else if (command.type == CommandType::SEARCH) {
+      printSearchResult(command.key, memTree.search(command.key));
+    } else {
+      string line(commandLine(inputText, command));
+      size_t colonPos = line.find(':');
+      string commandType = line.substr(0, colonPos);
+      if (colonPos == string::npos) {
+        cerr << "Aviso: Comando malformado (sem dois pontos): " << line
+             << endl;
+      } else if (commandType == "INC" || commandType == "BUS=") {
+        // argumento recusado pelo parser: passa por stoi como no modo em
+        // disco, com a mesma mensagem de erro
+        try {
+          int key = stoi(line.substr(colonPos + 1));
+          if (commandType == "INC") {
+            insertKey(key);
+          } else {
+            printSearchResult(key, memTree.search(key));
+          }
+        } catch (const exception &e) {
+          cerr << "Erro ao analisar comando " << commandType << ": " << line
+               << " - " << e.what() << endl;
+        }
+      } else {
+        cerr << "Aviso: Comando não suportado no modo em memória: " << line
+             << endl;
+      }
+    }
+  }
+
+  if (!quiet) {
+    memTree.printTreeForDebug();
+  }
+  return memTree.saveSnapshot(snapshotPath) ? 0 : 1;
+}
+
 int main(int argc, char *argv[]) {
+  // Resultados saem por um buffer de 1 MB; os comandos escrevem '\n' em vez de
+  // endl, e a saída só é descarregada quando o buffer enche ou no fim.
+  setvbuf(stdout, nullptr, _IOFBF, 1 << 20);
   if (argc < 2) {
-    cerr << "Uso: " << argv[0] << " <caminho_do_arquivo_de_entrada>"
-              << endl;
+    cerr << "Uso: " << argv[0]
+         << " <caminho_do_arquivo_de_entrada> [--compress-leaves]"
+            " [--memory <snapshot>] [--learned] [--stats-json <arquivo|->]"
+            " [--serve <socket|->] [--quiet]"
+         << endl;
     return 1;
   }
 
   string inputFilePath = argv[1];
-  ifstream inputFile(inputFilePath);
-  string line;
-
-  if (!inputFile.is_open()) {
+  bool compressLeaves = false; // folhas com delta + varint (índice novo)
+  string snapshotPath;         // não vazio = árvore em memória (--memory)
+  bool useLearnedIndex = false; // BUILD também ajusta o índice aprendido
+  string statsJsonPath;         // não vazio = contadores em JSON ao final
+  string servePath; // não vazio = modo servidor após a entrada (--serve)
+  bool quiet = false; // --quiet: não imprime a árvore ao final
+  for (int i = 2; i < argc; ++i) {
+    string option = argv[i];
+    if (option == "--compress-leaves") {
+      compressLeaves = true;
+    } else if (option == "--memory" && i + 1 < argc) {
+      snapshotPath = argv[++i];
+    } else if (option == "--learned") {
+      useLearnedIndex = true;
+    } else if (option == "--stats-json" && i + 1 < argc) {
+      statsJsonPath = argv[++i];
+    } else if (option == "--serve" && i + 1 < argc) {
+      servePath = argv[++i];
+    } else if (option == "--quiet") {
+      quiet = true;
+    } else {
+      cerr << "Aviso: Opção desconhecida: " << option << endl;
+    }
+  }
+  if (servePath == "-") {
+    // O servidor em stdin só descarrega as respostas quando cin não tem mais
+    // entrada disponível (in_avail()), o que exige o buffer próprio do cin,
+    // sem a sincronização com stdio; e sem o tie, ler não descarrega cout.
+    // Antes de qualquer E/S, como pede sync_with_stdio.
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+  }
+  // a entrada é lida de uma vez e analisada no próprio buffer
+  string inputText;
+  if (!readWholeFile(inputFilePath, inputText)) {
     cerr << "Erro: Não foi possível abrir o arquivo de entrada: "
               << inputFilePath << endl;
     return 1;
   }
 
   int order = 0;
-  // lê a primeira linha para obter a ordem da árvore
-  if (getline(inputFile, line)) {
+  int pageSize = 0;
+  // lê a primeira linha para obter a ordem da árvore: FLH/<ordem> fixa a
+  // ordem explicitamente; PAG/<bytes> deriva a ordem do tamanho de página
+  size_t commandsStart = 0;
+  string line(firstLine(inputText, commandsStart));
+  if (!inputText.empty()) {
     if (line.rfind("FLH/", 0) == 0) { // verifica se a linha começa com "FLH/"
       try {
         order = stoi(line.substr(4)); // pega o número após "FLH/"
@@ -86,9 +203,24 @@ int main(int argc, char *argv[]) {
                   << line << endl;
         return 1;
       }
+    } else if (line.rfind("PAG/", 0) == 0) {
+      try {
+        pageSize = stoi(line.substr(4)); // pega o número após "PAG/"
+      } catch (const exception &e) {
+        cerr << "Erro: Tamanho de página inválido na primeira linha: "
+                  << line << endl;
+        return 1;
+      }
+      if (!BPlusTree::isValidPageSize(pageSize)) {
+        cerr << "Erro: O tamanho de página deve ser potência de 2 entre 512 "
+                "e 65536 bytes (ex.: 4096, 8192, 16384). Recebido: "
+             << pageSize << endl;
+        return 1;
+      }
+      order = BPlusTree::orderForPageSize(pageSize);
     } else {
-      cerr << "Erro: A primeira linha deve estar no formato FLH/<ordem>. "
-                   "Recebido: "
+      cerr << "Erro: A primeira linha deve estar no formato FLH/<ordem> ou "
+                   "PAG/<bytes>. Recebido: "
                 << line << endl;
       return 1;
     }
@@ -134,11 +266,121 @@ int main(int argc, char *argv[]) {
   }
   checkDataFile.close();
 
-  BPlusTree bTree(order, indexFileName, dataFileName);
+  vector<Command> commands = parseCommands(inputText, commandsStart);
+  if (!snapshotPath.empty()) {
+    return runInMemory(inputText, commands, order, snapshotPath, dataFileName,
+                       quiet);
+  }
+
+  // em modo PAG/ a ordem é derivada pela própria árvore e gravada no
+  // superbloco; um índice existente é reaberto com a ordem gravada
+  unique_ptr<BPlusTree> treePtr;
+  try {
+    treePtr = make_unique<BPlusTree>(pageSize > 0 ? 0 : order, indexFileName,
+                                     dataFileName, pageSize, compressLeaves);
+  } catch (const exception &e) {
+    cerr << "Erro ao abrir o índice " << indexFileName << ": " << e.what()
+         << endl;
+    return 1;
+  }
+  BPlusTree &bTree = *treePtr;
+  map<int, TreeSnapshot> snapshots; // SNAP: numera os snapshots a partir de 1
+  int nextSnapshotNumber = 1;
+
+  // índice particionado criado por BUILD com mais de um shard; enquanto
+  // existir, INC, BUS= e COUNT são roteados para o shard da chave
+  unique_ptr<ShardedIndex> shardedIndex = make_unique<ShardedIndex>();
+  if (!shardedIndex->open(indexFileName, dataFileName)) {
+    shardedIndex.reset();
+  }
+
+  // índice aprendido (--learned) sobre as entradas do último BUILD sem
+  // shards; chaves inseridas depois dele são buscadas na árvore
+  LearnedIndex learnedIndex;
+
+  // comandos frequentes; chamados com as chaves já convertidas pelo parser
+  // ou, para argumentos fora do formato simples, pela análise de texto abaixo
+  auto insertKey = [&](int key) {
+    // encontra todos os registros com este ano_colheita para obter seus
+    // números de linha
+    vector<RecordPointer> recordLines = findRecordLineNumbers(dataFileName, key);
+    if (recordLines.empty()) {
+      // cout << "  nenhum registro encontrado em " << dataFileName <<
+      // " para ano_colheita = " << key << endl;
+      return;
+    }
+    learnedIndex.markInserted(key);
+    for (RecordPointer recLine : recordLines) {
+      if (shardedIndex) {
+        shardedIndex->insert(key, recLine);
+      } else {
+        bTree.insert(key, recLine);
+      }
+    }
+  };
+  auto searchKey = [&](int key) {
+    printSearchResult(key, shardedIndex ? shardedIndex->search(key)
+                           : learnedIndex.covers(key)
+                               ? learnedIndex.search(key)
+                               : bTree.search(key));
+  };
+  auto printCountEqual = [&](int key) {
+    cout << "CONTAGEM: " << key << " = "
+         << (shardedIndex ? shardedIndex->countRange(key, key)
+                          : bTree.countRange(key, key))
+         << '\n';
+  };
+  auto printCountRange = [&](int low, int high) {
+    cout << "CONTAGEM: [" << low << "," << high << "] = "
+         << (shardedIndex ? shardedIndex->countRange(low, high)
+                          : bTree.countRange(low, high))
+         << '\n';
+  };
 
   // processa os comandos restantes do arquivo de entrada
-  while (getline(inputFile, line)) {
-    if (line.empty() || line[0] == '#') { // ignora linhas vazias ou comentários
+  for (const Command &command : commands) {
+    switch (command.type) {
+    case CommandType::INSERT:
+      insertKey(command.key);
+      continue;
+    case CommandType::SEARCH:
+      searchKey(command.key);
+      continue;
+    case CommandType::COUNT_EQUAL:
+      printCountEqual(command.key);
+      continue;
+    case CommandType::COUNT_RANGE:
+      printCountRange(command.key, command.highKey);
+      continue;
+    case CommandType::RANK:
+      if (!shardedIndex) {
+        // rank = quantidade de entradas com chave menor que a pedida
+        cout << "RANK: " << command.key << " = " << bTree.countLess(command.key)
+             << '\n';
+        continue;
+      }
+      break; // o caminho de texto recusa o comando com o índice particionado
+    case CommandType::OTHER:
+      break;
+    }
+    line.assign(commandLine(inputText, command));
+
+    // COUNT[<min>,<max>]: número de entradas com chave no intervalo fechado
+    if (line.rfind("COUNT[", 0) == 0) {
+      try {
+        size_t comma_pos = line.find(',');
+        size_t close_pos = line.find(']');
+        if (comma_pos == string::npos || close_pos == string::npos ||
+            close_pos < comma_pos) {
+          throw invalid_argument("intervalo malformado");
+        }
+        int low = stoi(line.substr(6, comma_pos - 6));
+        int high = stoi(line.substr(comma_pos + 1, close_pos - comma_pos - 1));
+        printCountRange(low, high);
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando COUNT[]: " << line << " - "
+             << e.what() << endl;
+      }
       continue;
     }
 
@@ -156,42 +398,225 @@ int main(int argc, char *argv[]) {
       continue;
     }
 
+    if (shardedIndex && command_type != "INC" && command_type != "BUS=" &&
+        command_type != "COUNT=" && command_type != "BUILD") {
+      cerr << "Aviso: Comando não suportado com o índice particionado: "
+           << line << endl;
+      continue;
+    }
+
     if (command_type == "INC") {
       try {
-        int key = stoi(command_value_str);
-        // encontra todos os registros com este ano_colheita para obter seus
-        // números de linha
-        vector<int> recordLines = findRecordLineNumbers(dataFileName, key);
-        if (recordLines.empty()) {
-          // cout << "  nenhum registro encontrado em " << dataFileName <<
-          // " para ano_colheita = " << key << endl;
-        } else {
-          for (int recLine : recordLines) {
-            bTree.insert(key, recLine);
-          }
-        }
+        insertKey(stoi(command_value_str));
       } catch (const exception &e) {
         cerr << "Erro ao analisar comando INC: " << line << " - "
                   << e.what() << endl;
       }
     } else if (command_type == "BUS=") {
+      try {
+        searchKey(stoi(command_value_str));
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando BUS=: " << line << " - "
+                  << e.what() << endl;
+      }
+    } else if (command_type == "COUNT=") {
+      try {
+        printCountEqual(stoi(command_value_str));
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando COUNT=: " << line << " - "
+             << e.what() << endl;
+      }
+    } else if (command_type == "RANK") {
       try {
         int key = stoi(command_value_str);
-        vector<int> results = bTree.search(key);
-        if (results.empty()) {
-          cout << "CHAVE NAO ENCONTRADA: " << key << endl;
+        // rank = quantidade de entradas com chave menor que a pedida
+        cout << "RANK: " << key << " = " << bTree.countLess(key) << '\n';
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando RANK: " << line << " - "
+             << e.what() << endl;
+      }
+    } else if (command_type == "NTH") {
+      try {
+        // NTH:<n> (base 1) ou NTH:<p>% (percentil, ex.: NTH:50% = mediana)
+        long long n;
+        if (!command_value_str.empty() && command_value_str.back() == '%') {
+          double percent = stod(command_value_str);
+          n = max(1LL, static_cast<long long>(ceil(
+                           percent / 100.0 *
+                           static_cast<double>(bTree.totalEntries()))));
+        } else {
+          n = stoll(command_value_str);
+        }
+        int key;
+        if (bTree.nthKey(n, key)) {
+          cout << "NTH: " << command_value_str << " = " << key << '\n';
+        } else {
+          cout << "NTH: " << command_value_str << " FORA DO INTERVALO (TOTAL: "
+               << bTree.totalEntries() << ")" << '\n';
+        }
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando NTH: " << line << " - "
+             << e.what() << endl;
+      }
+    } else if (command_type == "REORG") {
+      try {
+        // REORG:<ocupação %> (vazio = 100%): reescreve o índice com as folhas
+        // contíguas em ordem de chave e mostra a fragmentação antes e depois
+        double fillPercent =
+            command_value_str.empty() ? 100.0 : stod(command_value_str);
+        LayoutStats before = bTree.computeLayoutStats();
+        bTree.reorganize(fillPercent / 100.0);
+        LayoutStats after = bTree.computeLayoutStats();
+        auto printStats = [](const char *label, const LayoutStats &st) {
+          cout << "  " << label << ": altura " << st.height << ", folhas "
+               << st.leafCount << ", entradas " << st.entries
+               << ", saltos sequenciais " << st.sequentialHops << "/"
+               << st.hops() << ", fragmentacao "
+               << st.fragmentation() * 100.0 << "%, distancia media "
+               << st.avgHopDistance() << ", ocupacao media "
+               << st.avgLeafFill * 100.0 << "%" << '\n';
+        };
+        cout << "REORG (ocupacao alvo " << fillPercent << "%):" << '\n';
+        printStats("antes", before);
+        printStats("depois", after);
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando REORG: " << line << " - "
+             << e.what() << endl;
+      }
+    } else if (command_type == "BUILD") {
+      try {
+        // BUILD:<threads>[,<shards>]: indexa o vinhos.csv inteiro, lendo e
+        // ordenando blocos em paralelo; com mais de um shard, grava árvores
+        // separadas por faixa de chave e um arquivo de roteamento
+        size_t comma_pos = command_value_str.find(',');
+        int threads = stoi(command_value_str.substr(0, comma_pos));
+        int numShards = comma_pos == string::npos
+                            ? 1
+                            : stoi(command_value_str.substr(comma_pos + 1));
+        vector<pair<int, RecordPointer>> entries =
+            mergeSortedRuns(extractSortedRuns(dataFileName, threads));
+        shardedIndex.reset();
+        ShardedIndex::remove(indexFileName);
+        learnedIndex = LearnedIndex();
+        if (numShards <= 1) {
+          if (bTree.bulkLoad(entries)) {
+            cout << "BUILD: " << entries.size() << " ENTRADAS, " << threads
+                 << " THREAD(S)" << '\n';
+            if (useLearnedIndex) {
+              learnedIndex.build(entries);
+              cout << "MODELO: " << learnedIndex.segmentCount()
+                   << " SEGMENTO(S), ERRO MAXIMO "
+                   << learnedIndex.getMaxError() << '\n';
+            }
+          }
         } else {
-          cout << "CHAVE ENCONTRADA: " << key << " LINHAS: ";
-          sort(results.begin(),
-                    results.end()); // ordena para saída consistente
-          for (size_t i = 0; i < results.size(); ++i) {
-            cout << results[i] << (i == results.size() - 1 ? "" : ",");
+          int built = ShardedIndex::build(
+              entries, numShards, indexFileName, dataFileName,
+              bTree.getPageSize() > 0 ? 0 : bTree.getOrder(),
+              bTree.getPageSize(), bTree.leavesCompressed());
+          shardedIndex = make_unique<ShardedIndex>();
+          if (built == 0 || !shardedIndex->open(indexFileName, dataFileName)) {
+            shardedIndex.reset();
+          } else {
+            cout << "BUILD: " << entries.size() << " ENTRADAS, " << threads
+                 << " THREAD(S), " << built << " SHARD(S)" << '\n';
           }
-          cout << endl;
         }
       } catch (const exception &e) {
-        cerr << "Erro ao analisar comando BUS=: " << line << " - "
-                  << e.what() << endl;
+        cerr << "Erro ao analisar comando BUILD: " << line << " - "
+             << e.what() << endl;
+      }
+    } else if (command_type == "SNAP") {
+      // SNAP: fixa a versão atual; as inserções seguintes não a alteram
+      TreeSnapshot snapshot = bTree.pinSnapshot();
+      int number = nextSnapshotNumber++;
+      snapshots[number] = snapshot;
+      cout << "SNAPSHOT: " << number << " (VERSAO " << snapshot.version << ")"
+           << '\n';
+    } else if (command_type == "SCAN") {
+      try {
+        // SCAN:<snapshot>,<min>,<max>: entradas do intervalo na versão fixada
+        stringstream args(command_value_str);
+        string number_str, low_str, high_str;
+        getline(args, number_str, ',');
+        getline(args, low_str, ',');
+        getline(args, high_str, ',');
+        int number = stoi(number_str);
+        int low = stoi(low_str), high = stoi(high_str);
+        auto it = snapshots.find(number);
+        if (it == snapshots.end()) {
+          cerr << "Aviso: snapshot " << number << " não existe." << endl;
+          continue;
+        }
+        vector<pair<int, RecordPointer>> entries =
+            bTree.scanSnapshot(it->second, low, high);
+        cout << "SCAN: " << number << " [" << low << "," << high
+             << "] = " << entries.size() << " ENTRADAS";
+        for (size_t i = 0; i < entries.size(); ++i) {
+          cout << (i == 0 ? ": " : ",") << entries[i].first << "/"
+               << entries[i].second;
+        }
+        cout << '\n';
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando SCAN: " << line << " - "
+             << e.what() << endl;
+      }
+    } else if (command_type == "RELEASE") {
+      try {
+        int number = stoi(command_value_str);
+        auto it = snapshots.find(number);
+        if (it == snapshots.end()) {
+          cerr << "Aviso: snapshot " << number << " não existe." << endl;
+          continue;
+        }
+        bTree.releaseSnapshot(it->second);
+        snapshots.erase(it);
+        cout << "RELEASE: " << number << " (PAGINAS LIVRES: "
+             << bTree.freePageCount() << ")" << '\n';
+      } catch (const exception &e) {
+        cerr << "Erro ao analisar comando RELEASE: " << line << " - "
+             << e.what() << endl;
+      }
+    } else if (command_type == "STATS") {
+      // STATS: contadores de E/S, buffer e splits desde a abertura do índice
+      TreeStats st = bTree.getStats();
+      auto printLatency = [](const char *label, const LatencyHistogram &h) {
+        cout << "  " << label << " (us): amostras " << h.samples << ", media "
+             << h.meanMicros() << ", p50 <= " << h.percentileMicros(0.50)
+             << ", p99 <= " << h.percentileMicros(0.99) << '\n';
+      };
+      cout << "STATS:" << '\n';
+      cout << "  nos lidos " << st.nodeReads << ", nos gravados "
+           << st.nodeWrites << ", bytes lidos " << st.bytesRead
+           << ", bytes gravados " << st.bytesWritten << '\n';
+      cout << "  buffer: " << st.bufferHits << " acertos, " << st.bufferMisses
+           << " faltas" << '\n';
+      cout << "  splits: " << st.leafSplits << " de folha, "
+           << st.internalSplits << " internos, " << st.rootSplits
+           << " de raiz; descidas " << st.descents << ", saltos entre folhas "
+           << st.leafHops << ", altura " << st.height << '\n';
+      printLatency("leitura de no", st.readLatency);
+      printLatency("gravacao de no", st.writeLatency);
+    } else if (command_type == "VERIFY") {
+      // VERIFY: confere a estrutura do índice com uma leitura sequencial
+      VerifyReport report = bTree.verify();
+      if (report.ok()) {
+        cout << "VERIFY: OK";
+      } else {
+        cout << "VERIFY: " << report.errorCount << " ERRO(S)";
+      }
+      cout << " (nos " << report.reachableNodes << "/" << report.nodesRead
+           << ", folhas " << report.leaves << ", entradas " << report.entries
+           << ", altura " << report.height << ", paginas livres "
+           << report.freePages << ", retidas " << report.retainedPages
+           << ", perdidas " << report.leakedPages << ")" << '\n';
+      for (const string &error : report.errors) {
+        cout << "  " << error << '\n';
+      }
+      if (report.errorCount > static_cast<long long>(report.errors.size())) {
+        cout << "  ... e mais "
+             << report.errorCount - static_cast<long long>(report.errors.size())
+             << '\n';
       }
     } else {
       cerr << "Aviso: Tipo de comando desconhecido: " << command_type
@@ -199,7 +624,44 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  inputFile.close();
-  bTree.printTreeForDebug();
-  return 0;
+  for (const auto &pinned : snapshots) {
+    bTree.releaseSnapshot(pinned.second); // snapshots não liberados pela entrada
+  }
+  int exitCode = 0;
+  if (!servePath.empty()) {
+    // --serve: depois dos comandos da entrada, a árvore continua aberta
+    // atendendo clientes; a impressão da árvore é omitida (em "-", stdout é
+    // o canal das respostas)
+    if (shardedIndex) {
+      cerr << "Erro: o modo servidor não atende o índice particionado." << endl;
+      exitCode = 1;
+    } else {
+      QueryServer server(bTree, dataFileName);
+      exitCode = server.run(servePath);
+    }
+  } else {
+    if (shardedIndex) {
+      cout << "Índice particionado em " << shardedIndex->shardCount()
+           << " shards (" << ShardedIndex::routingPath(indexFileName) << ")"
+           << endl;
+    }
+    if (!quiet) {
+      bTree.printTreeForDebug();
+    }
+  }
+  if (!statsJsonPath.empty()) {
+    string json = bTree.getStats().toJson();
+    if (statsJsonPath == "-") {
+      cerr << json << endl;
+    } else {
+      ofstream statsFile(statsJsonPath, ios::trunc);
+      if (statsFile.is_open()) {
+        statsFile << json << "\n";
+      } else {
+        cerr << "Erro: Não foi possível gravar as estatísticas em "
+             << statsJsonPath << endl;
+      }
+    }
+  }
+  return exitCode;
 }
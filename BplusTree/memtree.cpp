@@ -0,0 +1,325 @@
+#include "memtree.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+MemBPlusTree::MemBPlusTree(int order)
+    : treeOrder(order), rootIndex(-1), entryCount(0) {
+  if (order < 3) {
+    throw invalid_argument("ordem da árvore em memória deve ser pelo menos 3");
+  }
+}
+
+/**
+ * Reserva um nó novo no fim das arenas e retorna seu índice. As arenas só
+ * crescem (a árvore não remove chaves), então os índices são estáveis; os
+ * ponteiros obtidos por keysOf/valuesOf, não: valem só até a próxima alocação.
+ */
+int MemBPlusTree::allocateNode(bool isLeaf) {
+  int index = static_cast<int>(nodes.size());
+  nodes.push_back({isLeaf ? 1 : 0, 0, -1, -1});
+  keySlots.resize(keySlots.size() + treeOrder, 0);
+  valueSlots.resize(valueSlots.size() + treeOrder, 0);
+  return index;
+}
+
+size_t MemBPlusTree::memoryBytes() const {
+  return nodes.capacity() * sizeof(MemNode) +
+         keySlots.capacity() * sizeof(int) +
+         valueSlots.capacity() * sizeof(long long);
+}
+
+/**
+ * Desce da raiz até a folha onde a chave deve estar, guardando o caminho.
+ * Usa lower_bound nos nós internos, como a árvore em disco: chaves iguais ao
+ * separador vão para a esquerda, então a busca chega à primeira folha que
+ * pode conter a chave.
+ */
+int MemBPlusTree::findLeaf(int key, vector<int> &path) {
+  int current = rootIndex;
+  while (current != -1) {
+    path.push_back(current);
+    if (nodes[current].isLeaf)
+      return current;
+    int *keys = keysOf(current);
+    int childIdx =
+        lower_bound(keys, keys + nodes[current].numKeys, key) - keys;
+    current = static_cast<int>(valuesOf(current)[childIdx]);
+  }
+  return -1;
+}
+
+/**
+ * Insere um par (chave, ponteiro de dados). Se a folha estiver cheia, divide
+ * a folha e propaga o primeiro valor da nova folha para o pai.
+ */
+void MemBPlusTree::insert(int key, long long dataRecordId) {
+  if (rootIndex == -1) {
+    rootIndex = allocateNode(true);
+  }
+
+  vector<int> path;
+  int leaf = findLeaf(key, path);
+  path.pop_back(); // o caminho guarda só os ancestrais da folha
+  entryCount++;
+
+  int n = nodes[leaf].numKeys;
+  int *keys = keysOf(leaf);
+  long long *values = valuesOf(leaf);
+  int pos = lower_bound(keys, keys + n, key) - keys;
+
+  if (n < treeOrder - 1) {
+    copy_backward(keys + pos, keys + n, keys + n + 1);
+    copy_backward(values + pos, values + n, values + n + 1);
+    keys[pos] = key;
+    values[pos] = dataRecordId;
+    nodes[leaf].numKeys++;
+    return;
+  }
+
+  // folha cheia: junta as treeOrder entradas e divide ao meio
+  vector<int> tempKeys(keys, keys + n);
+  vector<long long> tempValues(values, values + n);
+  tempKeys.insert(tempKeys.begin() + pos, key);
+  tempValues.insert(tempValues.begin() + pos, dataRecordId);
+
+  int newLeaf = allocateNode(true); // invalida keys/values
+  int leftCount = (treeOrder + 1) / 2;
+  int rightCount = treeOrder - leftCount;
+  copy(tempKeys.begin(), tempKeys.begin() + leftCount, keysOf(leaf));
+  copy(tempValues.begin(), tempValues.begin() + leftCount, valuesOf(leaf));
+  copy(tempKeys.begin() + leftCount, tempKeys.end(), keysOf(newLeaf));
+  copy(tempValues.begin() + leftCount, tempValues.end(), valuesOf(newLeaf));
+  nodes[leaf].numKeys = leftCount;
+  nodes[newLeaf].numKeys = rightCount;
+
+  // encadeia a nova folha entre a antiga e a sua sucessora
+  int oldNext = nodes[leaf].nextLeaf;
+  nodes[newLeaf].prevLeaf = leaf;
+  nodes[newLeaf].nextLeaf = oldNext;
+  nodes[leaf].nextLeaf = newLeaf;
+  if (oldNext != -1)
+    nodes[oldNext].prevLeaf = newLeaf;
+
+  insertIntoParent(path, leaf, tempKeys[leftCount], newLeaf);
+}
+
+/**
+ * Insere o separador `key` e o filho direito no pai de `leftIndex` (o último
+ * nó de `path`). A posição vem da posição do filho esquerdo no pai, não de uma
+ * busca pela chave, para não errar com separadores duplicados.
+ */
+void MemBPlusTree::insertIntoParent(vector<int> &path, int leftIndex, int key,
+                                    int rightIndex) {
+  if (path.empty()) {
+    int newRoot = allocateNode(false);
+    keysOf(newRoot)[0] = key;
+    valuesOf(newRoot)[0] = leftIndex;
+    valuesOf(newRoot)[1] = rightIndex;
+    nodes[newRoot].numKeys = 1;
+    rootIndex = newRoot;
+    return;
+  }
+
+  int parent = path.back();
+  path.pop_back();
+  int n = nodes[parent].numKeys;
+  int *keys = keysOf(parent);
+  long long *children = valuesOf(parent);
+  int childPos = find(children, children + n + 1, leftIndex) - children;
+
+  if (n < treeOrder - 1) {
+    copy_backward(keys + childPos, keys + n, keys + n + 1);
+    copy_backward(children + childPos + 1, children + n + 1, children + n + 2);
+    keys[childPos] = key;
+    children[childPos + 1] = rightIndex;
+    nodes[parent].numKeys++;
+    return;
+  }
+
+  // nó interno cheio: treeOrder chaves e treeOrder + 1 filhos temporários
+  vector<int> tempKeys(keys, keys + n);
+  vector<long long> tempChildren(children, children + n + 1);
+  tempKeys.insert(tempKeys.begin() + childPos, key);
+  tempChildren.insert(tempChildren.begin() + childPos + 1, rightIndex);
+
+  int newNode = allocateNode(false); // invalida keys/children
+  int mid = treeOrder / 2;
+  int keyToPushUp = tempKeys[mid];
+  copy(tempKeys.begin(), tempKeys.begin() + mid, keysOf(parent));
+  copy(tempChildren.begin(), tempChildren.begin() + mid + 1, valuesOf(parent));
+  copy(tempKeys.begin() + mid + 1, tempKeys.end(), keysOf(newNode));
+  copy(tempChildren.begin() + mid + 1, tempChildren.end(), valuesOf(newNode));
+  nodes[parent].numKeys = mid;
+  nodes[newNode].numKeys = treeOrder - mid - 1;
+
+  insertIntoParent(path, parent, keyToPushUp, newNode);
+}
+
+/**
+ * Retorna todos os ponteiros de dados da chave, seguindo as folhas seguintes
+ * enquanto a chave se repetir.
+ */
+vector<long long> MemBPlusTree::search(int key) {
+  vector<long long> result;
+  vector<int> path;
+  int leaf = findLeaf(key, path);
+  if (leaf == -1)
+    return result;
+
+  int *keys = keysOf(leaf);
+  int pos = lower_bound(keys, keys + nodes[leaf].numKeys, key) - keys;
+  while (leaf != -1) {
+    keys = keysOf(leaf);
+    long long *values = valuesOf(leaf);
+    int n = nodes[leaf].numKeys;
+    // a chave pode ser igual ao separador e começar só na folha seguinte
+    while (pos < n && keys[pos] == key)
+      result.push_back(values[pos++]);
+    if (pos < n)
+      break;
+    leaf = nodes[leaf].nextLeaf;
+    pos = 0;
+  }
+  return result;
+}
+
+void MemBPlusTree::printTreeForDebug() {
+  cout << "Estrutura da Árvore B+ em memória (Ordem: " << treeOrder
+       << ", Nós: " << nodes.size() << ", Entradas: " << entryCount << ")"
+       << endl;
+  if (rootIndex == -1) {
+    cout << "  Árvore está vazia." << endl;
+    return;
+  }
+  cout << "  Índice do Nó Raiz: " << rootIndex << endl;
+  printNodeRecursive(rootIndex, 0);
+}
+
+void MemBPlusTree::printNodeRecursive(int nodeIndex, int level) {
+  const MemNode &node = nodes[nodeIndex];
+  int *keys = keysOf(nodeIndex);
+  long long *values = valuesOf(nodeIndex);
+
+  cout << string(level * 2, ' ');
+  cout << "[" << (node.isLeaf ? 'L' : 'I') << ":" << nodeIndex << "] Chaves: (";
+  for (int i = 0; i < node.numKeys; ++i) {
+    cout << keys[i] << (i == node.numKeys - 1 ? "" : ",");
+  }
+  cout << ")";
+  if (node.isLeaf) {
+    cout << " PonteirosDados: (";
+    for (int i = 0; i < node.numKeys; ++i) {
+      cout << values[i] << (i == node.numKeys - 1 ? "" : ",");
+    }
+    cout << ") Ant: " << node.prevLeaf << " Prox: " << node.nextLeaf << endl;
+    return;
+  }
+  cout << endl;
+  for (int i = 0; i <= node.numKeys; ++i) {
+    printNodeRecursive(static_cast<int>(values[i]), level + 1);
+  }
+}
+
+// Cabeçalho do snapshot, gravado antes das arenas.
+struct MemSnapshotHeader {
+  uint32_t magic;
+  int32_t version;
+  int32_t order;
+  int32_t rootIndex;
+  int32_t nodeCount;
+  int32_t reserved; // alinha entryCount em 8 bytes
+  int64_t entryCount;
+};
+
+/**
+ * Grava o snapshot: cabeçalho, arena de nós, de chaves e de valores, nessa
+ * ordem, sem conversão. O arquivo só é válido na mesma arquitetura (tamanho de
+ * int e ordem dos bytes) em que foi gravado.
+ */
+bool MemBPlusTree::saveSnapshot(const string &path) const {
+  ofstream out(path, ios::binary | ios::trunc);
+  if (!out.is_open()) {
+    cerr << "Erro: Não foi possível criar o snapshot: " << path << endl;
+    return false;
+  }
+  MemSnapshotHeader header = {SNAPSHOT_MAGIC,
+                              SNAPSHOT_VERSION,
+                              treeOrder,
+                              rootIndex,
+                              static_cast<int32_t>(nodes.size()),
+                              0,
+                              entryCount};
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(nodes.data()),
+            nodes.size() * sizeof(MemNode));
+  out.write(reinterpret_cast<const char *>(keySlots.data()),
+            keySlots.size() * sizeof(int));
+  out.write(reinterpret_cast<const char *>(valueSlots.data()),
+            valueSlots.size() * sizeof(long long));
+  if (!out) {
+    cerr << "Erro: Falha ao gravar o snapshot: " << path << endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Carrega um snapshot gravado por saveSnapshot com uma leitura sequencial do
+ * arquivo inteiro direto para as arenas. A ordem gravada substitui a atual.
+ * Em caso de erro, a árvore fica como estava.
+ */
+bool MemBPlusTree::loadSnapshot(const string &path) {
+  ifstream in(path, ios::binary | ios::ate);
+  if (!in.is_open()) {
+    return false;
+  }
+  streamoff fileSize = in.tellg();
+  in.seekg(0);
+
+  MemSnapshotHeader header;
+  if (fileSize < static_cast<streamoff>(sizeof(header)) ||
+      !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) {
+    cerr << "Erro: Arquivo não é um snapshot válido: " << path << endl;
+    return false;
+  }
+  if (header.order < 3 || header.nodeCount < 0 || header.entryCount < 0 ||
+      header.rootIndex < -1 || header.rootIndex >= header.nodeCount) {
+    cerr << "Erro: Cabeçalho de snapshot inconsistente: " << path << endl;
+    return false;
+  }
+  size_t nodeBytes = static_cast<size_t>(header.nodeCount) * sizeof(MemNode);
+  size_t slotCount = static_cast<size_t>(header.nodeCount) * header.order;
+  if (static_cast<size_t>(fileSize) !=
+      sizeof(header) + nodeBytes +
+          slotCount * (sizeof(int) + sizeof(long long))) {
+    cerr << "Erro: Tamanho do snapshot não confere com o cabeçalho: " << path
+         << endl;
+    return false;
+  }
+
+  vector<MemNode> newNodes(header.nodeCount);
+  vector<int> newKeys(slotCount);
+  vector<long long> newValues(slotCount);
+  in.read(reinterpret_cast<char *>(newNodes.data()), nodeBytes);
+  in.read(reinterpret_cast<char *>(newKeys.data()), slotCount * sizeof(int));
+  in.read(reinterpret_cast<char *>(newValues.data()),
+          slotCount * sizeof(long long));
+  if (!in) {
+    cerr << "Erro: Falha ao ler o snapshot: " << path << endl;
+    return false;
+  }
+
+  treeOrder = header.order;
+  rootIndex = header.rootIndex;
+  entryCount = header.entryCount;
+  nodes.swap(newNodes);
+  keySlots.swap(newKeys);
+  valueSlots.swap(newValues);
+  return true;
+}
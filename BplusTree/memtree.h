@@ -0,0 +1,61 @@
+#ifndef MEMTREE_H
+#define MEMTREE_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Árvore B+ em memória, derivada da versão com ponteiros de old/bplustree.cpp,
+// com a mesma interface da BPlusTree em disco (chave -> números de linha em
+// vinhos.csv). Os nós vivem em arenas contíguas e se referenciam por índice,
+// então não há new/delete por nó e o snapshot em disco é a cópia direta das
+// arenas: salvar e carregar são uma escrita e uma leitura sequenciais.
+class MemBPlusTree {
+public:
+    explicit MemBPlusTree(int order);
+
+    void insert(int key, long long dataRecordId); // dataRecordId é o número real da linha em vinhos.csv
+    vector<long long> search(int key);             // Retorna vetor de dataRecordIds
+    void printTreeForDebug();                // Para depuração da árvore
+
+    int getOrder() const { return treeOrder; }
+    long long totalEntries() const { return entryCount; }
+    size_t memoryBytes() const; // Bytes ocupados pelas arenas
+
+    // Snapshot binário: cabeçalho + arena de nós + arenas de chaves e de valores.
+    bool saveSnapshot(const string &path) const;
+    bool loadSnapshot(const string &path); // Substitui o conteúdo atual; mantém-no se falhar
+
+private:
+    // Nó sem dados próprios: chaves e valores ficam em `keySlots` e
+    // `valueSlots`, a partir de nodeIndex * treeOrder. Em folhas, os valores
+    // são ponteiros de dados (64 bits); em nós internos, índices dos filhos.
+    // -1 representa "nenhum".
+    struct MemNode {
+        int isLeaf;
+        int numKeys;
+        int prevLeaf;
+        int nextLeaf;
+    };
+
+    int treeOrder;
+    int rootIndex;
+    long long entryCount;
+    vector<MemNode> nodes;         // Arena de nós
+    vector<int> keySlots;          // Arena de chaves (treeOrder por nó)
+    vector<long long> valueSlots;  // Arena de valores (treeOrder por nó)
+
+    int *keysOf(int nodeIndex) { return &keySlots[static_cast<size_t>(nodeIndex) * treeOrder]; }
+    long long *valuesOf(int nodeIndex) { return &valueSlots[static_cast<size_t>(nodeIndex) * treeOrder]; }
+    int allocateNode(bool isLeaf);
+
+    int findLeaf(int key, vector<int> &path);
+    void insertIntoParent(vector<int> &path, int leftIndex, int key, int rightIndex);
+    void printNodeRecursive(int nodeIndex, int level);
+
+    static const unsigned int SNAPSHOT_MAGIC = 0x53504D42; // "BMPS"
+    static const int SNAPSHOT_VERSION = 2; // 2: valores de 64 bits em arena própria
+};
+
+#endif // MEMTREE_H
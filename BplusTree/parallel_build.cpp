@@ -0,0 +1,284 @@
+#include "parallel_build.h"
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+// Extrai ano_colheita de uma linha do CSV com as mesmas regras de
+// findRecordLineNumbers em main.cpp: exatamente 4 colunas e a terceira
+// numérica. retorna false se a linha não tiver uma chave válida.
+static bool parseKeyFromLine(const string &line, int &keyOut) {
+  // getline(',') não produz coluna vazia depois de uma vírgula final
+  vector<size_t> commas;
+  for (size_t i = 0; i < line.size(); ++i) {
+    if (line[i] == ',')
+      commas.push_back(i);
+  }
+  size_t columns = line.empty() ? 0 : commas.size() + 1;
+  if (!line.empty() && line.back() == ',')
+    columns--;
+  if (columns != 4)
+    return false;
+  try {
+    keyOut = stoi(line.substr(commas[1] + 1, commas[2] - commas[1] - 1));
+  } catch (const exception &) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Divide o arquivo em faixas de bytes (uma por thread) começando sempre no
+ * início de uma linha. Cada thread lê só a sua faixa, guarda (chave, linha
+ * relativa à faixa) e ordena o resultado; ao final, as linhas relativas são
+ * convertidas em números de linha do arquivo (base 1, com o cabeçalho).
+ */
+vector<vector<pair<int, RecordPointer>>> extractSortedRuns(const string &csvPath,
+                                                 int threads) {
+  threads = max(1, threads);
+  error_code ec;
+  uintmax_t fileSize = filesystem::file_size(csvPath, ec);
+  if (ec) {
+    cerr << "Erro: Não foi possível abrir o arquivo de dados: " << csvPath
+         << endl;
+    return {};
+  }
+
+  // Limites das faixas: o início nominal avança até depois do próximo '\n'.
+  vector<uintmax_t> bounds(threads + 1, fileSize);
+  bounds[0] = 0;
+  ifstream file(csvPath, ios::binary);
+  for (int i = 1; i < threads; ++i) {
+    uintmax_t nominal = fileSize * i / threads;
+    uintmax_t bound = fileSize;
+    if (nominal > 0) {
+      file.clear();
+      file.seekg(nominal - 1);
+      string rest;
+      if (getline(file, rest) && !file.eof()) {
+        bound = nominal + rest.size();
+      }
+    }
+    bounds[i] = max(bounds[i - 1], bound);
+  }
+  file.close();
+
+  vector<vector<pair<int, RecordPointer>>> runs(threads);
+  vector<long long> linesInChunk(threads, 0);
+  vector<thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      ifstream chunk(csvPath, ios::binary);
+      chunk.seekg(bounds[t]);
+      uintmax_t position = bounds[t];
+      string line;
+      long long localLine = 0;
+      while (position < bounds[t + 1] && getline(chunk, line)) {
+        position += line.size() + 1;
+        localLine++;
+        if (t == 0 && localLine == 1)
+          continue; // cabeçalho
+        int key;
+        if (parseKeyFromLine(line, key)) {
+          runs[t].push_back({key, localLine});
+        }
+      }
+      linesInChunk[t] = localLine;
+      sort(runs[t].begin(), runs[t].end());
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+
+  // Desloca as linhas relativas: não altera a ordem dentro de cada run.
+  long long linesBefore = 0;
+  for (int t = 0; t < threads; ++t) {
+    for (auto &entry : runs[t])
+      entry.second += linesBefore;
+    linesBefore += linesInChunk[t];
+  }
+  return runs;
+}
+
+/**
+ * Intercalação de k vias com heap de mínimo sobre a cabeça de cada run.
+ */
+vector<pair<int, RecordPointer>>
+mergeSortedRuns(const vector<vector<pair<int, RecordPointer>>> &runs) {
+  size_t total = 0;
+  for (const auto &run : runs)
+    total += run.size();
+  vector<pair<int, RecordPointer>> merged;
+  merged.reserve(total);
+
+  // (entrada, (run, posição na run))
+  using Head = pair<pair<int, RecordPointer>, pair<size_t, size_t>>;
+  priority_queue<Head, vector<Head>, greater<Head>> heads;
+  for (size_t r = 0; r < runs.size(); ++r) {
+    if (!runs[r].empty())
+      heads.push({runs[r][0], {r, 0}});
+  }
+  while (!heads.empty()) {
+    Head head = heads.top();
+    heads.pop();
+    merged.push_back(head.first);
+    size_t r = head.second.first, next = head.second.second + 1;
+    if (next < runs[r].size())
+      heads.push({runs[r][next], {r, next}});
+  }
+  return merged;
+}
+
+string ShardedIndex::routingPath(const string &indexFileName) {
+  return indexFileName + ".shards";
+}
+
+/**
+ * Corta as entradas em faixas de tamanho parecido, movendo cada corte para a
+ * próxima troca de chave, e grava o roteamento só depois de todas as árvores
+ * terem sido construídas.
+ */
+int ShardedIndex::build(const vector<pair<int, RecordPointer>> &sortedEntries,
+                        int numShards, const string &indexFileName,
+                        const string &dataFileName, int order, int pageSize,
+                        bool compressLeaves) {
+  size_t n = sortedEntries.size();
+  numShards = max(1, numShards);
+  vector<size_t> starts = {0};
+  for (int s = 1; s < numShards; ++s) {
+    size_t cut = n * s / numShards;
+    while (cut > 0 && cut < n &&
+           sortedEntries[cut].first == sortedEntries[cut - 1].first) {
+      cut++;
+    }
+    if (cut < n && cut > starts.back())
+      starts.push_back(cut);
+  }
+  starts.push_back(n);
+  int shards = starts.size() - 1;
+
+  remove(indexFileName);
+  vector<string> files(shards);
+  vector<char> ok(shards, 0);
+  vector<thread> workers;
+  for (int s = 0; s < shards; ++s) {
+    files[s] = indexFileName + ".shard" + to_string(s);
+    workers.emplace_back([&, s]() {
+      vector<pair<int, RecordPointer>> slice(sortedEntries.begin() + starts[s],
+                                   sortedEntries.begin() + starts[s + 1]);
+      try {
+        filesystem::remove(files[s]);
+        BPlusTree tree(order, files[s], dataFileName, pageSize,
+                       compressLeaves);
+        ok[s] = tree.bulkLoad(slice);
+      } catch (const exception &e) {
+        cerr << "Erro ao construir o shard " << files[s] << ": " << e.what()
+             << endl;
+      }
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+  if (find(ok.begin(), ok.end(), 0) != ok.end())
+    return 0;
+
+  ofstream routing(routingPath(indexFileName), ios::trunc);
+  if (!routing.is_open()) {
+    cerr << "Erro: Não foi possível criar o roteamento "
+         << routingPath(indexFileName) << endl;
+    return 0;
+  }
+  routing << "SHARDS:" << shards << "\n";
+  routing << "ORDER:" << order << "\n";
+  routing << "PAGE_SIZE:" << pageSize << "\n";
+  routing << "LEAF_ENCODING:" << (compressLeaves ? "COMPRESSED" : "PLAIN")
+          << "\n";
+  for (int s = 0; s < shards; ++s) {
+    int lowKey = s == 0 ? INT_MIN : sortedEntries[starts[s]].first;
+    routing << "S;" << lowKey << ";" << files[s] << ";\n";
+  }
+  return shards;
+}
+
+void ShardedIndex::remove(const string &indexFileName) {
+  ifstream routing(routingPath(indexFileName));
+  string line;
+  while (getline(routing, line)) {
+    if (line.rfind("S;", 0) == 0) {
+      size_t fileStart = line.find(';', 2) + 1;
+      filesystem::remove(line.substr(fileStart, line.size() - fileStart - 1));
+    }
+  }
+  routing.close();
+  filesystem::remove(routingPath(indexFileName));
+}
+
+/**
+ * Lê o roteamento: cabeçalho "NOME:valor" seguido de uma linha
+ * "S;<menor chave>;<arquivo>;" por shard, em ordem de chave.
+ */
+bool ShardedIndex::open(const string &indexFileName,
+                        const string &dataFileName) {
+  ifstream routing(routingPath(indexFileName));
+  if (!routing.is_open())
+    return false;
+  lowKeys.clear();
+  trees.clear();
+  int order = 0, pageSize = 0;
+  bool compressLeaves = false;
+  string line;
+  try {
+    while (getline(routing, line)) {
+      if (line.rfind("ORDER:", 0) == 0) {
+        order = stoi(line.substr(6));
+      } else if (line.rfind("PAGE_SIZE:", 0) == 0) {
+        pageSize = stoi(line.substr(10));
+      } else if (line.rfind("LEAF_ENCODING:", 0) == 0) {
+        compressLeaves = line.substr(14) == "COMPRESSED";
+      } else if (line.rfind("S;", 0) == 0) {
+        stringstream ss(line.substr(2));
+        string lowKey, file;
+        getline(ss, lowKey, ';');
+        getline(ss, file, ';');
+        lowKeys.push_back(stoi(lowKey));
+        trees.push_back(make_unique<BPlusTree>(order, file, dataFileName,
+                                               pageSize, compressLeaves));
+      }
+    }
+  } catch (const exception &e) {
+    cerr << "Erro ao abrir os shards de " << routingPath(indexFileName)
+         << ": " << e.what() << endl;
+    lowKeys.clear();
+    trees.clear();
+    return false;
+  }
+  return !trees.empty();
+}
+
+int ShardedIndex::shardFor(int key) const {
+  int s = upper_bound(lowKeys.begin(), lowKeys.end(), key) - lowKeys.begin();
+  return max(0, s - 1);
+}
+
+void ShardedIndex::insert(int key, RecordPointer dataRecordId) {
+  trees[shardFor(key)]->insert(key, dataRecordId);
+}
+
+vector<RecordPointer> ShardedIndex::search(int key) {
+  return trees[shardFor(key)]->search(key);
+}
+
+long long ShardedIndex::countRange(int lowKey, int highKey) {
+  if (lowKey > highKey)
+    return 0;
+  long long total = 0;
+  for (int s = shardFor(lowKey); s <= shardFor(highKey); ++s) {
+    total += trees[s]->countRange(lowKey, highKey);
+  }
+  return total;
+}
@@ -0,0 +1,50 @@
+#ifndef PARALLEL_BUILD_H
+#define PARALLEL_BUILD_H
+
+#include "bplustree.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Construção paralela do índice sobre ano_colheita de vinhos.csv.
+//
+// O CSV é dividido em `threads` faixas de bytes, cortadas em fins de linha.
+// Cada thread extrai os pares (ano_colheita, número da linha) da sua faixa e
+// os ordena; as sequências ordenadas (runs) são depois intercaladas numa só.
+vector<vector<pair<int, RecordPointer>>> extractSortedRuns(const string &csvPath, int threads);
+vector<pair<int, RecordPointer>> mergeSortedRuns(const vector<vector<pair<int, RecordPointer>>> &runs);
+
+// Índice particionado por faixa de chave: N árvores independentes
+// (<índice>.shard<i>) e um arquivo de roteamento (<índice>.shards) com a menor
+// chave de cada uma. Todas as entradas de uma chave ficam no mesmo shard.
+class ShardedIndex {
+public:
+    // Divide as entradas ordenadas em até numShards faixas de tamanho
+    // parecido e constrói cada árvore numa thread. As opções de ordem, página
+    // e compressão são as do construtor de BPlusTree. retorna o número de
+    // shards criados (0 em caso de erro).
+    static int build(const vector<pair<int, RecordPointer>> &sortedEntries, int numShards,
+                     const string &indexFileName, const string &dataFileName,
+                     int order, int pageSize, bool compressLeaves);
+    // Apaga o roteamento e os arquivos dos shards, se existirem.
+    static void remove(const string &indexFileName);
+    static string routingPath(const string &indexFileName);
+
+    // Abre os shards listados no roteamento; false se não houver roteamento.
+    bool open(const string &indexFileName, const string &dataFileName);
+    int shardCount() const { return static_cast<int>(trees.size()); }
+
+    void insert(int key, RecordPointer dataRecordId);
+    vector<RecordPointer> search(int key);
+    long long countRange(int lowKey, int highKey);
+
+private:
+    vector<int> lowKeys; // Menor chave roteada para cada shard (o primeiro recebe INT_MIN)
+    vector<unique_ptr<BPlusTree>> trees;
+
+    int shardFor(int key) const;
+};
+
+#endif // PARALLEL_BUILD_H
@@ -0,0 +1,316 @@
+#include "query_server.h"
+#include "parallel_build.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+// Com alterações pendentes, o servidor grava o índice (sync) após este tempo
+// sem comandos.
+static const int IDLE_SYNC_MILLIS = 1000;
+static const size_t READ_CHUNK = 64 * 1024;
+
+static volatile sig_atomic_t stopSignal = 0;
+
+static void handleStopSignal(int) { stopSignal = 1; }
+
+// Sem SA_RESTART: poll/getline voltam com EINTR e o laço termina, de forma que
+// o destrutor da árvore grave o buffer e o cabeçalho.
+static void installStopHandlers() {
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = handleStopSignal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+}
+
+string formatSearchResult(int key, vector<RecordPointer> results) {
+  if (results.empty()) {
+    return "CHAVE NAO ENCONTRADA: " + to_string(key);
+  }
+  sort(results.begin(), results.end()); // ordena para saída consistente
+  string line = "CHAVE ENCONTRADA: " + to_string(key) + " LINHAS: ";
+  for (size_t i = 0; i < results.size(); ++i) {
+    line += to_string(results[i]);
+    if (i + 1 < results.size())
+      line += ',';
+  }
+  return line;
+}
+
+QueryServer::QueryServer(BPlusTree &tree, const string &dataFileName)
+    : tree(tree), shutdownRequested(false), treeChanged(false) {
+  int threads = max(1u, thread::hardware_concurrency());
+  dataEntries = mergeSortedRuns(extractSortedRuns(dataFileName, threads));
+}
+
+string QueryServer::handleCommand(const string &line, bool &closeClient) {
+  closeClient = false;
+  try {
+    // COUNT[<min>,<max>]: número de entradas com chave no intervalo fechado
+    if (line.rfind("COUNT[", 0) == 0) {
+      size_t comma_pos = line.find(',');
+      size_t close_pos = line.find(']');
+      if (comma_pos == string::npos || close_pos == string::npos ||
+          close_pos < comma_pos) {
+        throw invalid_argument("intervalo malformado");
+      }
+      int low = stoi(line.substr(6, comma_pos - 6));
+      int high = stoi(line.substr(comma_pos + 1, close_pos - comma_pos - 1));
+      return "CONTAGEM: [" + to_string(low) + "," + to_string(high) +
+             "] = " + to_string(tree.countRange(low, high));
+    }
+
+    size_t colon_pos = line.find(':');
+    if (colon_pos == string::npos) {
+      return "ERRO: comando malformado (sem dois pontos): " + line;
+    }
+    string command_type = line.substr(0, colon_pos);
+    string command_value_str = line.substr(colon_pos + 1);
+
+    if (command_type == "INC") {
+      int key = stoi(command_value_str);
+      auto range = equal_range(
+          dataEntries.begin(), dataEntries.end(),
+          make_pair(key, RecordPointer(0)),
+          [](const pair<int, RecordPointer> &a,
+             const pair<int, RecordPointer> &b) { return a.first < b.first; });
+      for (auto it = range.first; it != range.second; ++it) {
+        tree.insert(key, it->second);
+      }
+      if (range.first != range.second) {
+        treeChanged = true;
+      }
+      return "INC: " + to_string(key) + " = " +
+             to_string(range.second - range.first) + " ENTRADAS";
+    } else if (command_type == "BUS=") {
+      int key = stoi(command_value_str);
+      return formatSearchResult(key, tree.search(key));
+    } else if (command_type == "COUNT=") {
+      int key = stoi(command_value_str);
+      return "CONTAGEM: " + to_string(key) + " = " +
+             to_string(tree.countRange(key, key));
+    } else if (command_type == "SYNC") {
+      tree.sync();
+      treeChanged = false;
+      return "SYNC: OK";
+    } else if (command_type == "QUIT") {
+      closeClient = true;
+      return "QUIT: OK";
+    } else if (command_type == "SHUTDOWN") {
+      closeClient = true;
+      shutdownRequested = true;
+      return "SHUTDOWN: OK";
+    }
+    return "ERRO: comando nao suportado no modo servidor: " + line;
+  } catch (const exception &e) {
+    return "ERRO: " + line + " - " + e.what();
+  }
+}
+
+int QueryServer::run(const string &socketPath) {
+  stopSignal = 0;
+  installStopHandlers();
+  return socketPath == "-" ? runStdin() : runSocket(socketPath);
+}
+
+/**
+ * Protocolo em stdin/stdout: as respostas são acumuladas e só descarregadas
+ * quando não há mais entrada já disponível, o que mantém o pipeline de um
+ * cliente que escreve vários comandos de uma vez. Depende de cin sem a
+ * sincronização com stdio (ver main): sincronizado, in_avail() é sempre 0.
+ */
+int QueryServer::runStdin() {
+  string line;
+  while (!stopSignal && !shutdownRequested && getline(cin, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty() || line[0] == '#')
+      continue;
+    bool closeClient;
+    cout << handleCommand(line, closeClient) << '\n';
+    if (closeClient)
+      break;
+    if (cin.rdbuf()->in_avail() <= 0)
+      cout.flush();
+  }
+  cout.flush();
+  return 0;
+}
+
+namespace {
+struct ClientConnection {
+  int fd;
+  string input;  // Bytes recebidos ainda sem '\n'
+  string output; // Respostas ainda não enviadas
+  bool closing;  // Fecha quando output esvaziar
+};
+} // namespace
+
+static bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/**
+ * Laço de eventos com poll() numa única thread: aceita conexões, lê tudo o que
+ * chegou de cada cliente, executa as linhas completas em ordem e envia as
+ * respostas acumuladas. Como os comandos rodam um de cada vez, a árvore (e o
+ * seu buffer de nó) é compartilhada pelos clientes sem travas adicionais.
+ */
+int QueryServer::runSocket(const string &socketPath) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    cerr << "Erro: Caminho de socket longo demais: " << socketPath << endl;
+    return 1;
+  }
+  strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+  int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    cerr << "Erro: Não foi possível criar o socket: " << strerror(errno)
+         << endl;
+    return 1;
+  }
+  unlink(socketPath.c_str()); // Socket deixado por uma execução anterior
+  if (bind(listenFd, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      listen(listenFd, SOMAXCONN) < 0 || !setNonBlocking(listenFd)) {
+    cerr << "Erro: Não foi possível escutar em " << socketPath << ": "
+         << strerror(errno) << endl;
+    close(listenFd);
+    return 1;
+  }
+  cerr << "Servidor escutando em " << socketPath << endl;
+
+  vector<ClientConnection> clients;
+  vector<char> buffer(READ_CHUNK);
+  while (!stopSignal) {
+    if (shutdownRequested) {
+      bool pending = false;
+      for (const ClientConnection &client : clients)
+        pending = pending || !client.output.empty();
+      if (!pending)
+        break;
+    }
+
+    vector<pollfd> fds;
+    fds.push_back({listenFd, static_cast<short>(shutdownRequested ? 0 : POLLIN),
+                   0});
+    for (const ClientConnection &client : clients) {
+      short events = 0;
+      if (!client.closing && !shutdownRequested)
+        events |= POLLIN;
+      if (!client.output.empty())
+        events |= POLLOUT;
+      fds.push_back({client.fd, events, 0});
+    }
+    int ready = poll(fds.data(), fds.size(), treeChanged ? IDLE_SYNC_MILLIS : -1);
+    if (ready < 0) {
+      if (errno == EINTR)
+        continue;
+      cerr << "Erro: poll falhou: " << strerror(errno) << endl;
+      break;
+    }
+    if (ready == 0) { // Ocioso com inserções pendentes
+      tree.sync();
+      treeChanged = false;
+      continue;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      int clientFd;
+      while ((clientFd = accept(listenFd, nullptr, nullptr)) >= 0) {
+        if (!setNonBlocking(clientFd)) {
+          close(clientFd);
+          continue;
+        }
+        clients.push_back({clientFd, "", "", false});
+      }
+    }
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+      ClientConnection &client = clients[i];
+      short revents = i + 1 < fds.size() && fds[i + 1].fd == client.fd
+                          ? fds[i + 1].revents
+                          : 0;
+      if (revents & (POLLIN | POLLHUP | POLLERR)) {
+        while (true) {
+          ssize_t n = read(client.fd, buffer.data(), buffer.size());
+          if (n > 0) {
+            client.input.append(buffer.data(), static_cast<size_t>(n));
+            continue;
+          }
+          if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK &&
+                         errno != EINTR)) {
+            client.closing = true; // Fim da entrada: responde o que chegou
+          }
+          break;
+        }
+        size_t start = 0, end;
+        while (!shutdownRequested &&
+               (end = client.input.find('\n', start)) != string::npos) {
+          string line = client.input.substr(start, end - start);
+          start = end + 1;
+          if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+          if (line.empty() || line[0] == '#')
+            continue;
+          bool closeClient;
+          client.output += handleCommand(line, closeClient);
+          client.output += '\n';
+          if (closeClient) {
+            client.closing = true;
+            break;
+          }
+        }
+        client.input.erase(0, start);
+      }
+      while (!client.output.empty()) {
+        ssize_t n = send(client.fd, client.output.data(), client.output.size(),
+                         MSG_NOSIGNAL);
+        if (n > 0) {
+          client.output.erase(0, static_cast<size_t>(n));
+        } else if (n < 0 && errno == EINTR) {
+          continue;
+        } else {
+          if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            client.output.clear(); // Cliente desconectado
+            client.closing = true;
+          }
+          break;
+        }
+      }
+    }
+
+    // Fecha os clientes que terminaram e já receberam todas as respostas.
+    for (size_t i = 0; i < clients.size();) {
+      if ((clients[i].closing || shutdownRequested) &&
+          clients[i].output.empty()) {
+        close(clients[i].fd);
+        clients.erase(clients.begin() + static_cast<long>(i));
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  for (const ClientConnection &client : clients)
+    close(client.fd);
+  close(listenFd);
+  unlink(socketPath.c_str());
+  cerr << "Servidor encerrado" << endl;
+  return 0;
+}
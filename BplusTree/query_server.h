@@ -0,0 +1,45 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include "bplustree.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Modo servidor (--serve): a árvore fica aberta entre lotes e atende comandos
+// de vários clientes, sem reabrir o índice nem reler o vinhos.csv a cada
+// execução. O protocolo é de linhas: cada linha recebida é um comando (INC,
+// BUS=, COUNT=, COUNT[, SYNC, QUIT, SHUTDOWN) e produz exatamente uma linha de
+// resposta, na mesma ordem. Um cliente pode mandar vários comandos sem esperar
+// as respostas; todas as linhas completas já recebidas são executadas e as
+// respostas saem numa única escrita.
+class QueryServer {
+public:
+    // Os pares (ano_colheita, linha) de dataFileName são lidos uma vez, aqui;
+    // INC os consulta em memória em vez de percorrer o CSV.
+    QueryServer(BPlusTree &tree, const string &dataFileName);
+
+    // Atende no socket Unix socketPath, ou em stdin/stdout se for "-", até
+    // SHUTDOWN:, fim da entrada ou SIGINT/SIGTERM. retorna 0 ou 1 em erro.
+    int run(const string &socketPath);
+
+    // Executa uma linha de comando e devolve a resposta (sem o '\n').
+    // closeClient indica que o cliente pediu para encerrar a conexão.
+    string handleCommand(const string &line, bool &closeClient);
+
+private:
+    BPlusTree &tree;
+    vector<pair<int, RecordPointer>> dataEntries; // Ordenados por chave
+    bool shutdownRequested;
+    bool treeChanged; // Houve INC desde o último sync
+
+    int runStdin();
+    int runSocket(const string &socketPath);
+};
+
+// Linha de resposta de BUS= (também usada pelo main)
+string formatSearchResult(int key, vector<RecordPointer> results);
+
+#endif // QUERY_SERVER_H
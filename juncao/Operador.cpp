@@ -32,6 +32,52 @@ int Operador::getIndexColuna(const Tabela& tabela, const string& chave) const {
 
 #include <filesystem>
 
+namespace {
+// Árvore de perdedores sobre a chave atual de cada run (nullptr = run
+// esgotado). O vencedor (menor chave; em empate, o menor índice) fica em
+// nos[0] e cada nó interno guarda o perdedor do seu jogo, então trocar a
+// chave do vencedor refaz só o caminho até a raiz: log2(k) comparações em vez
+// de percorrer todos os runs.
+struct ArvoreDePerdedores {
+    size_t k;
+    vector<size_t> nos;
+    vector<const string*> chaves;
+
+    explicit ArvoreDePerdedores(const vector<const string*>& iniciais)
+        : k(iniciais.size()), nos(max<size_t>(1, iniciais.size()), 0), chaves(iniciais) {
+        if (k < 2) return;
+        vector<size_t> vencedores(2 * k);
+        for (size_t i = 0; i < k; ++i) vencedores[k + i] = i;
+        for (size_t n = k - 1; n >= 1; --n) {
+            size_t a = vencedores[2 * n], b = vencedores[2 * n + 1];
+            bool aVence = vence(a, b);
+            vencedores[n] = aVence ? a : b;
+            nos[n] = aVence ? b : a;
+        }
+        nos[0] = vencedores[1];
+    }
+
+    bool vence(size_t a, size_t b) const {
+        if (!chaves[b]) return chaves[a] || a < b;
+        if (!chaves[a]) return false;
+        int cmp = chaves[a]->compare(*chaves[b]);
+        return cmp < 0 || (cmp == 0 && a < b);
+    }
+
+    size_t vencedor() const { return nos[0]; }
+    bool vazia() const { return chaves.empty() || !chaves[nos[0]]; }
+
+    void substituir(const string* novaChave) {
+        size_t atual = nos[0];
+        chaves[atual] = novaChave;
+        for (size_t n = (atual + k) / 2; n >= 1; n /= 2) {
+            if (vence(nos[n], atual)) swap(nos[n], atual);
+        }
+        nos[0] = atual;
+    }
+};
+} // namespace
+
 void Operador::externalSort(Tabela& tabela, const string& chave, const string& nomeArquivoSaida) {
     namespace fs = std::filesystem;
     const int PAGS_POR_RUN = 4;
@@ -99,17 +145,17 @@ void Operador::externalSort(Tabela& tabela, const string& chave, const string& n
         }
     }
 
+    // Chave atual de cada run, sem cópia
+    auto chaveDe = [idx](const vector<string>& tupla) -> const string* {
+        return tupla.empty() ? nullptr : &tupla[idx];
+    };
+    vector<const string*> chaves;
+    for (const auto& tupla : tuplas) chaves.push_back(chaveDe(tupla));
+    ArvoreDePerdedores arvore(chaves);
+
     ofstream arqSaida(nomeArquivoSaida);
-    while (true) {
-        int menorIdx = -1;
-        for (size_t i = 0; i < tuplas.size(); ++i) {
-            if (!tuplas[i].empty()) {
-                if (menorIdx == -1 || tuplas[i][idx] < tuplas[menorIdx][idx]) {
-                    menorIdx = i;
-                }
-            }
-        }
-        if (menorIdx == -1) break; // Todos arquivos acabaram
+    while (!arvore.vazia()) { // Para quando todos os arquivos acabarem
+        size_t menorIdx = arvore.vencedor();
 
         // Escreve a menor tupla
         for (size_t k = 0; k < tuplas[menorIdx].size(); ++k) {
@@ -125,10 +171,11 @@ void Operador::externalSort(Tabela& tabela, const string& chave, const string& n
             string valor;
             vector<string> tupla;
             while (getline(ss, valor, ',')) tupla.push_back(valor);
-            tuplas[menorIdx] = tupla;
+            tuplas[menorIdx] = move(tupla);
         } else {
             tuplas[menorIdx].clear();
         }
+        arvore.substituir(chaveDe(tuplas[menorIdx]));
     }
     arqSaida.close();
     IOExecutados++; // Escrita final
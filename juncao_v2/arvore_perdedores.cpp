@@ -0,0 +1,37 @@
+#include "arvore_perdedores.h"
+
+ArvoreDePerdedores::ArvoreDePerdedores(size_t numRuns, bool comoTexto)
+    : k(numRuns), comoTexto(comoTexto), nos(numRuns > 0 ? numRuns : 1, 0) {}
+
+void ArvoreDePerdedores::iniciar(const vector<const Valor *> &chavesIniciais) {
+  chaves = chavesIniciais;
+  if (k == 0)
+    return;
+  // Folha do run i na posição k + i; vencedores[n] é o vencedor do jogo n
+  vector<size_t> vencedores(2 * k);
+  for (size_t i = 0; i < k; ++i) {
+    vencedores[k + i] = i;
+  }
+  for (size_t n = k - 1; n >= 1; --n) {
+    size_t a = vencedores[2 * n];
+    size_t b = vencedores[2 * n + 1];
+    bool aVence = vence(a, b);
+    vencedores[n] = aVence ? a : b;
+    nos[n] = aVence ? b : a;
+  }
+  nos[0] = k > 1 ? vencedores[1] : 0;
+}
+
+void ArvoreDePerdedores::substituir(const Valor *novaChave) {
+  size_t atual = nos[0];
+  chaves[atual] = novaChave;
+  // Sobe da folha até a raiz; em cada jogo fica o perdedor e segue o vencedor
+  for (size_t n = (atual + k) / 2; n >= 1; n /= 2) {
+    if (vence(nos[n], atual)) {
+      size_t perdedor = atual;
+      atual = nos[n];
+      nos[n] = perdedor;
+    }
+  }
+  nos[0] = atual;
+}
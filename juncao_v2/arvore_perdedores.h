@@ -0,0 +1,45 @@
+#pragma once
+
+#include "valor.h"
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Árvore de perdedores (torneio) para o merge de k runs. Cada folha é a chave
+// atual de um run, guardada como ponteiro para o Valor dentro da página do
+// run (sem cópia); nullptr marca um run que acabou. A raiz guarda o run com a
+// menor chave e cada nó interno o perdedor do jogo naquele ponto, de forma
+// que trocar a chave do vencedor refaz só o caminho até a raiz: cerca de
+// log2(k) comparações, movendo apenas índices de run. Com comoTexto, as
+// chaves são comparadas pelo texto (ver compararValores).
+class ArvoreDePerdedores {
+public:
+  explicit ArvoreDePerdedores(size_t numRuns, bool comoTexto = false);
+
+  // Monta o torneio com a chave atual de cada run
+  void iniciar(const vector<const Valor *> &chavesIniciais);
+  // Run com a menor chave; em empate, o de menor índice
+  size_t vencedor() const { return nos[0]; }
+  // Todos os runs acabaram
+  bool vazia() const { return chaves.empty() || chaves[nos[0]] == nullptr; }
+  // Nova chave do run vencedor (nullptr se ele acabou) e novo torneio
+  void substituir(const Valor *novaChave);
+
+private:
+  size_t k;
+  bool comoTexto;
+  vector<size_t> nos;         // [0]: vencedor; [1, k): perdedor de cada jogo
+  vector<const Valor *> chaves; // Chave atual de cada run
+
+  // O run a vence o run b
+  bool vence(size_t a, size_t b) const {
+    if (chaves[b] == nullptr)
+      return chaves[a] != nullptr || a < b;
+    if (chaves[a] == nullptr)
+      return false;
+    if (valorMenor(*chaves[a], *chaves[b], comoTexto))
+      return true;
+    return a < b && !valorMenor(*chaves[b], *chaves[a], comoTexto);
+  }
+};
@@ -0,0 +1,99 @@
+#include "custo.h"
+#include "pagina.h" // Para MAX_TUPLES_PER_PAGE
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static long long dividirParaCima(long long a, long long b) {
+  return b > 0 ? (a + b - 1) / b : a;
+}
+
+// Leitura e escrita das páginas na geração dos runs e em cada passo do merge,
+// que junta até memoria - 1 runs por vez
+static long long custoOrdenacao(int paginas, int memoria,
+                                bool selecaoSubstituicao) {
+  long long paginasPorRun =
+      selecaoSubstituicao ? 2LL * max(1, memoria - 2) : memoria - 1;
+  long long runs = dividirParaCima(paginas, paginasPorRun);
+  long long passos = 0;
+  while (runs > 1) {
+    runs = dividirParaCima(runs, max(2, memoria - 1));
+    passos++;
+  }
+  return 2LL * paginas * (1 + passos);
+}
+
+// Tuplas esperadas na junção: |R1| * |R2| / max(V1, V2)
+static double tuplasJuncao(const EstatisticasEntrada &e1,
+                           const EstatisticasEntrada &e2) {
+  long long distintos = max(1LL, max(e1.distintos, e2.distintos));
+  return static_cast<double>(e1.tuplas) * static_cast<double>(e2.tuplas) /
+         static_cast<double>(distintos);
+}
+
+long long custoSortMerge(const EstatisticasEntrada &e1,
+                         const EstatisticasEntrada &e2, int memoria,
+                         bool selecaoSubstituicao) {
+  return custoOrdenacao(e1.paginas, memoria, selecaoSubstituicao) +
+         custoOrdenacao(e2.paginas, memoria, selecaoSubstituicao) +
+         e1.paginas + e2.paginas;
+}
+
+long long custoHash(const EstatisticasEntrada &e1,
+                    const EstatisticasEntrada &e2, int memoria) {
+  long long menor = min(e1.paginas, e2.paginas);
+  long long total = e1.paginas + e2.paginas;
+  int niveis = 0;
+  while (menor > memoria - 2) {
+    menor = dividirParaCima(menor, memoria - 1);
+    niveis++;
+  }
+  return 2LL * total * niveis + total;
+}
+
+long long custoBlocoAninhado(const EstatisticasEntrada &e1,
+                             const EstatisticasEntrada &e2, int memoria) {
+  long long externa = min(e1.paginas, e2.paginas);
+  long long interna = max(e1.paginas, e2.paginas);
+  return externa + dividirParaCima(externa, memoria - 2) * interna;
+}
+
+long long custoIndice(const EstatisticasEntrada &e1,
+                      const EstatisticasEntrada &e2, int memoria,
+                      bool indiceAtualizado, int ordemIndice) {
+  long long custo = e1.paginas + (indiceAtualizado ? 0 : e2.paginas);
+  if (e1.tuplas == 0 || e2.tuplas == 0)
+    return custo;
+
+  // Altura da árvore com folhas cheias. Com um único nível a raiz é a folha e
+  // fica no buffer de nó entre as consultas; com mais, cada descida relê o
+  // caminho inteiro, pois o buffer guarda só o último nó.
+  int altura = 1;
+  double nos = ceil(static_cast<double>(e2.tuplas) / max(1, ordemIndice - 1));
+  while (nos > 1) {
+    nos = ceil(nos / max(2, ordemIndice));
+    altura++;
+  }
+
+  long long paginasPorLote = max(1, memoria - 2);
+  long long lotes = dividirParaCima(e1.paginas, paginasPorLote);
+  double tuplasPorLote =
+      min(static_cast<double>(e1.tuplas),
+          static_cast<double>(paginasPorLote * MAX_TUPLES_PER_PAGE));
+  // Chaves distintas por lote, limitadas pelas distintas da entrada
+  double consultasPorLote =
+      min(tuplasPorLote, static_cast<double>(max(1LL, e1.distintos)));
+  double nosPorLote = altura > 1 ? consultasPorLote * altura : 0;
+
+  // Páginas de e2 distintas tocadas pelas correspondências do lote, supondo
+  // as tuplas espalhadas uniformemente
+  double correspondenciasPorLote =
+      tuplasJuncao(e1, e2) * tuplasPorLote / static_cast<double>(e1.tuplas);
+  double paginasPorLoteE2 =
+      e2.paginas * (1.0 - pow(1.0 - 1.0 / max(1, e2.paginas),
+                              correspondenciasPorLote));
+
+  return custo + 1 +
+         static_cast<long long>(llround(lotes * (nosPorLote + paginasPorLoteE2)));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Modelo de custo das junções, em E/S de página como contadas pelo Operador
+// (uma leitura ou escrita por página de TAMANHO_PAGINA_BYTES).
+
+// Estatísticas de uma entrada da junção
+struct EstatisticasEntrada {
+  int paginas = 0;
+  long long tuplas = 0;
+  long long distintos = 0; // Estimativa de chaves distintas na coluna de junção
+};
+
+// Ordenação externa (runs e passos de merge) de cada entrada seguida da leitura das
+// duas entradas ordenadas pelo merge join. Os runs têm memoria - 1 páginas ou,
+// com seleção por substituição, o dobro do heap de memoria - 2 páginas.
+long long custoSortMerge(const EstatisticasEntrada &e1,
+                         const EstatisticasEntrada &e2, int memoria,
+                         bool selecaoSubstituicao);
+
+// Junção hash: em memória se a menor entrada couber em memoria - 2 páginas;
+// senão, um nível de particionamento (leitura e escrita das duas entradas)
+// por divisão da menor por memoria - 1 até que as partições caibam
+long long custoHash(const EstatisticasEntrada &e1,
+                    const EstatisticasEntrada &e2, int memoria);
+
+// Laço aninhado em bloco: a menor entrada é lida uma vez, em blocos de
+// memoria - 2 páginas, e a maior uma vez por bloco
+long long custoBlocoAninhado(const EstatisticasEntrada &e1,
+                             const EstatisticasEntrada &e2, int memoria);
+
+// Laço aninhado com índice sobre e2: construção do índice (leitura de e2) se
+// ele não estiver atualizado, leitura de e1 e, por lote de memoria - 2
+// páginas, descidas na árvore para as chaves distintas e leitura das páginas
+// de e2 com tuplas correspondentes
+long long custoIndice(const EstatisticasEntrada &e1,
+                      const EstatisticasEntrada &e2, int memoria,
+                      bool indiceAtualizado, int ordemIndice);
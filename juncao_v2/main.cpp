@@ -1,4 +1,5 @@
 #include "operador.h"
+#include "plano.h"
 #include "tabela.h"
 #include <iostream>
 #include <string>
@@ -26,19 +27,44 @@ int main() {
   // IMPORTANTE: isso eh so um exemplo, pode ser tabelas/colunas distintas.
   // genericamente: Operador(tabela_1, tabela_2, col_tab_1, col_tab_2):
   // significa: SELECT * FROM tabela_1, tabela_2 WHERE col_tab_1 = col_tab_2
+  // O algoritmo (sort-merge, hash, laço aninhado em bloco ou com índice) é
+  // escolhido pelo custo estimado; um quinto argumento AlgoritmoJuncao o fixa.
 
-  op.executar();              // Realiza a operacao desejada
-  op.imprimirTuplasGeradas(); // Imprime as tuplas geradas pela operacao
+  // Imprime as tuplas geradas pela operacao à medida que a junção as produz;
+  // executar() também as grava em resultado_juncao_vinho_uva.csv
+  op.definirConsumidor([](const Tupla &tupla) { tupla.imprimir(); });
+  op.executar(); // Realiza a operacao desejada
   cout << "#Pags: " << op.numPagsGeradas(); // Retorna a quantidade de paginas
                                             // geradas pela operacao
   cout << "\n#IOss: " << op.numIOExecutados();  // Retorna a quantidade de IOs
                                                 // geradas pela operacao
   cout << "\n#Tups: " << op.numTuplasGeradas(); // Retorna a quantidade de
                                                 // tuplas geradas pela operacao
+  cout << "\n";
+  op.explicar(); // Estimativas de E/S de cada algoritmo x E/S executadas
 
-  op.salvarTuplasGeradas(
-      "selecao_vinho_ano_colheita_1990.csv"); // Retorna as tuplas geradas pela
-                                              // operacao e salva em um csv
+  // Uma consulta como plano de iteradores, com seleção e projeção em
+  // pipeline: SELECT rotulo, nome FROM Vinho V, Uva U
+  //           WHERE V.uva_id = U.uva_id AND U.ano_colheita > 2000
+  unique_ptr<Iterador> plano = make_unique<Projecao>(
+      make_unique<JuncaoHash>(
+          make_unique<Varredura>(vinho),
+          make_unique<Filtro>(make_unique<Varredura>(uva), "ano_colheita",
+                              Comparacao::MAIOR, Valor(2000LL)),
+          "uva_id", "uva_id"),
+      vector<string>{"rotulo", "nome"});
+  int tuplasDoPlano = 0;
+  plano->abrir();
+  for (Pagina pagina = plano->proximaPagina(); !pagina.isEmpty();
+       pagina = plano->proximaPagina()) {
+    for (int i = 0; i < pagina.qtd_tuplas_ocup; ++i) {
+      pagina.tuplas[i].imprimir();
+      tuplasDoPlano++;
+    }
+  }
+  plano->fechar();
+  cout << "#Tups do plano: " << tuplasDoPlano
+       << "\n#IOss do plano: " << plano->numIOExecutados() << "\n";
 
   return 0;
 }
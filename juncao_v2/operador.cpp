@@ -1,23 +1,135 @@
 #include "operador.h"
 #include "pagina.h" // Para MAX_TUPLES_PER_PAGE
 #include "utils.h"  // Inclui as funções utilitárias
+#include "bplustree.h"
+#include "custo.h"
+#include "ordenacao_externa.h"
+#include "particionamento.h"
 #include <algorithm>
+#include <charconv>
+#include <climits>
 #include <filesystem> // Para iterar sobre arquivos no diretório
 #include <fstream>
 #include <functional> // For std::function
 #include <iostream>
-#include <queue>
-#include <sstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 using namespace std;
 
 namespace fs = std::filesystem;
 
+// A seleção por substituição e o passo final do merge só são divididos entre
+// workers que fiquem com pelo menos tantas páginas cada: abaixo disso os runs
+// a mais (ou a amostragem) custam mais E/S do que o paralelismo economiza
+const long long MIN_PAGINAS_POR_WORKER = 8;
+
+// As ordenações rodam em threads: as mensagens delas saem uma linha por vez
+static mutex mutexSaida;
+
+// Arquivos de página da tabela (data/<tabela>/pagina_i.pag), em ordem
+static vector<string> arquivosDePaginas(const Tabela &tabela) {
+  string tableDir =
+      "data/" + tabela.nomeArquivo.substr(0, tabela.nomeArquivo.find("."));
+  vector<string> pageFiles;
+  for (const auto &entry : fs::directory_iterator(tableDir)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".pag") {
+      pageFiles.push_back(entry.path().string());
+    }
+  }
+  // Garantir ordem correta das páginas: pela numeração (pagina_2 antes de
+  // pagina_10), para que uma tabela já ordenada seja lida em ordem
+  auto numeroDaPagina = [](const string &arquivo) {
+    return stol(fs::path(arquivo).stem().string().substr(7));
+  };
+  sort(pageFiles.begin(), pageFiles.end(),
+       [&](const string &a, const string &b) {
+         return numeroDaPagina(a) < numeroDaPagina(b);
+       });
+  return pageFiles;
+}
+
+// Arquivo da página numero da tabela, como gravado por salvarPaginasEmDisco
+static string arquivoDaPagina(const Tabela &tabela, long long numero) {
+  return "data/" + tabela.nomeArquivo.substr(0, tabela.nomeArquivo.find(".")) +
+         "/pagina_" + to_string(numero) + ".pag";
+}
+
+// Índice B+ sobre a coluna da tabela usado pela junção com índice
+static string arquivoDoIndice(const Tabela &tabela, const string &coluna) {
+  return "data/" + tabela.nomeArquivo.substr(0, tabela.nomeArquivo.find(".")) +
+         "/indice_" + coluna + ".txt";
+}
+
+// O índice existe e não é mais antigo que nenhuma página da tabela; a carga
+// só regrava as páginas que mudaram (ver Tabela::salvarPaginasEmDisco)
+static bool indiceAtualizado(const Tabela &tabela, const string &arquivoIndice) {
+  if (!fs::exists(arquivoIndice))
+    return false;
+  auto dataIndice = fs::last_write_time(arquivoIndice);
+  for (const string &pagina : arquivosDePaginas(tabela)) {
+    if (fs::last_write_time(pagina) > dataIndice)
+      return false;
+  }
+  return true;
+}
+
+// Chave int da árvore B+ igual (por valorIgual com comoTexto) ao valor; false
+// se não houver, como para textos não numéricos ou inteiros fora do alcance
+// de int
+static bool chaveInteira(const Valor &valor, int &chave) {
+  if (const long long *inteiro = get_if<long long>(&valor)) {
+    if (*inteiro < INT_MIN || *inteiro > INT_MAX)
+      return false;
+    chave = static_cast<int>(*inteiro);
+    return true;
+  }
+  if (const double *real = get_if<double>(&valor)) {
+    if (*real < INT_MIN || *real > INT_MAX ||
+        static_cast<double>(static_cast<int>(*real)) != *real)
+      return false;
+    chave = static_cast<int>(*real);
+    return true;
+  }
+  // Texto só é igual a número numa junção texto x número, que compara as
+  // representações em texto
+  const string &texto = get<string>(valor);
+  const char *fim = texto.data() + texto.size();
+  auto r = from_chars(texto.data(), fim, chave);
+  return !texto.empty() && r.ec == errc() && r.ptr == fim &&
+         to_string(chave) == texto;
+}
 
 // Construtor
 Operador::Operador(const Tabela &t1, const Tabela &t2, const string &c1,
-                   const string &c2)
-    : tabela1(t1), tabela2(t2), chave1(c1), chave2(c2) {}
+                   const string &c2, AlgoritmoJuncao alg)
+    : tabela1(t1), tabela2(t2), chave1(c1), chave2(c2), algoritmo(alg),
+      arquivoResultado(
+          "resultado_juncao_" +
+          t1.nomeArquivo.substr(0, t1.nomeArquivo.find(".")) + "_" +
+          t2.nomeArquivo.substr(0, t2.nomeArquivo.find(".")) + ".csv") {}
+
+void Operador::definirPaginasMemoria(int paginas) {
+  if (paginas < 3) {
+    cerr << "Aviso: O operador precisa de pelo menos 3 páginas de memória; "
+         << "usando 3." << endl;
+    paginas = 3;
+  }
+  paginasMemoria = paginas;
+}
+
+void Operador::definirGeracaoRuns(GeracaoRuns geracao) { geracaoRuns = geracao; }
+
+void Operador::definirThreads(int numThreads) { threads = max(1, numThreads); }
+
+void Operador::definirArquivoResultado(const string &nomeArquivo) {
+  arquivoResultado = nomeArquivo;
+}
+
+void Operador::definirConsumidor(function<void(const Tupla &)> novoConsumidor) {
+  consumidor = move(novoConsumidor);
+}
 
 // Métodos getter para os contadores
 int Operador::numPagsGeradas() const { return paginasGeradas; }
@@ -26,41 +138,46 @@ int Operador::numIOExecutados() const { return IOExecutados; }
 
 int Operador::numTuplasGeradas() const { return tuplasGeradasCount; }
 
-// Implementação de imprimirTuplasGeradas
-void Operador::imprimirTuplasGeradas() const {
-  cout << "Tuplas Geradas:" << endl;
-  for (const auto &tupla : tuplasGeradas) {
-    for (size_t i = 0; i < tupla.size(); ++i) {
-      cout << tupla[i];
-      if (i != tupla.size() - 1)
-        cout << " ";
-    }
-    cout << endl;
+int Operador::numRunsGerados() const { return runsGerados; }
+
+const vector<PassoOrdenacao> &Operador::passosDaOrdenacao() const {
+  return passosOrdenacao;
+}
+
+// Uma tupla do resultado da junção: vai para a página de resultado, que é
+// descarregada assim que enche
+void Operador::emitirTupla(Tupla &&tupla) {
+  paginaResultado.adicionarTupla(move(tupla));
+  tuplasGeradasCount++;
+  if (paginaResultado.isFull()) {
+    descarregarResultado();
   }
 }
 
-// Implementação de salvarTuplasGeradas
-void Operador::salvarTuplasGeradas(const string &nomeArquivo) const {
-  ofstream arquivoSaida(nomeArquivo);
-  if (!arquivoSaida.is_open()) {
-    cerr << "Erro ao criar o arquivo de saída: " << nomeArquivo << endl;
+// Descarrega a página de resultado: cada tupla vira uma linha do arquivo de
+// resultado (sem flush por linha) e é passada ao consumidor. A página conta
+// em paginasGeradas; a gravação do resultado, como nas estimativas de custo,
+// não entra nas E/S.
+void Operador::descarregarResultado() {
+  if (paginaResultado.isEmpty()) {
     return;
   }
-
-  // Escrever cabeçalho (opcional, dependendo do requisito)
-  // Para junção, o cabeçalho seria a concatenação dos cabeçalhos das tabelas
-  // originais Por simplicidade, vamos pular o cabeçalho aqui.
-
-  for (const auto &tupla : tuplasGeradas) {
-    for (size_t i = 0; i < tupla.size(); ++i) {
-      arquivoSaida << tupla[i];
-      if (i != tupla.size() - 1)
-        arquivoSaida << ",";
+  for (int i = 0; i < paginaResultado.qtd_tuplas_ocup; ++i) {
+    const Tupla &tupla = paginaResultado.tuplas[i];
+    if (saidaResultado) {
+      for (size_t c = 0; c < tupla.cols.size(); ++c) {
+        *saidaResultado << valorParaTexto(tupla.cols[c]);
+        if (c != tupla.cols.size() - 1)
+          *saidaResultado << ",";
+      }
+      *saidaResultado << '\n';
+    }
+    if (consumidor) {
+      consumidor(tupla);
     }
-    arquivoSaida << endl;
   }
-  arquivoSaida.close();
-  cout << "Tuplas salvas em: " << nomeArquivo << endl;
+  paginasGeradas++;
+  paginaResultado = Pagina();
 }
 
 // Implementação de getIndexColuna
@@ -73,394 +190,1039 @@ int Operador::getIndexColuna(const Tabela &tabela, const string &chave) const {
   return -1; // Coluna não encontrada
 }
 
-// Implementação de externalSort
-void Operador::externalSort(Tabela &tabela, const string &chave,
-                            const string &nomeArquivoSaida) {
-  cout << "Iniciando ordenação externa para a tabela: " << tabela.nomeArquivo
-       << " pela chave: " << chave << endl;
+// Posição da primeira tupla do run com chave >= chave (lower_bound): busca
+// binária pela primeira página cuja última chave não é menor, seguida da
+// busca dentro dela. numTuplas (o fim do run) se não houver nenhuma.
+static long long limiteInferior(ifstream &run, long long numPaginas,
+                                long long numTuplas, const Valor &chave,
+                                int indiceChave, bool comoTexto, int &io) {
+  long long baixo = 0, alto = numPaginas;
+  while (baixo < alto) {
+    long long meio = baixo + (alto - baixo) / 2;
+    Pagina pagina = lerPaginaNumero(run, meio, io);
+    if (!pagina.isEmpty() &&
+        valorMenor(getColunaValue(pagina.tuplas[pagina.qtd_tuplas_ocup - 1],
+                                  indiceChave),
+                   chave, comoTexto))
+      baixo = meio + 1;
+    else
+      alto = meio;
+  }
+  if (baixo == numPaginas)
+    return numTuplas;
+  Pagina pagina = lerPaginaNumero(run, baixo, io);
+  int slot = 0;
+  while (slot < pagina.qtd_tuplas_ocup &&
+         valorMenor(getColunaValue(pagina.tuplas[slot], indiceChave), chave,
+                    comoTexto))
+    slot++;
+  return baixo * MAX_TUPLES_PER_PAGE + slot;
+}
+
+// Fase 1 no pool de threads, cada worker lendo, ordenando e gravando os seus
+// runs. Em blocos, cada bloco é uma tarefa; na seleção por substituição, as
+// páginas são divididas em uma faixa contígua por worker (de pelo menos
+// MIN_PAGINAS_POR_WORKER páginas), cada faixa com o seu heap, o que gera ao
+// menos um run por faixa. Os runs ficam na ordem das tarefas.
+bool Operador::gerarRuns(const vector<string> &pageFiles,
+                         const string &prefixo, int indiceChave,
+                         vector<string> &runFiles, int &io) const {
+  const bool emBlocos = geracaoRuns == GeracaoRuns::BLOCOS;
+  const size_t PAGES_PER_BLOCK = static_cast<size_t>(
+      paginasMemoria - 1); // Uma página para saída, as demais para entrada
+  long long numFaixas = min<long long>(
+      threads, static_cast<long long>(pageFiles.size()) / MIN_PAGINAS_POR_WORKER);
+  size_t numTarefas =
+      emBlocos ? (pageFiles.size() + PAGES_PER_BLOCK - 1) / PAGES_PER_BLOCK
+               : static_cast<size_t>(max(1LL, numFaixas));
+
+  vector<vector<string>> runsDaTarefa(numTarefas);
+  vector<int> ioDaTarefa(numTarefas, 0);
+  vector<char> tarefaOk(numTarefas, 0);
+  executarEmParalelo(numTarefas, threads, [&](size_t t) {
+    size_t inicio = emBlocos ? t * PAGES_PER_BLOCK
+                             : t * pageFiles.size() / numTarefas;
+    size_t fim = emBlocos ? min(pageFiles.size(), inicio + PAGES_PER_BLOCK)
+                          : (t + 1) * pageFiles.size() / numTarefas;
+    vector<string> paginas(pageFiles.begin() + inicio,
+                           pageFiles.begin() + fim);
+    bool erroEntrada = false;
+    FonteDeTuplas entrada =
+        fonteDeArquivos(paginas, ioDaTarefa[t], erroEntrada);
+    if (emBlocos) {
+      vector<Tupla> bloco;
+      Tupla tupla;
+      while (entrada(tupla))
+        bloco.push_back(move(tupla));
+      string runFileName = prefixo + "_run_" + to_string(t) + ".tmp";
+      tarefaOk[t] = !erroEntrada &&
+                    gerarRunEmBloco(bloco, runFileName, indiceChave,
+                                    chaveComoTexto, ioDaTarefa[t]);
+      runsDaTarefa[t].push_back(runFileName);
+    } else {
+      tarefaOk[t] = gerarRunsPorSubstituicao(
+                        entrada, paginasMemoria,
+                        prefixo + "_run_" + to_string(t) + "_", indiceChave,
+                        chaveComoTexto, runsDaTarefa[t], ioDaTarefa[t]) &&
+                    !erroEntrada;
+    }
+  });
+
+  bool ok = true;
+  for (size_t t = 0; t < numTarefas; ++t) {
+    io += ioDaTarefa[t];
+    ok = ok && tarefaOk[t];
+    runFiles.insert(runFiles.end(), runsDaTarefa[t].begin(),
+                    runsDaTarefa[t].end());
+  }
+  return ok;
+}
+
+// Passo final do merge com numWorkers workers. A faixa de chaves é dividida
+// por divisores tirados de uma amostra (a primeira chave de numWorkers
+// páginas espaçadas de cada run), e cada run é cortado nos divisores por
+// busca binária. O worker w intercala, de todos os runs, só os trechos da
+// faixa w; somando as tuplas das faixas anteriores ele sabe em que página do
+// arquivo ordenado a sua parte começa e grava direto nela. A última página de
+// cada faixa pode ficar incompleta. Devolve as páginas gravadas, ou -1.
+int Operador::mergeParalelo(const vector<string> &runFiles,
+                            const string &nomeArquivoSaida, int indiceChave,
+                            size_t numWorkers, int &io) const {
+  size_t numRuns = runFiles.size();
+  vector<long long> paginasDoRun(numRuns), tuplasDoRun(numRuns, 0);
+  vector<vector<Valor>> amostraDoRun(numRuns);
+  vector<int> ioDoRun(numRuns, 0);
+  executarEmParalelo(numRuns, threads, [&](size_t r) {
+    ifstream run(runFiles[r], ios::binary);
+    paginasDoRun[r] = numeroDePaginas(runFiles[r]);
+    if (paginasDoRun[r] == 0)
+      return;
+    long long anterior = -1;
+    for (size_t j = 0; j < numWorkers; ++j) {
+      long long numero = static_cast<long long>(j) * paginasDoRun[r] /
+                         static_cast<long long>(numWorkers);
+      if (numero == anterior)
+        continue;
+      anterior = numero;
+      Pagina pagina = lerPaginaNumero(run, numero, ioDoRun[r]);
+      if (!pagina.isEmpty())
+        amostraDoRun[r].push_back(getColunaValue(pagina.tuplas[0], indiceChave));
+    }
+    Pagina ultima = lerPaginaNumero(run, paginasDoRun[r] - 1, ioDoRun[r]);
+    tuplasDoRun[r] =
+        (paginasDoRun[r] - 1) * MAX_TUPLES_PER_PAGE + ultima.qtd_tuplas_ocup;
+  });
+
+  // Divisores: quantis da amostra, sem repetições
+  vector<Valor> amostra;
+  for (const vector<Valor> &amostraRun : amostraDoRun)
+    amostra.insert(amostra.end(), amostraRun.begin(), amostraRun.end());
+  sort(amostra.begin(), amostra.end(), [&](const Valor &a, const Valor &b) {
+    return valorMenor(a, b, chaveComoTexto);
+  });
+  vector<Valor> divisores;
+  for (size_t w = 1; w < numWorkers && !amostra.empty(); ++w) {
+    const Valor &divisor = amostra[w * amostra.size() / numWorkers];
+    if (divisores.empty() ||
+        valorMenor(divisores.back(), divisor, chaveComoTexto))
+      divisores.push_back(divisor);
+  }
+
+  // limites[r][w], limites[r][w + 1]: trecho do run r na faixa w
+  vector<vector<long long>> limites(numRuns);
+  executarEmParalelo(numRuns, threads, [&](size_t r) {
+    ifstream run(runFiles[r], ios::binary);
+    limites[r].push_back(0);
+    for (const Valor &divisor : divisores)
+      limites[r].push_back(limiteInferior(run, paginasDoRun[r], tuplasDoRun[r],
+                                          divisor, indiceChave, chaveComoTexto,
+                                          ioDoRun[r]));
+    limites[r].push_back(tuplasDoRun[r]);
+  });
+  for (int ioRun : ioDoRun)
+    io += ioRun;
+
+  size_t numFaixas = divisores.size() + 1;
+  vector<long long> primeiraPagina(numFaixas + 1, 0);
+  for (size_t w = 0; w < numFaixas; ++w) {
+    long long tuplas = 0;
+    for (size_t r = 0; r < numRuns; ++r)
+      tuplas += limites[r][w + 1] - limites[r][w];
+    primeiraPagina[w + 1] = primeiraPagina[w] +
+                            (tuplas + MAX_TUPLES_PER_PAGE - 1) /
+                                MAX_TUPLES_PER_PAGE;
+  }
+
+  ofstream arquivoSaida(nomeArquivoSaida, ios::binary); // Cria ou esvazia
+  if (!arquivoSaida.is_open()) {
+    cerr << "Erro ao criar arquivo de saída do merge: " << nomeArquivoSaida
+         << endl;
+    return -1;
+  }
+  arquivoSaida.close();
+
+  vector<int> paginasDaFaixa(numFaixas, 0), ioDaFaixa(numFaixas, 0);
+  executarEmParalelo(numFaixas, threads, [&](size_t w) {
+    vector<TrechoDeRun> trechos;
+    for (size_t r = 0; r < numRuns; ++r) {
+      if (limites[r][w] < limites[r][w + 1])
+        trechos.push_back({runFiles[r], limites[r][w], limites[r][w + 1]});
+    }
+    if (trechos.empty())
+      return;
+    // ios::in: abre para escrita sem truncar as faixas dos outros workers
+    ofstream saida(nomeArquivoSaida, ios::in | ios::binary);
+    if (!saida.is_open()) {
+      paginasDaFaixa[w] = -1;
+      return;
+    }
+    saida.seekp(primeiraPagina[w] * TAMANHO_PAGINA_BYTES);
+    paginasDaFaixa[w] =
+        intercalarTrechos(trechos, saida, indiceChave, chaveComoTexto,
+                          ioDaFaixa[w]);
+  });
+
+  int paginasGravadas = 0;
+  for (size_t w = 0; w < numFaixas; ++w) {
+    io += ioDaFaixa[w];
+    if (paginasDaFaixa[w] < 0)
+      return -1;
+    paginasGravadas += paginasDaFaixa[w];
+  }
+  return paginasGravadas;
+}
+
+// Implementação de externalSort. Não altera o Operador: E/S, páginas e passos
+// vão para contadores, de forma que as duas tabelas possam ser ordenadas ao
+// mesmo tempo.
+void Operador::externalSort(const Tabela &tabela, const string &chave,
+                            const string &nomeArquivoSaida,
+                            ContadoresOrdenacao &contadores) const {
+  {
+    lock_guard<mutex> trava(mutexSaida);
+    cout << "Iniciando ordenação externa para a tabela: " << tabela.nomeArquivo
+         << " pela chave: " << chave << endl;
+  }
 
   int indiceChave = getIndexColuna(tabela, chave);
   if (indiceChave == -1) {
-    cerr << "Erro: Chave de ordenação ";
-
-        // Fase 1: Criação de Runs Iniciais
-        vector<string>
-            runFiles;
-    int runCount = 0;
-    const int MEMORY_LIMIT_PAGES = 4; // Limite de 4 páginas em memória
-    const int PAGES_PER_BLOCK =
-        MEMORY_LIMIT_PAGES - 1; // Uma página para saída, 3 para entrada
-
-    string tableDir =
-        "data/" + tabela.nomeArquivo.substr(0, tabela.nomeArquivo.find("."));
-
-    // Coletar todos os arquivos de página da tabela
-    vector<string> pageFiles;
-    for (const auto &entry : fs::directory_iterator(tableDir)) {
-      if (entry.is_regular_file() && entry.path().extension() == ".txt") {
-        pageFiles.push_back(entry.path().string());
-      }
+    cerr << "Erro: Chave de ordenação " << chave
+         << " não encontrada na tabela " << tabela.nomeArquivo << endl;
+    return;
+  }
+
+  // Fase 1: Criação de Runs Iniciais
+  // Runs e o arquivo ordenado são só páginas binárias: o esquema (nomes e
+  // tipos das colunas) fica na Tabela, sem linha de cabeçalho. Os temporários
+  // levam o nome do arquivo ordenado, para que as duas ordenações de uma
+  // autojunção não usem os mesmos arquivos.
+  string prefixo = nomeArquivoSaida.substr(0, nomeArquivoSaida.rfind('.'));
+  vector<string> pageFiles = arquivosDePaginas(tabela);
+  vector<string> runFiles;
+  int ioDosRuns = 0;
+  if (!gerarRuns(pageFiles, prefixo, indiceChave, runFiles, ioDosRuns)) {
+    return;
+  }
+  contadores.io += ioDosRuns;
+  contadores.runs += runFiles.size();
+  contadores.passos.push_back({tabela.nomeArquivo, 0,
+                               static_cast<int>(runFiles.size()), ioDosRuns});
+  if (!runFiles.empty()) {
+    lock_guard<mutex> trava(mutexSaida);
+    cout << "Runs gerados para " << tabela.nomeArquivo << ": "
+         << runFiles.size() << " (média de "
+         << static_cast<double>(pageFiles.size()) / runFiles.size()
+         << " páginas)" << endl;
+  }
+
+  // Fase 2: Merge dos Runs
+  if (runFiles.empty()) {
+    lock_guard<mutex> trava(mutexSaida);
+    cout << "Nenhum run gerado para a tabela " << tabela.nomeArquivo << endl;
+    ofstream outFile(nomeArquivoSaida, ios::binary); // Arquivo sem páginas
+    outFile.close();
+    return;
+  }
+
+  // Passos de merge de grupos de até paginasMemoria - 1 runs (uma página de
+  // entrada por run e uma de saída), com os grupos de cada passo no pool, até
+  // restarem paginasMemoria - 1 runs; o passo final os intercala no arquivo
+  // ordenado, dividido por faixas de chave quando há páginas para mais de um
+  // worker. Assim a memória de cada merge fica limitada qualquer que seja o
+  // número de runs.
+  auto registrarPasso = [&](int passo, size_t runsAntes, int runsDepois,
+                            int ioDoPasso) {
+    {
+      lock_guard<mutex> trava(mutexSaida);
+      cout << "Passo " << passo << " do merge de " << tabela.nomeArquivo
+           << ": " << runsAntes << " runs -> " << runsDepois
+           << " (E/S: " << ioDoPasso << ")" << endl;
     }
-    sort(pageFiles.begin(),
-         pageFiles.end()); // Garantir ordem correta das páginas
-
-    string headerLine; // O cabeçalho deve ser lido uma vez da tabela original
-                       // ou passado
-    // Por simplicidade, vamos assumir que o cabeçalho é o mesmo da tabela
-    // original e que ele já foi carregado na Tabela::col_names
-    if (!tabela.col_names.empty()) {
-      stringstream ss;
-      for (size_t i = 0; i < tabela.col_names.size(); ++i) {
-        ss << tabela.col_names[i];
-        if (i < tabela.col_names.size() - 1)
-          ss << ",";
-      }
-      headerLine = ss.str();
-    }
-
-    size_t currentPageIndex = 0;
-    while (currentPageIndex < pageFiles.size()) {
-      vector<Tupla> currentBlockTuplas;
-      for (int i = 0;
-           i < PAGES_PER_BLOCK && currentPageIndex < pageFiles.size(); ++i) {
-        ifstream pageFileStream(pageFiles[currentPageIndex]);
-        if (!pageFileStream.is_open()) {
-          cerr << "Erro ao abrir arquivo de página: "
-               << pageFiles[currentPageIndex] << endl;
-          return;
-        }
-        Pagina p = lerPaginaDeStream(pageFileStream,
-                                     IOExecutados); // Usa a função de utilidade
-        for (int j = 0; j < p.qtd_tuplas_ocup; ++j) {
-          currentBlockTuplas.push_back(p.tuplas[j]);
-        }
-        pageFileStream.close();
-        currentPageIndex++;
-      }
+    contadores.io += ioDoPasso;
+    contadores.passos.push_back(
+        {tabela.nomeArquivo, passo, runsDepois, ioDoPasso});
+  };
+  const size_t fanIn = static_cast<size_t>(max(2, paginasMemoria - 1));
+  size_t runsAntes = runFiles.size();
+  vector<PassoDeMerge> passos;
+  bool passosOk = intercalarEmPassos(runFiles, fanIn, prefixo, indiceChave,
+                                     chaveComoTexto, threads, passos);
+  for (size_t p = 0; p < passos.size(); ++p) {
+    registrarPasso(static_cast<int>(p + 1), runsAntes, passos[p].runs,
+                   passos[p].io);
+    runsAntes = static_cast<size_t>(passos[p].runs);
+  }
+  if (!passosOk) {
+    return;
+  }
 
-      if (currentBlockTuplas.empty()) {
-        break; // Não há mais dados para ler
-      }
+  if (runFiles.size() > 1) {
+    bool paginasSempreCheias = true;
+    for (const Pagina &pagina : tabela.pags)
+      for (int i = 0; i < pagina.qtd_tuplas_ocup; ++i)
+        paginasSempreCheias = paginasSempreCheias &&
+                              Pagina::cabeEmPaginaCheia(pagina.tuplas[i]);
+    long long paginas = 0;
+    for (const string &runFile : runFiles)
+      paginas += numeroDePaginas(runFile);
+    // O merge por faixas calcula a posição das tuplas supondo páginas
+    // cheias; com tuplas largas as páginas fecham antes e ele não se aplica
+    size_t numWorkers =
+        paginasSempreCheias
+            ? static_cast<size_t>(
+                  min<long long>(threads, paginas / MIN_PAGINAS_POR_WORKER))
+            : 1;
+    int ioDoPasso = 0;
+    int paginasGravadas =
+        numWorkers > 1 ? mergeParalelo(runFiles, nomeArquivoSaida, indiceChave,
+                                       numWorkers, ioDoPasso)
+                       : mergeRuns(runFiles, nomeArquivoSaida, indiceChave,
+                                   chaveComoTexto, ioDoPasso);
+    if (paginasGravadas < 0) {
+      return;
+    }
+    // Só as páginas do passo final (o arquivo ordenado) entram em
+    // paginasGeradas
+    contadores.paginasGeradas += paginasGravadas;
+    for (const string &runFile : runFiles)
+      remove(runFile.c_str());
+    registrarPasso(static_cast<int>(passos.size() + 1), runFiles.size(), 1,
+                   ioDoPasso);
+    runFiles = {nomeArquivoSaida};
+  }
+
+  if (runFiles[0] != nomeArquivoSaida) {
+    // Um run só, já ordenado: ele é o arquivo ordenado e as suas páginas
+    // contam como geradas, como as do passo final de merge
+    contadores.paginasGeradas += static_cast<int>(numeroDePaginas(runFiles[0]));
+    if (rename(runFiles[0].c_str(), nomeArquivoSaida.c_str()) != 0) {
+      perror("Erro ao renomear arquivo do run");
+    }
+  }
+  lock_guard<mutex> trava(mutexSaida);
+  cout << "Tabela " << tabela.nomeArquivo << " ordenada e salva em "
+       << nomeArquivoSaida << endl;
+}
+
+// Implementação de mergeJoin
+void Operador::mergeJoin(const string &arq1Ordenado,
+                         const string &arq2Ordenado) {
+  cout << "Iniciando Merge Join entre " << arq1Ordenado << " e "
+       << arq2Ordenado << endl;
+
+  ifstream file1(arq1Ordenado, ios::binary);
+  ifstream file2(arq2Ordenado, ios::binary);
+
+  if (!file1.is_open()) {
+    cerr << "Erro ao abrir arquivo ordenado: " << arq1Ordenado << endl;
+    return;
+  }
+  if (!file2.is_open()) {
+    cerr << "Erro ao abrir arquivo ordenado: " << arq2Ordenado << endl;
+    return;
+  }
+
+  int idxChave1 = getIndexColuna(tabela1, chave1);
+  int idxChave2 = getIndexColuna(tabela2, chave2);
 
-      // Ordena o bloco em memória
-      sort(currentBlockTuplas.begin(), currentBlockTuplas.end(),
-           [&](const Tupla &a, const Tupla &b) {
-             return getColunaValue(a, indiceChave) <
-                    getColunaValue(b, indiceChave);
-           });
-
-      // Escreve o run ordenado em um arquivo temporário
-      string runFileName =
-          tabela.nomeArquivo + "_run_" + to_string(runCount++) + ".tmp";
-      ofstream runFileStream(runFileName);
-      if (!runFileStream.is_open()) {
-        cerr << "Erro ao criar arquivo de run: " << runFileName << endl;
-        return;
+  if (idxChave1 == -1 || idxChave2 == -1) {
+    cerr << "Erro: Chave de junção não encontrada em uma das tabelas."
+         << endl;
+    file1.close();
+    file2.close();
+    return;
+  }
+
+  // Posições para "rebobinar" file2 em caso de duplicatas na tabela1
+  streampos file2_pos_before_match;
+
+  Pagina currentPagina1 = lerPaginaDeStream(file1, IOExecutados);
+  Pagina currentPagina2 = lerPaginaDeStream(file2, IOExecutados);
+
+  int idxTupla1 = 0;
+  int idxTupla2 = 0;
+
+  while (!currentPagina1.isEmpty() && !currentPagina2.isEmpty()) {
+    // Referências para as chaves tipadas, sem copiar as tuplas
+    const Valor &valChave1 =
+        getColunaValue(currentPagina1.tuplas[idxTupla1], idxChave1);
+    const Valor &valChave2 =
+        getColunaValue(currentPagina2.tuplas[idxTupla2], idxChave2);
+
+    if (valorMenor(valChave1, valChave2, chaveComoTexto)) {
+      idxTupla1++;
+      if (idxTupla1 >= currentPagina1.qtd_tuplas_ocup) {
+        currentPagina1 = lerPaginaDeStream(file1, IOExecutados);
+        idxTupla1 = 0;
       }
-      // Escrever cabeçalho no run file se a tabela original tinha cabeçalho
-      if (!tabela.col_names.empty()) {
-        runFileStream << headerLine << endl;
+    } else if (valorMenor(valChave2, valChave1, chaveComoTexto)) {
+      idxTupla2++;
+      if (idxTupla2 >= currentPagina2.qtd_tuplas_ocup) {
+        currentPagina2 = lerPaginaDeStream(file2, IOExecutados);
+        idxTupla2 = 0;
       }
+    } else {
+      // A chave é copiada uma vez por grupo: as páginas mudam abaixo
+      const Valor chaveAtual = valChave1;
+      // Chaves iguais, fazer a junção
+      // Salvar a posição atual de file2 para "rebobinar" se houver duplicatas
+      // em tabela1
+      file2_pos_before_match = file2.tellg();
+      // Precisamos salvar o estado da página e o índice da tupla
+      Pagina savedPagina2 = currentPagina2;
+      int savedIdxTupla2 = idxTupla2;
 
-      Pagina currentRunPage;
-      for (const auto &tupla : currentBlockTuplas) {
-        if (currentRunPage.isFull()) {
-          escreverPaginaEmStream(runFileStream, currentRunPage,
-                                 IOExecutados); // Usa a função de utilidade
-          currentRunPage = Pagina();            // Reseta a página
+      vector<Tupla> blocoTabela2;
+      // Coleta todas as tuplas da tabela2 que correspondem à chave atual
+      int tempIdxTupla2 = idxTupla2;
+      Pagina tempPagina2 = currentPagina2;
+      while (true) {
+        if (tempIdxTupla2 >= tempPagina2.qtd_tuplas_ocup) {
+          tempPagina2 = lerPaginaDeStream(file2, IOExecutados);
+          tempIdxTupla2 = 0;
+          if (tempPagina2.isEmpty())
+            break;
+        }
+        const Tupla &t2_temp = tempPagina2.tuplas[tempIdxTupla2];
+        if (valorIgual(getColunaValue(t2_temp, idxChave2), chaveAtual,
+                       chaveComoTexto)) {
+          blocoTabela2.push_back(t2_temp);
+          tempIdxTupla2++;
+        } else {
+          break;
         }
-        currentRunPage.adicionarTupla(tupla);
-      }
-      if (!currentRunPage.isEmpty()) {
-        escreverPaginaEmStream(runFileStream, currentRunPage,
-                               IOExecutados); // Escreve a última página do run
-      }
-      runFileStream.close();
-      runFiles.push_back(
-          runFileName); // paginasGeradas += (currentBlockTuplas.size() +
-                        // MAX_TUPLES_PER_PAGE - 1) / MAX_TUPLES_PER_PAGE// Já
-                        // contabilizado em escreverPaginaEmStream
-    }
-
-    // Fase 2: Merge dos Runs
-    if (runFiles.empty()) {
-      cout << "Nenhum run gerado para a tabela " << tabela.nomeArquivo << endl;
-      ofstream outFile(nomeArquivoSaida);
-      if (!tabela.col_names.empty()) {
-        outFile << headerLine << endl;
       }
-      outFile.close();
-      return;
+
+      // Agora, para cada tupla da tabela1 com a mesma chave, junte com todas
+      // do blocoTabela2
+      do {
+        for (const auto &t2_match : blocoTabela2) {
+          Tupla tuplaJuntada = currentPagina1.tuplas[idxTupla1];
+          tuplaJuntada.cols.insert(tuplaJuntada.cols.end(),
+                                   t2_match.cols.begin(), t2_match.cols.end());
+          emitirTupla(move(tuplaJuntada));
+        }
+        // Avança na tabela1 para a próxima tupla
+        idxTupla1++;
+        if (idxTupla1 >= currentPagina1.qtd_tuplas_ocup) {
+          currentPagina1 = lerPaginaDeStream(file1, IOExecutados);
+          idxTupla1 = 0;
+        }
+      } while (!currentPagina1.isEmpty() &&
+               valorIgual(getColunaValue(currentPagina1.tuplas[idxTupla1],
+                                         idxChave1),
+                          chaveAtual, chaveComoTexto));
+
+      // "Rebobinar" file2 para a posição antes do bloco de correspondência
+      file2.clear(); // Limpa quaisquer flags de erro
+      file2.seekg(file2_pos_before_match);
+      currentPagina2 = savedPagina2; // Restaura a página
+      idxTupla2 = savedIdxTupla2;    // Restaura o índice
     }
+  }
 
-    if (runFiles.size() == 1) {
-      if (rename(runFiles[0].c_str(), nomeArquivoSaida.c_str()) != 0) {
-        perror("Erro ao renomear arquivo do run");
-      }
-      cout << "Tabela " << tabela.nomeArquivo << " ordenada e salva em "
-           << nomeArquivoSaida << endl;
-      return;
+  file1.close();
+  file2.close();
+  cout << "Merge Join concluído. Tuplas geradas: " << tuplasGeradasCount
+       << endl;
+}
+
+// Implementação de hashJoin
+void Operador::hashJoin() {
+  cout << "Iniciando Hash Join entre " << tabela1.nomeArquivo << " e "
+       << tabela2.nomeArquivo << endl;
+  int idxChave1 = getIndexColuna(tabela1, chave1);
+  int idxChave2 = getIndexColuna(tabela2, chave2);
+  if (idxChave1 == -1 || idxChave2 == -1) {
+    cerr << "Erro: Chave de junção não encontrada em uma das tabelas."
+         << endl;
+    return;
+  }
+
+  // Um prefixo por lado: numa autojunção as duas tabelas têm o mesmo nome
+  juntarParticoes(arquivosDePaginas(tabela1), arquivosDePaginas(tabela2),
+                  tabela1.qtd_pags, tabela2.qtd_pags,
+                  tabela1.nomeArquivo + "_hash_e",
+                  tabela2.nomeArquivo + "_hash_d", 0);
+  cout << "Hash Join concluído. Tuplas geradas: " << tuplasGeradasCount
+       << endl;
+}
+
+// Junta duas entradas (listas de arquivos de páginas) que têm pags1 e pags2
+// páginas. Se a menor couber na memória junto com uma página de entrada e
+// uma de saída, a junção é feita em memória; senão as duas são divididas em
+// paginasMemoria - 1 partições pelo hash da chave e cada par de partições é
+// juntado recursivamente, com outra função de hash.
+void Operador::juntarParticoes(const vector<string> &arqs1,
+                               const vector<string> &arqs2, int pags1,
+                               int pags2, const string &prefixo1,
+                               const string &prefixo2, int nivel) {
+  bool construirComPrimeira = pags1 <= pags2;
+  int pagsConstrucao = construirComPrimeira ? pags1 : pags2;
+  if (pagsConstrucao <= paginasMemoria - 2 || nivel >= MAX_NIVEL_PARTICAO) {
+    if (pagsConstrucao > paginasMemoria - 2) {
+      cerr << "Aviso: Partição de " << pagsConstrucao
+           << " páginas não coube na memória após " << nivel
+           << " particionamentos; juntando em memória." << endl;
     }
+    juntarEmMemoria(arqs1, arqs2, construirComPrimeira);
+    return;
+  }
 
-    // K-way merge
-    // Comparador para o min-heap
-    auto compareTuplas = [&](pair<Tupla, int> a, pair<Tupla, int> b) {
-      return getColunaValue(a.first, indiceChave) >
-             getColunaValue(b.first, indiceChave);
-    };
-    priority_queue<pair<Tupla, int>, vector<pair<Tupla, int>>,
-                   decltype(compareTuplas)>
-        minHeap(compareTuplas);
-
-    vector<ifstream> inputRunFiles(runFiles.size());
-    vector<Pagina> currentRunPages(runFiles.size());
-    vector<int> currentTupleIndexInPage(runFiles.size(), 0);
-
-    // Abrir todos os arquivos de run e ler a primeira página de cada um
-    for (size_t i = 0; i < runFiles.size(); ++i) {
-      inputRunFiles[i].open(runFiles[i]);
-      if (!inputRunFiles[i].is_open()) {
-        cerr << "Erro ao abrir run file para merge: " << runFiles[i] << endl;
-        return;
-      }
-      // Pular cabeçalho se existir
-      if (!tabela.col_names.empty()) {
-        string tempHeader;
-        getline(inputRunFiles[i], tempHeader);
-      }
+  cout << "Particionando entradas (nível " << nivel << ") em "
+       << paginasMemoria - 1 << " partições" << endl;
+  int numParticoes = paginasMemoria - 1;
+  vector<int> paginas1 =
+      particionar(arqs1, getIndexColuna(tabela1, chave1), prefixo1, nivel,
+                  numParticoes);
+  vector<int> paginas2 =
+      particionar(arqs2, getIndexColuna(tabela2, chave2), prefixo2, nivel,
+                  numParticoes);
 
-      currentRunPages[i] = lerPaginaDeStream(
-          inputRunFiles[i], IOExecutados); // Lê a primeira página
-      if (!currentRunPages[i].isEmpty()) {
-        minHeap.push({currentRunPages[i].tuplas[0], i});
-        currentTupleIndexInPage[i]++;
-      } else {
-        inputRunFiles[i].close();
-      }
+  for (int i = 0; i < numParticoes; ++i) {
+    string particao1 = prefixo1 + "_" + to_string(i) + ".tmp";
+    string particao2 = prefixo2 + "_" + to_string(i) + ".tmp";
+    // Partição vazia de um lado: o outro lado não precisa ser lido
+    if (paginas1[i] > 0 && paginas2[i] > 0) {
+      juntarParticoes({particao1}, {particao2}, paginas1[i], paginas2[i],
+                      prefixo1 + "_" + to_string(i),
+                      prefixo2 + "_" + to_string(i), nivel + 1);
     }
+    remove(particao1.c_str());
+    remove(particao2.c_str());
+  }
+}
 
-    ofstream outputFileStream(nomeArquivoSaida);
-    if (!outputFileStream.is_open()) {
-      cerr << "Erro ao criar arquivo de saída para merge final: "
-           << nomeArquivoSaida << endl;
-      return;
+// Distribui as tuplas dos arquivos nas partições <prefixo>_<i>.tmp (ver
+// Particionador). Devolve o número de páginas de cada partição.
+vector<int> Operador::particionar(const vector<string> &arquivos,
+                                  int indiceChave, const string &prefixo,
+                                  int nivel, int numParticoes) {
+  Particionador particionador;
+  if (!particionador.abrir(prefixo, numParticoes, indiceChave, chaveComoTexto,
+                           nivel, &IOExecutados)) {
+    particionador.fechar();
+    return vector<int>(numParticoes, 0);
+  }
+
+  for (const string &arquivo : arquivos) {
+    ifstream entrada(arquivo, ios::binary);
+    if (!entrada.is_open()) {
+      cerr << "Erro ao abrir arquivo de página: " << arquivo << endl;
+      continue;
     }
-    // Escrever cabeçalho no arquivo de saída final
-    if (!tabela.col_names.empty()) {
-      outputFileStream << headerLine << endl;
+    Pagina p;
+    while (!(p = lerPaginaDeStream(entrada, IOExecutados)).isEmpty()) {
+      for (int j = 0; j < p.qtd_tuplas_ocup; ++j)
+        particionador.adicionar(move(p.tuplas[j]));
     }
+  }
+
+  if (!particionador.fechar()) {
+    cerr << "Erro ao gravar as partições de " << prefixo << endl;
+  }
+  for (int paginas : particionador.paginas())
+    paginasGeradas += paginas;
+  return particionador.paginas();
+}
 
-    Pagina outputPage; // Página de saída para o arquivo final
-    while (!minHeap.empty()) {
-      pair<Tupla, int> top = minHeap.top();
-      minHeap.pop();
+// Carrega a entrada de construção numa tabela hash e percorre a outra página
+// a página. O resultado mantém as colunas de tabela1 antes das de tabela2.
+void Operador::juntarEmMemoria(const vector<string> &arqs1,
+                               const vector<string> &arqs2,
+                               bool construirComPrimeira) {
+  const vector<string> &arqsConstrucao = construirComPrimeira ? arqs1 : arqs2;
+  const vector<string> &arqsSondagem = construirComPrimeira ? arqs2 : arqs1;
+  int idxConstrucao = construirComPrimeira ? getIndexColuna(tabela1, chave1)
+                                           : getIndexColuna(tabela2, chave2);
+  int idxSondagem = construirComPrimeira ? getIndexColuna(tabela2, chave2)
+                                         : getIndexColuna(tabela1, chave1);
 
-      if (outputPage.isFull()) {
-        escreverPaginaEmStream(outputFileStream, outputPage,
-                               IOExecutados); // Escreve página cheia
-        paginasGeradas++;                     // Contabiliza página gerada
-        outputPage = Pagina();                // Reseta a página
+  vector<Tupla> construcao;
+  unordered_multimap<size_t, size_t> tabelaHash; // hash da chave -> tupla
+  for (const string &arquivo : arqsConstrucao) {
+    ifstream entrada(arquivo, ios::binary);
+    if (!entrada.is_open()) {
+      cerr << "Erro ao abrir arquivo de página: " << arquivo << endl;
+      continue;
+    }
+    Pagina p;
+    while (!(p = lerPaginaDeStream(entrada, IOExecutados)).isEmpty()) {
+      for (int j = 0; j < p.qtd_tuplas_ocup; ++j) {
+        tabelaHash.emplace(hashValor(getColunaValue(p.tuplas[j], idxConstrucao),
+                                     chaveComoTexto),
+                           construcao.size());
+        construcao.push_back(p.tuplas[j]);
       }
-      outputPage.adicionarTupla(top.first);
-
-      int runIndex = top.second;
-      if (currentTupleIndexInPage[runIndex] <
-          currentRunPages[runIndex].qtd_tuplas_ocup) {
-        // Ainda há tuplas na página atual do run
-        minHeap.push({currentRunPages[runIndex]
-                          .tuplas[currentTupleIndexInPage[runIndex]],
-                      runIndex});
-        currentTupleIndexInPage[runIndex]++;
-      } else if (inputRunFiles[runIndex].is_open()) {
-        // A página atual do run terminou, tentar ler a próxima página
-        currentRunPages[runIndex] =
-            lerPaginaDeStream(inputRunFiles[runIndex], IOExecutados);
-        currentTupleIndexInPage[runIndex] = 0;
-        if (!currentRunPages[runIndex].isEmpty()) {
-          minHeap.push({currentRunPages[runIndex].tuplas[0], runIndex});
-          currentTupleIndexInPage[runIndex]++;
-        } else {
-          inputRunFiles[runIndex].close(); // Fim do run
+    }
+  }
+  if (construcao.empty()) {
+    return; // Nada a juntar: a outra entrada nem é lida
+  }
+
+  for (const string &arquivo : arqsSondagem) {
+    ifstream entrada(arquivo, ios::binary);
+    if (!entrada.is_open()) {
+      cerr << "Erro ao abrir arquivo de página: " << arquivo << endl;
+      continue;
+    }
+    Pagina p;
+    while (!(p = lerPaginaDeStream(entrada, IOExecutados)).isEmpty()) {
+      for (int j = 0; j < p.qtd_tuplas_ocup; ++j) {
+        const Tupla &sondagem = p.tuplas[j];
+        const Valor &chave = getColunaValue(sondagem, idxSondagem);
+        auto faixa = tabelaHash.equal_range(hashValor(chave, chaveComoTexto));
+        for (auto it = faixa.first; it != faixa.second; ++it) {
+          const Tupla &encontrada = construcao[it->second];
+          if (!valorIgual(getColunaValue(encontrada, idxConstrucao), chave,
+                          chaveComoTexto))
+            continue;
+          const Tupla &t1 = construirComPrimeira ? encontrada : sondagem;
+          const Tupla &t2 = construirComPrimeira ? sondagem : encontrada;
+          Tupla tuplaJuntada = t1;
+          tuplaJuntada.cols.insert(tuplaJuntada.cols.end(), t2.cols.begin(),
+                                   t2.cols.end());
+          emitirTupla(move(tuplaJuntada));
         }
       }
     }
-    if (!outputPage.isEmpty()) {
-      escreverPaginaEmStream(outputFileStream, outputPage,
-                             IOExecutados); // Escreve a última página
-      paginasGeradas++;                     // Contabiliza página gerada
-    }
-    outputFileStream.close();
+  }
+}
 
-    // Remover arquivos de run temporários
-    for (const string &runFile : runFiles) {
-      remove(runFile.c_str());
+// Implementação de indexNestedLoopJoin
+//
+// O índice fica em data/<tabela2>/indice_<chave2>.txt, com entradas
+// (chave, página * MAX_TUPLES_PER_PAGE + posição na página), e é reconstruído
+// por carga em bloco quando não existe ou é mais antigo que as páginas da
+// tabela. A tabela1 é lida em lotes de paginasMemoria - 2 páginas (uma fica
+// para a página de tabela2 e outra para a saída); as chaves do lote são
+// consultadas em ordem, e as tuplas encontradas são buscadas em ordem de
+// página, de forma que cada página de tabela2 é lida no máximo uma vez por
+// lote. Os nós do índice lidos nas consultas entram em IOExecutados.
+void Operador::indexNestedLoopJoin() {
+  cout << "Iniciando Index Nested-Loop Join entre " << tabela1.nomeArquivo
+       << " e " << tabela2.nomeArquivo << endl;
+  int idxChave1 = getIndexColuna(tabela1, chave1);
+  int idxChave2 = getIndexColuna(tabela2, chave2);
+  if (idxChave1 == -1 || idxChave2 == -1) {
+    cerr << "Erro: Chave de junção não encontrada em uma das tabelas."
+         << endl;
+    return;
+  }
+  if (tabela2.col_tipos[idxChave2] != TipoColuna::INTEIRO) {
+    cerr << "Aviso: A árvore B+ só indexa chaves inteiras e " << chave2
+         << " é " << nomeTipo(tabela2.col_tipos[idxChave2])
+         << "; usando junção hash." << endl;
+    algoritmoExecutado = AlgoritmoJuncao::HASH;
+    hashJoin();
+    return;
+  }
+
+  string arquivoIndice = arquivoDoIndice(tabela2, chave2);
+  bool reconstruir = !indiceAtualizado(tabela2, arquivoIndice);
+
+  vector<pair<int, RecordPointer>> entradas;
+  if (reconstruir) {
+    for (int numero = 0; numero < tabela2.qtd_pags; ++numero) {
+      ifstream entrada(arquivoDaPagina(tabela2, numero), ios::binary);
+      Pagina p = lerPaginaDeStream(entrada, IOExecutados);
+      for (int j = 0; j < p.qtd_tuplas_ocup; ++j) {
+        const Valor &valor = getColunaValue(p.tuplas[j], idxChave2);
+        int chave;
+        if (!holds_alternative<long long>(valor) ||
+            !chaveInteira(valor, chave)) {
+          cerr << "Aviso: Valor " << valorParaTexto(valor) << " de " << chave2
+               << " não cabe numa chave da árvore B+; usando junção hash."
+               << endl;
+          algoritmoExecutado = AlgoritmoJuncao::HASH;
+          hashJoin();
+          return;
+        }
+        entradas.push_back(
+            {chave, static_cast<RecordPointer>(numero) * MAX_TUPLES_PER_PAGE +
+                        j});
+      }
     }
+    sort(entradas.begin(), entradas.end());
+    remove(arquivoIndice.c_str());
+    cout << "Construindo índice " << arquivoIndice << " com "
+         << entradas.size() << " entradas" << endl;
+  }
 
-    cout << "Tabela " << tabela.nomeArquivo << " ordenada e salva em "
-         << nomeArquivoSaida << endl;
+  BPlusTree arvore(0, arquivoIndice, tabela2.nomeArquivo,
+                   TAMANHO_PAGINA_BYTES);
+  if (reconstruir && !arvore.bulkLoad(entradas)) {
+    cerr << "Erro: Não foi possível construir o índice " << arquivoIndice
+         << endl;
+    return;
   }
+  long long nosLidosAntes = arvore.getStats().nodeReads;
 
-  // Implementação de mergeJoin
-  void Operador::mergeJoin(const string &arq1Ordenado,
-                           const string &arq2Ordenado) {
-    cout << "Iniciando Merge Join entre " << arq1Ordenado << " e "
-         << arq2Ordenado << endl;
+  vector<string> paginas1 = arquivosDePaginas(tabela1);
+  size_t paginasPorLote = static_cast<size_t>(max(1, paginasMemoria - 2));
+  for (size_t inicio = 0; inicio < paginas1.size(); inicio += paginasPorLote) {
+    vector<Tupla> lote;
+    for (size_t i = inicio; i < min(paginas1.size(), inicio + paginasPorLote);
+         ++i) {
+      ifstream entrada(paginas1[i], ios::binary);
+      Pagina p = lerPaginaDeStream(entrada, IOExecutados);
+      for (int j = 0; j < p.qtd_tuplas_ocup; ++j) {
+        lote.push_back(p.tuplas[j]);
+      }
+    }
 
-    ifstream file1(arq1Ordenado);
-    ifstream file2(arq2Ordenado);
+    // Consultas em ordem de chave: chaves repetidas no lote são consultadas
+    // uma vez, e descidas vizinhas reaproveitam o nó em buffer da árvore
+    vector<pair<int, size_t>> consultas; // (chave, tupla do lote)
+    for (size_t i = 0; i < lote.size(); ++i) {
+      int chave;
+      if (chaveInteira(getColunaValue(lote[i], idxChave1), chave)) {
+        consultas.push_back({chave, i});
+      }
+    }
+    sort(consultas.begin(), consultas.end());
 
-    if (!file1.is_open()) {
-      cerr << "Erro ao abrir arquivo ordenado: " << arq1Ordenado << endl;
-      return;
+    vector<pair<RecordPointer, size_t>> encontrados; // (posição, tupla do lote)
+    vector<RecordPointer> posicoes;
+    for (size_t i = 0; i < consultas.size(); ++i) {
+      if (i == 0 || consultas[i].first != consultas[i - 1].first) {
+        posicoes = arvore.search(consultas[i].first);
+      }
+      for (RecordPointer posicao : posicoes) {
+        encontrados.push_back({posicao, consultas[i].second});
+      }
     }
-    if (!file2.is_open()) {
-      cerr << "Erro ao abrir arquivo ordenado: " << arq2Ordenado << endl;
-      return;
+    sort(encontrados.begin(), encontrados.end());
+
+    long long numeroAtual = -1;
+    Pagina paginaAtual;
+    for (const auto &encontrado : encontrados) {
+      long long numero = encontrado.first / MAX_TUPLES_PER_PAGE;
+      int posicao = static_cast<int>(encontrado.first % MAX_TUPLES_PER_PAGE);
+      if (numero != numeroAtual) {
+        ifstream entrada(arquivoDaPagina(tabela2, numero), ios::binary);
+        paginaAtual = lerPaginaDeStream(entrada, IOExecutados);
+        numeroAtual = numero;
+      }
+      if (posicao >= paginaAtual.qtd_tuplas_ocup)
+        continue; // Índice desatualizado
+      const Tupla &t1 = lote[encontrado.second];
+      const Tupla &t2 = paginaAtual.tuplas[posicao];
+      if (!valorIgual(getColunaValue(t1, idxChave1),
+                      getColunaValue(t2, idxChave2), chaveComoTexto))
+        continue;
+      Tupla tuplaJuntada = t1;
+      tuplaJuntada.cols.insert(tuplaJuntada.cols.end(), t2.cols.begin(),
+                               t2.cols.end());
+      emitirTupla(move(tuplaJuntada));
     }
+  }
+  IOExecutados += static_cast<int>(arvore.getStats().nodeReads - nosLidosAntes);
 
-    string header1, header2;
+  cout << "Index Nested-Loop Join concluído. Tuplas geradas: "
+       << tuplasGeradasCount << endl;
+}
 
-    // Ler cabeçalhos
-    if (!tabela1.col_names.empty())
-      getline(file1, header1);
-    if (!tabela2.col_names.empty())
-      getline(file2, header2);
+// Implementação de blockNestedLoopJoin
+//
+// A tabela com menos páginas fica por fora, lida em blocos de
+// paginasMemoria - 2 páginas (uma fica para a página da outra tabela e outra
+// para a saída); a outra tabela é lida inteira uma vez por bloco. As chaves do
+// bloco vão para uma tabela hash, para não comparar cada par de tuplas.
+void Operador::blockNestedLoopJoin() {
+  cout << "Iniciando Block Nested-Loop Join entre " << tabela1.nomeArquivo
+       << " e " << tabela2.nomeArquivo << endl;
+  int idxChave1 = getIndexColuna(tabela1, chave1);
+  int idxChave2 = getIndexColuna(tabela2, chave2);
+  if (idxChave1 == -1 || idxChave2 == -1) {
+    cerr << "Erro: Chave de junção não encontrada em uma das tabelas."
+         << endl;
+    return;
+  }
+  bool primeiraPorFora = tabela1.qtd_pags <= tabela2.qtd_pags;
+  vector<string> paginasExternas =
+      arquivosDePaginas(primeiraPorFora ? tabela1 : tabela2);
+  vector<string> paginasInternas =
+      arquivosDePaginas(primeiraPorFora ? tabela2 : tabela1);
+  int idxExterna = primeiraPorFora ? idxChave1 : idxChave2;
+  int idxInterna = primeiraPorFora ? idxChave2 : idxChave1;
 
-    int idxChave1 = getIndexColuna(tabela1, chave1);
-    int idxChave2 = getIndexColuna(tabela2, chave2);
+  size_t paginasPorBloco = static_cast<size_t>(max(1, paginasMemoria - 2));
+  for (size_t inicio = 0; inicio < paginasExternas.size();
+       inicio += paginasPorBloco) {
+    vector<Tupla> bloco;
+    unordered_multimap<size_t, size_t> tabelaHash; // hash da chave -> tupla
+    for (size_t i = inicio;
+         i < min(paginasExternas.size(), inicio + paginasPorBloco); ++i) {
+      ifstream entrada(paginasExternas[i], ios::binary);
+      Pagina p = lerPaginaDeStream(entrada, IOExecutados);
+      for (int j = 0; j < p.qtd_tuplas_ocup; ++j) {
+        tabelaHash.emplace(hashValor(getColunaValue(p.tuplas[j], idxExterna),
+                                     chaveComoTexto),
+                           bloco.size());
+        bloco.push_back(p.tuplas[j]);
+      }
+    }
+    if (bloco.empty())
+      continue;
 
-    if (idxChave1 == -1 || idxChave2 == -1) {
-      cerr << "Erro: Chave de junção não encontrada em uma das tabelas."
-           << endl;
-      file1.close();
-      file2.close();
-      return;
+    for (const string &arquivo : paginasInternas) {
+      ifstream entrada(arquivo, ios::binary);
+      Pagina p = lerPaginaDeStream(entrada, IOExecutados);
+      for (int j = 0; j < p.qtd_tuplas_ocup; ++j) {
+        const Tupla &interna = p.tuplas[j];
+        const Valor &chave = getColunaValue(interna, idxInterna);
+        auto faixa =
+            tabelaHash.equal_range(hashValor(chave, chaveComoTexto));
+        for (auto it = faixa.first; it != faixa.second; ++it) {
+          const Tupla &externa = bloco[it->second];
+          if (!valorIgual(getColunaValue(externa, idxExterna), chave,
+                          chaveComoTexto))
+            continue;
+          const Tupla &t1 = primeiraPorFora ? externa : interna;
+          const Tupla &t2 = primeiraPorFora ? interna : externa;
+          Tupla tuplaJuntada = t1;
+          tuplaJuntada.cols.insert(tuplaJuntada.cols.end(), t2.cols.begin(),
+                                   t2.cols.end());
+          emitirTupla(move(tuplaJuntada));
+        }
+      }
     }
+  }
+  cout << "Block Nested-Loop Join concluído. Tuplas geradas: "
+       << tuplasGeradasCount << endl;
+}
 
-    // Posições para "rebobinar" file2 em caso de duplicatas na tabela1
-    streampos file2_pos_before_match;
-    string file2_linha_before_match;
+const char *Operador::nomeAlgoritmo(AlgoritmoJuncao algoritmo) {
+  switch (algoritmo) {
+  case AlgoritmoJuncao::SORT_MERGE:
+    return "Sort-Merge";
+  case AlgoritmoJuncao::HASH:
+    return "Hash";
+  case AlgoritmoJuncao::INDICE:
+    return "Laço Aninhado com Índice";
+  case AlgoritmoJuncao::BLOCO_ANINHADO:
+    return "Laço Aninhado em Bloco";
+  case AlgoritmoJuncao::AUTOMATICO:
+    return "Automático";
+  }
+  return "";
+}
 
-    Pagina currentPagina1 = lerPaginaDeStream(file1, IOExecutados);
-    Pagina currentPagina2 = lerPaginaDeStream(file2, IOExecutados);
+// Carregar dados das tabelas se ainda não foram carregados
+// (Assumindo que carregarDados() preenche col_names e salva páginas em
+// disco)
+void Operador::carregarTabelas() {
+  if (tabela1.pags.empty())
+    tabela1.carregarDados();
+  if (tabela2.pags.empty())
+    tabela2.carregarDados();
+}
 
-    int idxTupla1 = 0;
-    int idxTupla2 = 0;
+// Implementação de estimarCustos
+vector<EstimativaCusto> Operador::estimarCustos() {
+  carregarTabelas();
+  int idxChave1 = getIndexColuna(tabela1, chave1);
+  int idxChave2 = getIndexColuna(tabela2, chave2);
 
-    Pagina outputPage; // Página de saída para o resultado da junção
+  EstatisticasEntrada e1, e2;
+  e1.paginas = tabela1.qtd_pags;
+  e1.tuplas = tabela1.qtdTuplas();
+  e1.distintos = distintos1 = tabela1.estimarValoresDistintos(idxChave1);
+  e2.paginas = tabela2.qtd_pags;
+  e2.tuplas = tabela2.qtdTuplas();
+  e2.distintos = distintos2 = tabela2.estimarValoresDistintos(idxChave2);
 
-    while (!currentPagina1.isEmpty() && !currentPagina2.isEmpty()) {
-      Tupla tupla1 = currentPagina1.tuplas[idxTupla1];
-      Tupla tupla2 = currentPagina2.tuplas[idxTupla2];
+  // A árvore B+ só indexa chaves inteiras
+  bool indiceDisponivel =
+      idxChave2 != -1 && tabela2.col_tipos[idxChave2] == TipoColuna::INTEIRO;
+  long long custoIdx = -1;
+  if (indiceDisponivel) {
+    custoIdx = custoIndice(
+        e1, e2, paginasMemoria,
+        indiceAtualizado(tabela2, arquivoDoIndice(tabela2, chave2)),
+        BPlusTree::orderForPageSize(TAMANHO_PAGINA_BYTES));
+  }
 
-      string valChave1 = getColunaValue(tupla1, idxChave1);
-      string valChave2 = getColunaValue(tupla2, idxChave2);
+  return {
+      {AlgoritmoJuncao::SORT_MERGE,
+       custoSortMerge(e1, e2, paginasMemoria,
+                      geracaoRuns == GeracaoRuns::SELECAO_SUBSTITUICAO)},
+      {AlgoritmoJuncao::HASH, custoHash(e1, e2, paginasMemoria)},
+      {AlgoritmoJuncao::BLOCO_ANINHADO,
+       custoBlocoAninhado(e1, e2, paginasMemoria)},
+      {AlgoritmoJuncao::INDICE, custoIdx},
+  };
+}
 
-      if (valChave1 < valChave2) {
-        idxTupla1++;
-        if (idxTupla1 >= currentPagina1.qtd_tuplas_ocup) {
-          currentPagina1 = lerPaginaDeStream(file1, IOExecutados);
-          idxTupla1 = 0;
-        }
-      } else if (valChave1 > valChave2) {
-        idxTupla2++;
-        if (idxTupla2 >= currentPagina2.qtd_tuplas_ocup) {
-          currentPagina2 = lerPaginaDeStream(file2, IOExecutados);
-          idxTupla2 = 0;
-        }
-      } else {
-        // Chaves iguais, fazer a junção
-        // Salvar a posição atual de file2 para "rebobinar" se houver duplicatas
-        // em tabela1
-        file2_pos_before_match = file2.tellg();
-        // Precisamos salvar o estado da página e o índice da tupla
-        Pagina savedPagina2 = currentPagina2;
-        int savedIdxTupla2 = idxTupla2;
-
-        vector<Tupla> blocoTabela2;
-        // Coleta todas as tuplas da tabela2 que correspondem à chave atual
-        int tempIdxTupla2 = idxTupla2;
-        Pagina tempPagina2 = currentPagina2;
-        while (true) {
-          if (tempIdxTupla2 >= tempPagina2.qtd_tuplas_ocup) {
-            tempPagina2 = lerPaginaDeStream(file2, IOExecutados);
-            tempIdxTupla2 = 0;
-            if (tempPagina2.isEmpty())
-              break;
-          }
-          Tupla t2_temp = tempPagina2.tuplas[tempIdxTupla2];
-          if (getColunaValue(t2_temp, idxChave2) == valChave1) {
-            blocoTabela2.push_back(t2_temp);
-            tempIdxTupla2++;
-          } else {
-            break;
-          }
-        }
+// Implementação de escolherAlgoritmo: o de menor custo estimado; em caso de
+// empate, o que aparece antes em estimarCustos
+static AlgoritmoJuncao
+algoritmoDeMenorCusto(const vector<EstimativaCusto> &estimativas) {
+  AlgoritmoJuncao escolhido = AlgoritmoJuncao::SORT_MERGE;
+  long long menorCusto = -1;
+  for (const EstimativaCusto &estimativa : estimativas) {
+    if (estimativa.io >= 0 &&
+        (menorCusto < 0 || estimativa.io < menorCusto)) {
+      menorCusto = estimativa.io;
+      escolhido = estimativa.algoritmo;
+    }
+  }
+  return escolhido;
+}
 
-        // Agora, para cada tupla da tabela1 com a mesma chave, junte com todas
-        // do blocoTabela2
-        string initial_valChave1 = valChave1;
-        do {
-          for (const auto &t2_match : blocoTabela2) {
-            vector<string> tuplaJuntada = currentPagina1.tuplas[idxTupla1].cols;
-            tuplaJuntada.insert(tuplaJuntada.end(), t2_match.cols.begin(),
-                                t2_match.cols.end());
-            tuplasGeradas.push_back(tuplaJuntada);
-            tuplasGeradasCount++;
-          }
-          // Avança na tabela1 para a próxima tupla
-          idxTupla1++;
-          if (idxTupla1 >= currentPagina1.qtd_tuplas_ocup) {
-            currentPagina1 = lerPaginaDeStream(file1, IOExecutados);
-            idxTupla1 = 0;
-          }
-          if (!currentPagina1.isEmpty()) {
-            tupla1 = currentPagina1.tuplas[idxTupla1];
-            valChave1 = getColunaValue(tupla1, idxChave1);
-          }
-        } while (!currentPagina1.isEmpty() && valChave1 == initial_valChave1);
-
-        // "Rebobinar" file2 para a posição antes do bloco de correspondência
-        file2.clear(); // Limpa quaisquer flags de erro
-        file2.seekg(file2_pos_before_match);
-        currentPagina2 = savedPagina2; // Restaura a página
-        idxTupla2 = savedIdxTupla2;    // Restaura o índice
-      }
+AlgoritmoJuncao Operador::escolherAlgoritmo() {
+  if (algoritmo != AlgoritmoJuncao::AUTOMATICO)
+    return algoritmo;
+  return algoritmoDeMenorCusto(estimarCustos());
+}
+
+// Implementação de explicar
+void Operador::explicar() {
+  // Após executar(), as estimativas são as da escolha do algoritmo: as de
+  // agora já veriam, por exemplo, o índice construído pela junção
+  bool executado = algoritmoExecutado != AlgoritmoJuncao::AUTOMATICO;
+  vector<EstimativaCusto> estimativas =
+      executado ? estimativasExecucao : estimarCustos();
+
+  cout << "Plano da junção " << tabela1.nomeArquivo << "." << chave1 << " = "
+       << tabela2.nomeArquivo << "." << chave2 << endl;
+  cout << "  " << tabela1.nomeArquivo << ": " << tabela1.qtd_pags
+       << " páginas, " << tabela1.qtdTuplas() << " tuplas, ~"
+       << distintos1 << " chaves distintas" << endl;
+  cout << "  " << tabela2.nomeArquivo << ": " << tabela2.qtd_pags
+       << " páginas, " << tabela2.qtdTuplas() << " tuplas, ~"
+       << distintos2 << " chaves distintas" << endl;
+  cout << "  Memória: " << paginasMemoria << " páginas" << endl;
+  cout << "  E/S estimadas:" << endl;
+  AlgoritmoJuncao escolhido =
+      executado ? algoritmoExecutado
+      : algoritmo != AlgoritmoJuncao::AUTOMATICO
+          ? algoritmo
+          : algoritmoDeMenorCusto(estimativas);
+  for (const EstimativaCusto &estimativa : estimativas) {
+    cout << "    " << (estimativa.algoritmo == escolhido ? "* " : "  ")
+         << nomeAlgoritmo(estimativa.algoritmo) << ": ";
+    if (estimativa.io < 0)
+      cout << "não se aplica (a árvore B+ só indexa chaves inteiras)";
+    else
+      cout << estimativa.io;
+    cout << endl;
+  }
+  if (!executado) {
+    cout << "  Algoritmo escolhido: " << nomeAlgoritmo(escolhido)
+         << " (ainda não executado)" << endl;
+    return;
+  }
+  cout << "  Algoritmo executado: " << nomeAlgoritmo(algoritmoExecutado);
+  for (const EstimativaCusto &estimativa : estimativas) {
+    if (estimativa.algoritmo == algoritmoExecutado && estimativa.io >= 0) {
+      cout << " | E/S estimadas: " << estimativa.io;
     }
+  }
+  cout << " | E/S executadas: " << numIOExecutados() << endl;
+  for (const PassoOrdenacao &passo : passosOrdenacao) {
+    cout << "    Ordenação de " << passo.tabela << ", passo " << passo.passo
+         << (passo.passo == 0 ? " (runs)" : " (merge)") << ": " << passo.runs
+         << " runs, " << passo.io << " E/S" << endl;
+  }
+}
 
-    file1.close();
-    file2.close();
-    // A contagem de paginasGeradas para a junção será feita quando as tuplas
-    // forem salvas em disco
-    cout << "Merge Join concluído. Tuplas geradas: " << tuplasGeradasCount
-         << endl;
+// Implementação de executar
+void Operador::executar() {
+  carregarTabelas();
+  // Colunas de junção de tipos diferentes com um lado texto são comparadas
+  // pelo texto, e o hash, a ordenação e o merge precisam seguir a mesma regra
+  int idxChave1 = getIndexColuna(tabela1, chave1);
+  int idxChave2 = getIndexColuna(tabela2, chave2);
+  if (idxChave1 != -1 && idxChave2 != -1) {
+    TipoColuna tipo1 = tabela1.col_tipos[idxChave1];
+    TipoColuna tipo2 = tabela2.col_tipos[idxChave2];
+    chaveComoTexto = tipo1 != tipo2 && (tipo1 == TipoColuna::TEXTO ||
+                                        tipo2 == TipoColuna::TEXTO);
   }
+  estimativasExecucao = estimarCustos();
+  algoritmoExecutado = algoritmo != AlgoritmoJuncao::AUTOMATICO
+                           ? algoritmo
+                           : algoritmoDeMenorCusto(estimativasExecucao);
+  cout << "Executando Junção " << nomeAlgoritmo(algoritmoExecutado) << "..."
+       << endl;
 
-  // Implementação de executar
-  void Operador::executar() {
-    cout << "Executando Junção Sort-Merge..." << endl;
-    string arq1Ordenado = tabela1.nomeArquivo + "_ordenado.csv";
-    string arq2Ordenado = tabela2.nomeArquivo + "_ordenado.csv";
+  // O resultado é gravado página a página durante a junção, sem ficar em
+  // memória
+  ofstream arquivoSaida;
+  if (!arquivoResultado.empty()) {
+    arquivoSaida.open(arquivoResultado);
+    if (arquivoSaida.is_open()) {
+      saidaResultado = &arquivoSaida;
+    } else {
+      cerr << "Erro ao criar o arquivo de saída: " << arquivoResultado << endl;
+    }
+  }
 
-    // Carregar dados das tabelas se ainda não foram carregados
-    // (Assumindo que carregarDados() preenche col_names e salva páginas em
-    // disco)
-    if (tabela1.pags.empty())
-      tabela1.carregarDados();
-    if (tabela2.pags.empty())
-      tabela2.carregarDados();
+  if (algoritmoExecutado == AlgoritmoJuncao::HASH) {
+    hashJoin();
+  } else if (algoritmoExecutado == AlgoritmoJuncao::INDICE) {
+    indexNestedLoopJoin();
+  } else if (algoritmoExecutado == AlgoritmoJuncao::BLOCO_ANINHADO) {
+    blockNestedLoopJoin();
+  } else {
+    string arq1Ordenado = tabela1.nomeArquivo + "_ordenado.pag";
+    string arq2Ordenado = tabela2.nomeArquivo + "_ordenado.pag";
+    if (arq2Ordenado == arq1Ordenado) // Autojunção: um arquivo por lado
+      arq2Ordenado = tabela2.nomeArquivo + "_ordenado_2.pag";
 
-    externalSort(tabela1, chave1, arq1Ordenado);
-    externalSort(tabela2, chave2, arq2Ordenado);
+    // As duas tabelas são ordenadas ao mesmo tempo, cada uma com os seus
+    // contadores, somados ao Operador depois
+    ContadoresOrdenacao ordenacao1, ordenacao2;
+    if (threads > 1) {
+      thread ordenarTabela1(
+          [&]() { externalSort(tabela1, chave1, arq1Ordenado, ordenacao1); });
+      externalSort(tabela2, chave2, arq2Ordenado, ordenacao2);
+      ordenarTabela1.join();
+    } else {
+      externalSort(tabela1, chave1, arq1Ordenado, ordenacao1);
+      externalSort(tabela2, chave2, arq2Ordenado, ordenacao2);
+    }
+    for (const ContadoresOrdenacao *ordenacao : {&ordenacao1, &ordenacao2}) {
+      IOExecutados += ordenacao->io;
+      paginasGeradas += ordenacao->paginasGeradas;
+      runsGerados += ordenacao->runs;
+      passosOrdenacao.insert(passosOrdenacao.end(), ordenacao->passos.begin(),
+                             ordenacao->passos.end());
+    }
 
     mergeJoin(arq1Ordenado, arq2Ordenado);
+  }
 
-    // Salvar as tuplas geradas da junção em um arquivo final
-    string nomeArquivoSaidaJuncao =
-        "resultado_juncao_" +
-        tabela1.nomeArquivo.substr(0, tabela1.nomeArquivo.find(".")) + "_" +
-        tabela2.nomeArquivo.substr(0, tabela2.nomeArquivo.find(".")) + ".csv";
-    salvarTuplasGeradas(nomeArquivoSaidaJuncao);
+  // Última página do resultado, possivelmente incompleta
+  descarregarResultado();
+  saidaResultado = nullptr;
+  if (arquivoSaida.is_open()) {
+    arquivoSaida.close();
+    cout << "Tuplas salvas em: " << arquivoResultado << endl;
+  }
 
-    cout << "Junção Sort-Merge concluída." << endl;
-  }
\ No newline at end of file
+  cout << "Junção " << nomeAlgoritmo(algoritmoExecutado) << " concluída."
+       << endl;
+}
\ No newline at end of file
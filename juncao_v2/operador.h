@@ -1,42 +1,151 @@
 #ifndef OPERADOR_H
 #define OPERADOR_H
 
+#include "ordenacao_externa.h"
 #include "tabela.h"
+#include <functional>
+#include <ostream>
 #include <string>
 #include <vector>
 
 using namespace std;
 
+// Páginas em memória disponíveis para o operador (ordenação e junção hash)
+const int MEMORY_LIMIT_PAGES = 4;
+
+// Algoritmo de junção por igualdade usado em executar()
+enum class AlgoritmoJuncao {
+  SORT_MERGE, // Ordenação externa das duas tabelas seguida do merge
+  HASH, // Tabela hash sobre a menor entrada; particiona em disco (Grace) se
+        // ela não couber na memória
+  INDICE, // Laço aninhado com índice: percorre tabela1 e consulta uma árvore
+          // B+ (BplusTree) sobre a coluna de junção de tabela2
+  BLOCO_ANINHADO, // Laço aninhado em bloco, com a menor tabela por fora
+  AUTOMATICO // O de menor custo estimado (ver Operador::estimarCustos)
+};
+
+// Um passo da ordenação externa: 0 é a geração dos runs, os demais são os
+// passos de merge
+struct PassoOrdenacao {
+  string tabela;
+  int passo;
+  int runs; // Runs ao final do passo
+  int io;   // E/S executadas no passo
+};
+
+// Contadores de uma ordenação externa. Cada ordenação (e cada worker dentro
+// dela) conta nos seus, e os totais entram no Operador depois do join das
+// threads
+struct ContadoresOrdenacao {
+  int io = 0;
+  int paginasGeradas = 0; // Páginas do arquivo ordenado
+  int runs = 0;           // Runs iniciais
+  vector<PassoOrdenacao> passos;
+};
+
+// Custo estimado de um algoritmo, em E/S de página
+struct EstimativaCusto {
+  AlgoritmoJuncao algoritmo;
+  long long io; // -1 se o algoritmo não se aplica à junção
+};
+
 class Operador {
 private:
   Tabela tabela1;
   Tabela tabela2;
   string chave1;
   string chave2;
+  AlgoritmoJuncao algoritmo;
+  AlgoritmoJuncao algoritmoExecutado = AlgoritmoJuncao::AUTOMATICO; // Após executar()
+  int paginasMemoria = MEMORY_LIMIT_PAGES;
+  GeracaoRuns geracaoRuns = GeracaoRuns::SELECAO_SUBSTITUICAO;
+  int threads = 1; // Workers da ordenação externa
+  // Colunas de junção texto x número: hash, ordenação e merge pelo texto
+  bool chaveComoTexto = false;
 
-  vector<vector<string>> tuplasGeradas; // resultado da junção
+  // Resultado da junção: as tuplas passam por paginaResultado, que é
+  // descarregada no arquivo de resultado e no consumidor ao encher, de forma
+  // que a memória não cresce com o tamanho do resultado
+  Pagina paginaResultado;
+  string arquivoResultado;
+  ostream *saidaResultado = nullptr; // Arquivo aberto durante executar()
+  function<void(const Tupla &)> consumidor;
 
   int paginasGeradas = 0;
   int IOExecutados = 0;
   int tuplasGeradasCount = 0;
+  int runsGerados = 0; // Runs iniciais das ordenações externas
+  vector<PassoOrdenacao> passosOrdenacao;
+
+  // Estimativas com que executar() escolheu o algoritmo, mostradas depois por
+  // explicar(), e as chaves distintas contadas pelo último estimarCustos()
+  vector<EstimativaCusto> estimativasExecucao;
+  long long distintos1 = 0;
+  long long distintos2 = 0;
 
   // Métodos auxiliares
-  void externalSort(Tabela &tabela, const string &chave,
-                    const string &nomeArquivoSaida);
+  void externalSort(const Tabela &tabela, const string &chave,
+                    const string &nomeArquivoSaida,
+                    ContadoresOrdenacao &contadores) const;
+  bool gerarRuns(const vector<string> &pageFiles, const string &prefixo,
+                 int indiceChave, vector<string> &runFiles, int &io) const;
+  int mergeParalelo(const vector<string> &runFiles,
+                    const string &nomeArquivoSaida, int indiceChave,
+                    size_t numWorkers, int &io) const;
   void mergeJoin(const string &arq1, const string &arq2);
+  void hashJoin();
+  void blockNestedLoopJoin();
+  void carregarTabelas();
+  void juntarParticoes(const vector<string> &arqs1,
+                       const vector<string> &arqs2, int pags1, int pags2,
+                       const string &prefixo1, const string &prefixo2,
+                       int nivel);
+  void juntarEmMemoria(const vector<string> &arqs1,
+                       const vector<string> &arqs2, bool construirComPrimeira);
+  void indexNestedLoopJoin();
+  vector<int> particionar(const vector<string> &arquivos, int indiceChave,
+                          const string &prefixo, int nivel, int numParticoes);
   int getIndexColuna(const Tabela &tabela, const string &chave) const;
+  void emitirTupla(Tupla &&tupla);
+  void descarregarResultado();
 
 public:
   Operador(const Tabela &t1, const Tabela &t2, const string &chave1,
-           const string &chave2);
+           const string &chave2,
+           AlgoritmoJuncao algoritmo = AlgoritmoJuncao::AUTOMATICO);
+
+  // Páginas de memória do operador (mínimo 3); o padrão é MEMORY_LIMIT_PAGES
+  void definirPaginasMemoria(int paginas);
+  // Geração dos runs da ordenação externa; o padrão é SELECAO_SUBSTITUICAO
+  void definirGeracaoRuns(GeracaoRuns geracao);
+  // Threads da ordenação externa (geração dos runs, passos de merge e as
+  // duas tabelas ao mesmo tempo); o padrão é 1, em que os runs, as E/S e as
+  // páginas geradas são os do modelo de custo e não dependem da máquina. A
+  // memória de paginasMemoria vale para cada worker.
+  void definirThreads(int numThreads);
+  // CSV em que executar() grava o resultado; o padrão é
+  // resultado_juncao_<tabela1>_<tabela2>.csv e um nome vazio não grava nada
+  void definirArquivoResultado(const string &nomeArquivo);
+  // Chamado com cada tupla do resultado, página a página, durante
+  // executar(); com definirArquivoResultado("") o resultado não vai a disco
+  void definirConsumidor(function<void(const Tupla &)> consumidor);
+
+  void executar(); // realiza a junção com o algoritmo escolhido
 
-  void executar(); // realiza a junção sort-merge
-  void imprimirTuplasGeradas() const;
-  void salvarTuplasGeradas(const string &nomeArquivo) const;
+  // Estimativas de E/S de cada algoritmo, a partir do número de páginas e de
+  // tuplas das tabelas, das chaves distintas e da memória do operador
+  vector<EstimativaCusto> estimarCustos();
+  AlgoritmoJuncao escolherAlgoritmo();
+  // Imprime as estimativas e, após executar(), o algoritmo usado e as E/S
+  // realmente executadas
+  void explicar();
+  static const char *nomeAlgoritmo(AlgoritmoJuncao algoritmo);
 
   int numPagsGeradas() const;
   int numIOExecutados() const;
   int numTuplasGeradas() const;
+  int numRunsGerados() const;
+  const vector<PassoOrdenacao> &passosDaOrdenacao() const;
 };
 
 #endif
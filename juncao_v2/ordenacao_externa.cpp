@@ -0,0 +1,333 @@
+#include "ordenacao_externa.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+FonteDeTuplas fonteDeArquivos(const vector<string> &arquivos, int &io,
+                              bool &erro) {
+  struct Leitura {
+    size_t proximoArquivo = 0;
+    ifstream arquivo;
+    Pagina pagina;
+    int posicao = 0;
+  };
+  auto leitura = make_shared<Leitura>();
+  return [&arquivos, &io, &erro, leitura](Tupla &tupla) {
+    while (leitura->posicao >= leitura->pagina.qtd_tuplas_ocup) {
+      if (leitura->arquivo.is_open()) {
+        leitura->pagina = lerPaginaDeStream(leitura->arquivo, io);
+        leitura->posicao = 0;
+        if (!leitura->pagina.isEmpty())
+          continue;
+        leitura->arquivo.close();
+      }
+      if (leitura->proximoArquivo >= arquivos.size())
+        return false;
+      const string &nome = arquivos[leitura->proximoArquivo++];
+      leitura->arquivo.clear();
+      leitura->arquivo.open(nome, ios::binary);
+      if (!leitura->arquivo.is_open()) {
+        cerr << "Erro ao abrir arquivo de página: " << nome << endl;
+        erro = true;
+      }
+    }
+    tupla = move(leitura->pagina.tuplas[leitura->posicao++]);
+    return true;
+  };
+}
+
+void executarEmParalelo(size_t numTarefas, int numThreads,
+                        const function<void(size_t)> &tarefa) {
+  size_t numWorkers = min(numTarefas, static_cast<size_t>(max(1, numThreads)));
+  if (numWorkers <= 1) {
+    for (size_t i = 0; i < numTarefas; ++i)
+      tarefa(i);
+    return;
+  }
+  atomic<size_t> proxima(0);
+  vector<thread> workers;
+  for (size_t w = 0; w < numWorkers; ++w) {
+    workers.emplace_back([&]() {
+      for (size_t i = proxima++; i < numTarefas; i = proxima++)
+        tarefa(i);
+    });
+  }
+  for (thread &worker : workers)
+    worker.join();
+}
+
+// IntercaladorDeRuns
+
+bool IntercaladorDeRuns::abrir(const vector<string> &runs, int indice,
+                               int *contadorIO, bool comoTexto) {
+  vector<TrechoDeRun> inteiros;
+  for (const string &run : runs)
+    inteiros.push_back({run, 0, LLONG_MAX});
+  return abrir(inteiros, indice, contadorIO, comoTexto);
+}
+
+bool IntercaladorDeRuns::abrir(const vector<TrechoDeRun> &novosTrechos,
+                               int indice, int *contadorIO, bool comoTexto) {
+  fechar();
+  trechos = novosTrechos;
+  indiceChave = indice;
+  io = contadorIO;
+  size_t k = trechos.size();
+  arquivos = vector<ifstream>(k);
+  paginas.assign(k, Pagina());
+  posicoes.assign(k, 0);
+  vector<const Valor *> chaves(k, nullptr);
+  for (size_t i = 0; i < k; ++i) {
+    arquivos[i].open(trechos[i].arquivo, ios::binary);
+    if (!arquivos[i].is_open()) {
+      cerr << "Erro ao abrir run file para merge: " << trechos[i].arquivo
+           << endl;
+      fechar();
+      return false;
+    }
+    posicoes[i] = trechos[i].inicio;
+    if (posicoes[i] < trechos[i].fim)
+      paginas[i] = lerPaginaNumero(
+          arquivos[i], posicoes[i] / MAX_TUPLES_PER_PAGE, *io);
+    chaves[i] = chaveDoTrecho(i);
+  }
+  arvore = ArvoreDePerdedores(k, comoTexto);
+  arvore.iniciar(chaves);
+  return true;
+}
+
+const Valor *IntercaladorDeRuns::chaveDoTrecho(size_t trecho) const {
+  int slot = static_cast<int>(posicoes[trecho] % MAX_TUPLES_PER_PAGE);
+  if (posicoes[trecho] >= trechos[trecho].fim ||
+      slot >= paginas[trecho].qtd_tuplas_ocup)
+    return nullptr; // Fim do trecho
+  return &getColunaValue(paginas[trecho].tuplas[slot], indiceChave);
+}
+
+Tupla *IntercaladorDeRuns::atual() {
+  if (arvore.vazia())
+    return nullptr;
+  size_t trecho = arvore.vencedor();
+  return &paginas[trecho]
+              .tuplas[static_cast<int>(posicoes[trecho] % MAX_TUPLES_PER_PAGE)];
+}
+
+void IntercaladorDeRuns::avancar() {
+  size_t trecho = arvore.vencedor();
+  long long numeroPagina = posicoes[trecho] / MAX_TUPLES_PER_PAGE;
+  int slot = static_cast<int>(posicoes[trecho] % MAX_TUPLES_PER_PAGE);
+  posicoes[trecho]++;
+  if (slot + 1 >= paginas[trecho].qtd_tuplas_ocup) {
+    // A página atual terminou: a próxima começa na posição seguinte
+    posicoes[trecho] = (numeroPagina + 1) * MAX_TUPLES_PER_PAGE;
+    paginas[trecho] = posicoes[trecho] < trechos[trecho].fim
+                          ? lerPaginaDeStream(arquivos[trecho], *io)
+                          : Pagina();
+  }
+  arvore.substituir(chaveDoTrecho(trecho));
+}
+
+void IntercaladorDeRuns::fechar() {
+  trechos.clear();
+  arquivos.clear();
+  paginas.clear();
+  posicoes.clear();
+  arvore = ArvoreDePerdedores(0);
+}
+
+// Geração dos runs
+
+bool gravarRun(vector<Tupla> &tuplas, const string &nomeRun, int &io) {
+  ofstream run(nomeRun, ios::binary);
+  if (!run.is_open()) {
+    cerr << "Erro ao criar arquivo de run: " << nomeRun << endl;
+    return false;
+  }
+  Pagina pagina;
+  for (Tupla &tupla : tuplas) {
+    if (!pagina.cabe(tupla)) {
+      escreverPaginaEmStream(run, pagina, io);
+      pagina = Pagina();
+    }
+    pagina.adicionarTupla(move(tupla));
+  }
+  escreverPaginaEmStream(run, pagina, io); // Última página do run
+  return static_cast<bool>(run);
+}
+
+bool gerarRunEmBloco(vector<Tupla> &bloco, const string &nomeRun,
+                     int indiceChave, bool comoTexto, int &io) {
+  // Ordena o bloco em memória, comparando os valores tipados da chave
+  sort(bloco.begin(), bloco.end(), [&](const Tupla &a, const Tupla &b) {
+    return valorMenor(getColunaValue(a, indiceChave),
+                      getColunaValue(b, indiceChave), comoTexto);
+  });
+  return gravarRun(bloco, nomeRun, io);
+}
+
+// A menor tupla do heap que ainda pertence ao run atual vai para a saída e a
+// próxima tupla da entrada ocupa o seu lugar; se a chave dela for menor que a
+// recém-gravada, ela fica marcada para o run seguinte. Os runs têm em média o
+// dobro do heap, e uma entrada já ordenada vira um único run.
+bool gerarRunsPorSubstituicao(const FonteDeTuplas &entrada, int paginasMemoria,
+                              const string &prefixoRuns, int indiceChave,
+                              bool comoTexto, vector<string> &runs, int &io) {
+  const size_t capacidade =
+      static_cast<size_t>(max(1, paginasMemoria - 2)) * MAX_TUPLES_PER_PAGE;
+
+  vector<Tupla> slots;
+  vector<int> runDoSlot;
+  vector<size_t> heap; // Índices de slots, menor (run, chave) no topo
+  auto depois = [&](size_t a, size_t b) {
+    if (runDoSlot[a] != runDoSlot[b])
+      return runDoSlot[a] > runDoSlot[b];
+    return valorMenor(getColunaValue(slots[b], indiceChave),
+                      getColunaValue(slots[a], indiceChave), comoTexto);
+  };
+
+  Tupla tupla;
+  while (slots.size() < capacidade && entrada(tupla)) {
+    heap.push_back(slots.size());
+    slots.push_back(move(tupla));
+    runDoSlot.push_back(0);
+  }
+  make_heap(heap.begin(), heap.end(), depois);
+
+  int runAtual = -1;
+  ofstream runFileStream;
+  Pagina currentRunPage;
+  while (!heap.empty()) {
+    pop_heap(heap.begin(), heap.end(), depois);
+    size_t slot = heap.back();
+
+    if (runDoSlot[slot] != runAtual) {
+      // Fecha o run atual e começa o próximo
+      if (runFileStream.is_open()) {
+        escreverPaginaEmStream(runFileStream, currentRunPage, io);
+        currentRunPage = Pagina();
+        if (!runFileStream)
+          return false;
+        runFileStream.close();
+      }
+      runAtual = runDoSlot[slot];
+      string runFileName = prefixoRuns + to_string(runs.size()) + ".tmp";
+      runFileStream.open(runFileName, ios::binary);
+      if (!runFileStream.is_open()) {
+        cerr << "Erro ao criar arquivo de run: " << runFileName << endl;
+        return false;
+      }
+      runs.push_back(runFileName);
+    }
+
+    if (!currentRunPage.cabe(slots[slot])) {
+      escreverPaginaEmStream(runFileStream, currentRunPage, io);
+      currentRunPage = Pagina();
+    }
+    currentRunPage.adicionarTupla(slots[slot]);
+
+    if (entrada(tupla)) {
+      bool proximoRun =
+          valorMenor(getColunaValue(tupla, indiceChave),
+                     getColunaValue(slots[slot], indiceChave), comoTexto);
+      slots[slot] = move(tupla);
+      runDoSlot[slot] = runAtual + (proximoRun ? 1 : 0);
+      push_heap(heap.begin(), heap.end(), depois);
+    } else {
+      heap.pop_back();
+    }
+  }
+  if (runFileStream.is_open()) {
+    escreverPaginaEmStream(runFileStream, currentRunPage, io);
+    if (!runFileStream)
+      return false;
+    runFileStream.close();
+  }
+  return true;
+}
+
+// Merge
+
+int intercalarTrechos(const vector<TrechoDeRun> &trechos, ofstream &saida,
+                      int indiceChave, bool comoTexto, int &io) {
+  IntercaladorDeRuns merge;
+  if (!merge.abrir(trechos, indiceChave, &io, comoTexto))
+    return -1;
+  int paginasGravadas = 0;
+  Pagina paginaSaida;
+  while (Tupla *tupla = merge.atual()) {
+    if (!paginaSaida.cabe(*tupla)) {
+      escreverPaginaEmStream(saida, paginaSaida, io); // Escreve página cheia
+      paginasGravadas++;
+      paginaSaida = Pagina();
+    }
+    paginaSaida.adicionarTupla(move(*tupla));
+    merge.avancar();
+  }
+  if (!paginaSaida.isEmpty()) {
+    escreverPaginaEmStream(saida, paginaSaida, io); // Escreve a última página
+    paginasGravadas++;
+  }
+  merge.fechar();
+  return saida ? paginasGravadas : -1;
+}
+
+int mergeRuns(const vector<string> &runs, const string &nomeArquivoSaida,
+              int indiceChave, bool comoTexto, int &io) {
+  ofstream saida(nomeArquivoSaida, ios::binary);
+  if (!saida.is_open()) {
+    cerr << "Erro ao criar arquivo de saída do merge: " << nomeArquivoSaida
+         << endl;
+    return -1;
+  }
+  vector<TrechoDeRun> trechos;
+  for (const string &run : runs)
+    trechos.push_back({run, 0, LLONG_MAX});
+  return intercalarTrechos(trechos, saida, indiceChave, comoTexto, io);
+}
+
+bool intercalarEmPassos(vector<string> &runs, size_t fanIn,
+                        const string &prefixo, int indiceChave, bool comoTexto,
+                        int numThreads, vector<PassoDeMerge> &passos) {
+  for (int passo = 1; runs.size() > fanIn; ++passo) {
+    size_t numGrupos = (runs.size() + fanIn - 1) / fanIn;
+    vector<string> proximosRuns;
+    for (size_t g = 0; g < numGrupos; ++g) {
+      proximosRuns.push_back(g * fanIn + 1 == runs.size()
+                                 ? runs[g * fanIn]
+                                 : prefixo + "_passo_" + to_string(passo) +
+                                       "_run_" + to_string(g) + ".tmp");
+    }
+    vector<int> ioDoGrupo(numGrupos, 0), resultadoDoGrupo(numGrupos, 0);
+    executarEmParalelo(numGrupos, numThreads, [&](size_t g) {
+      if (proximosRuns[g] == runs[g * fanIn])
+        return;
+      vector<string> grupo(runs.begin() + g * fanIn,
+                           runs.begin() + min(runs.size(), (g + 1) * fanIn));
+      resultadoDoGrupo[g] = mergeRuns(grupo, proximosRuns[g], indiceChave,
+                                      comoTexto, ioDoGrupo[g]);
+    });
+    int ioDoPasso = 0;
+    for (size_t g = 0; g < numGrupos; ++g) {
+      ioDoPasso += ioDoGrupo[g];
+      if (resultadoDoGrupo[g] < 0)
+        return false;
+    }
+
+    // Remover os runs temporários intercalados neste passo
+    for (const string &run : runs) {
+      if (find(proximosRuns.begin(), proximosRuns.end(), run) ==
+          proximosRuns.end())
+        remove(run.c_str());
+    }
+    passos.push_back({static_cast<int>(proximosRuns.size()), ioDoPasso});
+    runs = proximosRuns;
+  }
+  return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "arvore_perdedores.h"
+#include "pagina.h"
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Peças da ordenação externa, usadas pelo Operador (externalSort) e pela
+// Ordenacao dos planos: geração dos runs iniciais, merge de runs por árvore
+// de perdedores e passos de merge. Um run é um arquivo de páginas (ver
+// utils.h) em ordem da coluna indiceChave pela ordem de valorMenor; com
+// comoTexto, pela ordem do texto das chaves.
+
+// Geração dos runs iniciais da ordenação externa
+enum class GeracaoRuns {
+  BLOCOS, // Ordena blocos de paginasMemoria - 1 páginas: runs do tamanho do buffer
+  SELECAO_SUBSTITUICAO // Heap com substituição: runs de ~2x o heap em média
+};
+
+// Próxima tupla da entrada de uma ordenação, movida para tupla; false no fim
+using FonteDeTuplas = function<bool(Tupla &tupla)>;
+
+// Tuplas de todas as páginas dos arquivos, na ordem dos arquivos. Um arquivo
+// que não abre é pulado e marca erro.
+FonteDeTuplas fonteDeArquivos(const vector<string> &arquivos, int &io,
+                              bool &erro);
+
+// Executa tarefa(0), ..., tarefa(numTarefas - 1) num pool de até numThreads
+// workers: cada worker pega a próxima tarefa livre até acabarem. Com uma
+// thread (ou uma tarefa) tudo roda na thread atual.
+void executarEmParalelo(size_t numTarefas, int numThreads,
+                        const function<void(size_t)> &tarefa);
+
+// Trecho de um run: as tuplas nas posições [inicio, fim), em que a posição de
+// uma tupla é página * MAX_TUPLES_PER_PAGE + slot. Uma página que termina
+// antes de MAX_TUPLES_PER_PAGE tuplas (tuplas largas, ou o fim do run) passa
+// direto para a primeira posição da página seguinte.
+struct TrechoDeRun {
+  string arquivo;
+  long long inicio;
+  long long fim;
+};
+
+// K-way merge de runs, ou de trechos de runs, tupla a tupla, com uma página
+// em memória por run. A árvore de perdedores aponta para a chave da tupla
+// atual de cada run, dentro da página dele.
+class IntercaladorDeRuns {
+public:
+  bool abrir(const vector<string> &runs, int indiceChave, int *contadorIO,
+             bool comoTexto = false);
+  bool abrir(const vector<TrechoDeRun> &trechos, int indiceChave,
+             int *contadorIO, bool comoTexto = false);
+  // Menor tupla ainda não consumida, que pode ser movida antes de avancar();
+  // nullptr quando os runs acabam
+  Tupla *atual();
+  void avancar();
+  void fechar();
+
+private:
+  vector<TrechoDeRun> trechos;
+  vector<ifstream> arquivos;
+  vector<Pagina> paginas;
+  vector<long long> posicoes; // Posição da tupla atual de cada trecho
+  ArvoreDePerdedores arvore{0};
+  int indiceChave = 0;
+  int *io = nullptr;
+
+  const Valor *chaveDoTrecho(size_t trecho) const;
+};
+
+// Grava as tuplas, na ordem em que estão, no run nomeRun (movendo-as)
+bool gravarRun(vector<Tupla> &tuplas, const string &nomeRun, int &io);
+
+// Fase 1 em blocos: ordena o bloco em memória e o grava como um run
+bool gerarRunEmBloco(vector<Tupla> &bloco, const string &nomeRun,
+                     int indiceChave, bool comoTexto, int &io);
+
+// Fase 1 por seleção por substituição: um heap de paginasMemoria - 2 páginas
+// de tuplas, mais uma página de entrada e uma de saída. Os runs são gravados
+// em <prefixoRuns><n>.tmp e acrescentados a runs.
+bool gerarRunsPorSubstituicao(const FonteDeTuplas &entrada, int paginasMemoria,
+                              const string &prefixoRuns, int indiceChave,
+                              bool comoTexto, vector<string> &runs, int &io);
+
+// Merge dos trechos na posição atual de saida. Devolve as páginas gravadas,
+// ou -1 em caso de erro.
+int intercalarTrechos(const vector<TrechoDeRun> &trechos, ofstream &saida,
+                      int indiceChave, bool comoTexto, int &io);
+
+// Merge de runs inteiros em nomeArquivoSaida; devolve as páginas gravadas, ou
+// -1 em caso de erro
+int mergeRuns(const vector<string> &runs, const string &nomeArquivoSaida,
+              int indiceChave, bool comoTexto, int &io);
+
+// Um passo de merge de intercalarEmPassos
+struct PassoDeMerge {
+  int runs; // Runs ao final do passo
+  int io;
+};
+
+// Passos de merge de grupos de até fanIn runs (uma página de entrada por run
+// e uma de saída) até restarem no máximo fanIn runs, para o merge final de
+// quem chama. Os grupos de um passo são intercalados no pool de numThreads;
+// uma sobra de um run só segue para o próximo passo. Os runs intercalados
+// são apagados e os novos são <prefixo>_passo_<p>_run_<g>.tmp.
+bool intercalarEmPassos(vector<string> &runs, size_t fanIn,
+                        const string &prefixo, int indiceChave, bool comoTexto,
+                        int numThreads, vector<PassoDeMerge> &passos);
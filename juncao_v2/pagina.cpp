@@ -1,11 +1,99 @@
 #include "pagina.h"
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <sstream>
 
 using namespace std;
 
+namespace {
+const size_t CABECALHO_PAGINA = 4; // número de slots + início dos registros
+const size_t TAMANHO_SLOT = 4;     // deslocamento + tamanho
+
+enum MarcaTipo : uint8_t { MARCA_INTEIRO = 0, MARCA_REAL = 1, MARCA_TEXTO = 2 };
+
+void gravarU16(char *destino, uint16_t valor) {
+  memcpy(destino, &valor, sizeof(valor));
+}
+
+uint16_t lerU16(const char *origem) {
+  uint16_t valor;
+  memcpy(&valor, origem, sizeof(valor));
+  return valor;
+}
+
+size_t tamanhoRegistro(const Tupla &tupla) {
+  size_t tamanho = 2;
+  for (const Valor &valor : tupla.cols) {
+    const string *texto = get_if<string>(&valor);
+    tamanho += 1 + (texto ? 2 + texto->size() : 8);
+  }
+  return tamanho;
+}
+
+void gravarRegistro(char *destino, const Tupla &tupla) {
+  gravarU16(destino, static_cast<uint16_t>(tupla.cols.size()));
+  destino += 2;
+  for (const Valor &valor : tupla.cols) {
+    if (const long long *inteiro = get_if<long long>(&valor)) {
+      *destino++ = MARCA_INTEIRO;
+      memcpy(destino, inteiro, 8);
+      destino += 8;
+    } else if (const double *real = get_if<double>(&valor)) {
+      *destino++ = MARCA_REAL;
+      memcpy(destino, real, 8);
+      destino += 8;
+    } else {
+      const string &texto = get<string>(valor);
+      *destino++ = MARCA_TEXTO;
+      gravarU16(destino, static_cast<uint16_t>(texto.size()));
+      memcpy(destino + 2, texto.data(), texto.size());
+      destino += 2 + texto.size();
+    }
+  }
+}
+
+// false se o registro ultrapassar `fim`
+bool lerRegistro(const char *origem, const char *fim, Tupla &tupla) {
+  if (origem + 2 > fim)
+    return false;
+  uint16_t colunas = lerU16(origem);
+  origem += 2;
+  tupla.cols.clear();
+  tupla.cols.reserve(colunas);
+  for (uint16_t c = 0; c < colunas; ++c) {
+    if (origem + 1 > fim)
+      return false;
+    uint8_t marca = static_cast<uint8_t>(*origem++);
+    if (marca == MARCA_INTEIRO || marca == MARCA_REAL) {
+      if (origem + 8 > fim)
+        return false;
+      if (marca == MARCA_INTEIRO) {
+        long long inteiro;
+        memcpy(&inteiro, origem, 8);
+        tupla.cols.emplace_back(inteiro);
+      } else {
+        double real;
+        memcpy(&real, origem, 8);
+        tupla.cols.emplace_back(real);
+      }
+      origem += 8;
+    } else {
+      if (origem + 2 > fim)
+        return false;
+      uint16_t tamanho = lerU16(origem);
+      if (origem + 2 + tamanho > fim)
+        return false;
+      tupla.cols.emplace_back(string(origem + 2, tamanho));
+      origem += 2 + tamanho;
+    }
+  }
+  return true;
+}
+} // namespace
+
 void Pagina::adicionarTupla(const Tupla &tupla) {
   if (qtd_tuplas_ocup < 10) { // Verifica se há espaço na página
+    bytesRegistros += tamanhoRegistro(tupla);
     tuplas[qtd_tuplas_ocup] =
         tupla;         // Adiciona a tupla na próxima posição disponível
     qtd_tuplas_ocup++; // Incrementa o contador de tuplas ocupadas
@@ -14,29 +102,69 @@ void Pagina::adicionarTupla(const Tupla &tupla) {
   }
 }
 
+void Pagina::adicionarTupla(Tupla &&tupla) {
+  if (qtd_tuplas_ocup < MAX_TUPLES_PER_PAGE) {
+    bytesRegistros += tamanhoRegistro(tupla);
+    tuplas[qtd_tuplas_ocup++] = std::move(tupla);
+  } else {
+    cerr << "Erro: Página cheia, não é possível adicionar mais tuplas.\n";
+  }
+}
+
+bool Pagina::cabe(const Tupla &tupla) const {
+  return qtd_tuplas_ocup < MAX_TUPLES_PER_PAGE &&
+         CABECALHO_PAGINA + TAMANHO_SLOT * (qtd_tuplas_ocup + 1) +
+                 bytesRegistros + tamanhoRegistro(tupla) <=
+             TAMANHO_PAGINA_BYTES;
+}
+
+bool Pagina::cabeEmPaginaCheia(const Tupla &tupla) {
+  return CABECALHO_PAGINA +
+             MAX_TUPLES_PER_PAGE * (TAMANHO_SLOT + tamanhoRegistro(tupla)) <=
+         TAMANHO_PAGINA_BYTES;
+}
+
 const Tupla *Pagina::getTuplas() const {
   return tuplas.data(); // Retorna um ponteiro para o array de tuplas
 }
 
-std::string Pagina::toString() const {
-  std::string s = "";
+bool Pagina::serializar(char *destino) const {
+  size_t inicioRegistros = TAMANHO_PAGINA_BYTES;
+  size_t fimDiretorio = CABECALHO_PAGINA + TAMANHO_SLOT * qtd_tuplas_ocup;
   for (int i = 0; i < qtd_tuplas_ocup; ++i) {
-    s += tuplas[i].toString();
-    if (i < qtd_tuplas_ocup - 1) {
-      s += "\n"; // Delimitador entre tuplas dentro da página
-    }
+    size_t tamanho = tamanhoRegistro(tuplas[i]);
+    if (tamanho > inicioRegistros - fimDiretorio)
+      return false;
+    inicioRegistros -= tamanho;
+    gravarRegistro(destino + inicioRegistros, tuplas[i]);
+    gravarU16(destino + CABECALHO_PAGINA + TAMANHO_SLOT * i,
+              static_cast<uint16_t>(inicioRegistros));
+    gravarU16(destino + CABECALHO_PAGINA + TAMANHO_SLOT * i + 2,
+              static_cast<uint16_t>(tamanho));
   }
-  return s;
+  gravarU16(destino, static_cast<uint16_t>(qtd_tuplas_ocup));
+  gravarU16(destino + 2, static_cast<uint16_t>(inicioRegistros));
+  // Espaço livre zerado: o arquivo não carrega restos de memória
+  memset(destino + fimDiretorio, 0, inicioRegistros - fimDiretorio);
+  return true;
 }
 
-Pagina Pagina::fromString(const std::string &s) {
+Pagina Pagina::desserializar(const char *origem) {
   Pagina p;
-  std::istringstream iss(s); // Usar istringstream para facilitar o parsing
-  std::string line;
-  while (std::getline(iss, line, '\n') &&
-         p.qtd_tuplas_ocup < MAX_TUPLES_PER_PAGE) { // Delimitador entre tuplas
-    p.adicionarTupla(Tupla::fromString(line));
+  uint16_t slots = lerU16(origem);
+  if (slots > MAX_TUPLES_PER_PAGE)
+    return p;
+  for (uint16_t i = 0; i < slots; ++i) {
+    uint16_t deslocamento = lerU16(origem + CABECALHO_PAGINA + TAMANHO_SLOT * i);
+    uint16_t tamanho = lerU16(origem + CABECALHO_PAGINA + TAMANHO_SLOT * i + 2);
+    if (deslocamento + tamanho > TAMANHO_PAGINA_BYTES ||
+        !lerRegistro(origem + deslocamento, origem + deslocamento + tamanho,
+                     p.tuplas[p.qtd_tuplas_ocup])) {
+      cerr << "Erro: Página com slot " << i << " inválido." << endl;
+      break;
+    }
+    p.bytesRegistros += tamanho;
+    p.qtd_tuplas_ocup++;
   }
   return p;
 }
-
@@ -5,6 +5,17 @@
 
 const int MAX_TUPLES_PER_PAGE = 10;
 
+// Tamanho em disco de uma página (dados das tabelas, runs e arquivos
+// ordenados). Formato, com inteiros na ordem de bytes da máquina:
+//   [0, 2)            número de slots (tuplas)
+//   [2, 4)            início da área de registros, que cresce do fim da página
+//                     para o começo
+//   [4, 4 + 4 * n)    diretório de slots: (deslocamento, tamanho) em uint16
+//   registros         número de colunas (uint16) e, por coluna, uma marca de
+//                     tipo (1 byte) seguida de 8 bytes (inteiro/real) ou de um
+//                     tamanho uint16 e os bytes do texto
+const int TAMANHO_PAGINA_BYTES = 4096;
+
 class Pagina {
 public:
   std::array<Tupla, MAX_TUPLES_PER_PAGE> tuplas;
@@ -13,9 +24,24 @@ public:
   Pagina() : qtd_tuplas_ocup(0) {}
 
   void adicionarTupla(const Tupla &tupla);
+  void adicionarTupla(Tupla &&tupla);
   const Tupla *getTuplas() const;
-  std::string toString() const;
-  static Pagina fromString(const std::string &s);
+  // Grava a página em destino (TAMANHO_PAGINA_BYTES bytes); false se as
+  // tuplas não couberem
+  bool serializar(char *destino) const;
+  // Lê uma página gravada por serializar; uma página inválida volta vazia
+  static Pagina desserializar(const char *origem);
   bool isFull() const { return qtd_tuplas_ocup == MAX_TUPLES_PER_PAGE; }
   bool isEmpty() const { return qtd_tuplas_ocup == 0; }
+  // Há slot livre e o registro da tupla cabe nos bytes que sobram. Quem grava
+  // páginas em disco fecha a página quando a próxima tupla não cabe; uma
+  // tupla que não cabe nem numa página vazia não pode ser gravada.
+  bool cabe(const Tupla &tupla) const;
+  // O registro é pequeno o bastante para que MAX_TUPLES_PER_PAGE tuplas do
+  // mesmo tamanho caibam numa página: com tuplas assim, toda página fechada
+  // tem MAX_TUPLES_PER_PAGE tuplas
+  static bool cabeEmPaginaCheia(const Tupla &tupla);
+
+private:
+  size_t bytesRegistros = 0; // Registros das tuplas adicionadas
 };
@@ -0,0 +1,53 @@
+#include "particionamento.h"
+#include "utils.h"
+#include <iostream>
+
+using namespace std;
+
+bool Particionador::abrir(const string &prefixo, int numParticoes,
+                          int indice, bool chaveComoTexto, int nivelAtual,
+                          int *contadorIO) {
+  indiceChave = indice;
+  comoTexto = chaveComoTexto;
+  nivel = nivelAtual;
+  io = contadorIO;
+  nomes.clear();
+  saidas = vector<ofstream>(numParticoes);
+  paginasSaida.assign(numParticoes, Pagina());
+  paginasGravadas.assign(numParticoes, 0);
+  bool ok = true;
+  for (int i = 0; i < numParticoes; ++i) {
+    nomes.push_back(prefixo + "_" + to_string(i) + ".tmp");
+    saidas[i].open(nomes[i], ios::binary);
+    if (!saidas[i].is_open()) {
+      cerr << "Erro ao criar arquivo de partição: " << nomes[i] << endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+void Particionador::adicionar(Tupla &&tupla) {
+  size_t destino = particaoDaChave(getColunaValue(tupla, indiceChave),
+                                   comoTexto, nivel, saidas.size());
+  if (!paginasSaida[destino].cabe(tupla)) {
+    escreverPaginaEmStream(saidas[destino], paginasSaida[destino], *io);
+    paginasGravadas[destino]++;
+    paginasSaida[destino] = Pagina();
+  }
+  paginasSaida[destino].adicionarTupla(move(tupla));
+}
+
+bool Particionador::fechar() {
+  bool ok = true;
+  for (size_t i = 0; i < saidas.size(); ++i) {
+    if (!paginasSaida[i].isEmpty()) {
+      escreverPaginaEmStream(saidas[i], paginasSaida[i], *io);
+      paginasGravadas[i]++;
+      paginasSaida[i] = Pagina();
+    }
+    ok = ok && saidas[i];
+    saidas[i].close();
+  }
+  return ok;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "pagina.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Profundidade máxima do particionamento recursivo das junções hash: além
+// dela (chaves muito repetidas), a partição é juntada em memória mesmo assim
+const int MAX_NIVEL_PARTICAO = 4;
+
+// Particionamento das junções hash (Grace), usado pelo Operador e pela
+// JuncaoHash dos planos. As tuplas são distribuídas entre numParticoes
+// arquivos <prefixo>_<i>.tmp por particaoDaChave no nível de
+// particionamento, com uma página de saída em memória por partição. A
+// semente do nível espalha de novo as tuplas que caíram na mesma partição no
+// nível anterior.
+class Particionador {
+public:
+  // Cria os arquivos das partições; false se algum não pôde ser criado
+  bool abrir(const string &prefixo, int numParticoes, int indiceChave,
+             bool comoTexto, int nivel, int *contadorIO);
+  void adicionar(Tupla &&tupla);
+  // Grava as páginas que sobraram e fecha os arquivos; false se alguma
+  // escrita falhou
+  bool fechar();
+
+  const vector<string> &arquivos() const { return nomes; }
+  // Páginas gravadas em cada partição
+  const vector<int> &paginas() const { return paginasGravadas; }
+
+private:
+  vector<string> nomes;
+  vector<ofstream> saidas;
+  vector<Pagina> paginasSaida;
+  vector<int> paginasGravadas;
+  int indiceChave = 0;
+  bool comoTexto = false;
+  int nivel = 0;
+  int *io = nullptr;
+};
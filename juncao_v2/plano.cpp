@@ -0,0 +1,646 @@
+#include "plano.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+// Numeração dos arquivos temporários, para que dois operadores de um mesmo
+// plano (ou de planos diferentes) não usem os mesmos nomes
+static atomic<int> proximoTemporario{0};
+
+static string novoPrefixoTemporario(const string &operador) {
+  return "plano_" + to_string(proximoTemporario++) + "_" + operador;
+}
+
+// Tupla da esquerda seguida das colunas da tupla da direita
+static Tupla juntarTuplas(const Tupla &esquerda, const Tupla &direita) {
+  Tupla juntada = esquerda;
+  juntada.cols.insert(juntada.cols.end(), direita.cols.begin(),
+                      direita.cols.end());
+  return juntada;
+}
+
+int Iterador::indiceColuna(const string &coluna) const {
+  for (size_t i = 0; i < nomesColunas.size(); ++i) {
+    if (nomesColunas[i] == coluna)
+      return static_cast<int>(i);
+  }
+  return -1; // Coluna não encontrada
+}
+
+Tupla *CursorDeTuplas::atual() {
+  while (!fim && posicao >= pagina.qtd_tuplas_ocup) {
+    pagina = entrada->proximaPagina();
+    posicao = 0;
+    fim = pagina.isEmpty();
+  }
+  return fim ? nullptr : &pagina.tuplas[posicao];
+}
+
+// Varredura
+
+Varredura::Varredura(const Tabela &tabela)
+    : diretorio("data/" +
+                tabela.nomeArquivo.substr(0, tabela.nomeArquivo.find("."))),
+      numPaginas(static_cast<int>(tabela.pags.size())) {
+  nomesColunas = tabela.col_names;
+  tiposColunas = tabela.col_tipos;
+  tiposColunas.resize(nomesColunas.size(), TipoColuna::TEXTO);
+}
+
+void Varredura::abrir() { proxima = 0; }
+
+Pagina Varredura::proximaPagina() {
+  if (proxima >= numPaginas)
+    return Pagina();
+  string arquivo = diretorio + "/pagina_" + to_string(proxima++) + ".pag";
+  ifstream pagina(arquivo, ios::binary);
+  if (!pagina.is_open()) {
+    cerr << "Erro ao abrir arquivo de página: " << arquivo << endl;
+    return Pagina();
+  }
+  return lerPaginaDeStream(pagina, io);
+}
+
+// Filtro
+
+Filtro::Filtro(unique_ptr<Iterador> entradaFiltro,
+               function<bool(const Tupla &)> predicadoFiltro)
+    : entrada(move(entradaFiltro)), predicado(move(predicadoFiltro)) {
+  nomesColunas = entrada->colunas();
+  tiposColunas = entrada->tipos();
+}
+
+Filtro::Filtro(unique_ptr<Iterador> entradaFiltro, const string &coluna,
+               Comparacao comparacao, const Valor &valor)
+    : entrada(move(entradaFiltro)) {
+  nomesColunas = entrada->colunas();
+  tiposColunas = entrada->tipos();
+  int indice = entrada->indiceColuna(coluna);
+  if (indice == -1) {
+    cerr << "Erro: Coluna " << coluna << " não encontrada no filtro." << endl;
+    predicado = [](const Tupla &) { return false; };
+    return;
+  }
+  predicado = [indice, comparacao, valor](const Tupla &tupla) {
+    int c = compararValores(getColunaValue(tupla, indice), valor);
+    switch (comparacao) {
+    case Comparacao::IGUAL:
+      return c == 0;
+    case Comparacao::DIFERENTE:
+      return c != 0;
+    case Comparacao::MENOR:
+      return c < 0;
+    case Comparacao::MENOR_IGUAL:
+      return c <= 0;
+    case Comparacao::MAIOR:
+      return c > 0;
+    case Comparacao::MAIOR_IGUAL:
+      return c >= 0;
+    }
+    return false;
+  };
+}
+
+void Filtro::abrir() {
+  entrada->abrir();
+  cursor = CursorDeTuplas(entrada.get());
+}
+
+Pagina Filtro::proximaPagina() {
+  Pagina saida;
+  while (!saida.isFull()) {
+    Tupla *tupla = cursor.atual();
+    if (tupla == nullptr)
+      break;
+    if (predicado(*tupla))
+      saida.adicionarTupla(move(*tupla));
+    cursor.avancar();
+  }
+  return saida;
+}
+
+void Filtro::fechar() { entrada->fechar(); }
+
+// Projecao
+
+Projecao::Projecao(unique_ptr<Iterador> entradaProjecao,
+                   const vector<string> &colunas)
+    : entrada(move(entradaProjecao)) {
+  for (const string &coluna : colunas) {
+    int indice = entrada->indiceColuna(coluna);
+    if (indice == -1) {
+      cerr << "Erro: Coluna " << coluna << " não encontrada na projeção."
+           << endl;
+      continue;
+    }
+    indices.push_back(indice);
+    nomesColunas.push_back(coluna);
+    tiposColunas.push_back(entrada->tipos()[indice]);
+  }
+  moverColuna.assign(indices.size(), true);
+  for (size_t i = 0; i < indices.size(); ++i)
+    for (size_t j = i + 1; j < indices.size() && moverColuna[i]; ++j)
+      moverColuna[i] = indices[j] != indices[i];
+}
+
+Pagina Projecao::proximaPagina() {
+  Pagina paginaEntrada = entrada->proximaPagina();
+  Pagina saida;
+  for (int i = 0; i < paginaEntrada.qtd_tuplas_ocup; ++i) {
+    Tupla projetada;
+    projetada.cols.reserve(indices.size());
+    vector<Valor> &cols = paginaEntrada.tuplas[i].cols;
+    for (size_t c = 0; c < indices.size(); ++c) {
+      Valor &valor = cols[static_cast<size_t>(indices[c])];
+      if (moverColuna[c])
+        projetada.cols.push_back(move(valor));
+      else
+        projetada.cols.push_back(valor);
+    }
+    saida.adicionarTupla(move(projetada));
+  }
+  return saida;
+}
+
+// Ordenacao
+
+Ordenacao::Ordenacao(unique_ptr<Iterador> entradaOrdenacao,
+                     const string &coluna, int paginas, bool comoTexto,
+                     GeracaoRuns geracao, int numThreads)
+    : entrada(move(entradaOrdenacao)),
+      indiceChave(entrada->indiceColuna(coluna)),
+      paginasMemoria(max(3, paginas)), comoTexto(comoTexto),
+      geracaoRuns(geracao), threads(max(1, numThreads)),
+      prefixoRuns(novoPrefixoTemporario("ordenacao")) {
+  nomesColunas = entrada->colunas();
+  tiposColunas = entrada->tipos();
+  if (indiceChave == -1) {
+    cerr << "Erro: Chave de ordenação " << coluna << " não encontrada."
+         << endl;
+  }
+}
+
+void Ordenacao::abrir() {
+  entrada->abrir();
+  runs.clear();
+  emMemoria.clear();
+  proximaEmMemoria = 0;
+
+  // Blocos de paginasMemoria - 1 páginas: uma fica para a saída do run
+  const size_t capacidade =
+      static_cast<size_t>(paginasMemoria - 1) * MAX_TUPLES_PER_PAGE;
+  CursorDeTuplas cursor(entrada.get());
+  while (emMemoria.size() < capacidade) {
+    Tupla *tupla = cursor.atual();
+    if (tupla == nullptr)
+      break;
+    emMemoria.push_back(move(*tupla));
+    cursor.avancar();
+  }
+  if (cursor.atual() == nullptr) {
+    // Coube num só bloco
+    sort(emMemoria.begin(), emMemoria.end(),
+         [&](const Tupla &a, const Tupla &b) {
+           return valorMenor(getColunaValue(a, indiceChave),
+                             getColunaValue(b, indiceChave), comoTexto);
+         });
+    return;
+  }
+
+  // Não coube: as tuplas já lidas entram nos runs antes do resto da entrada
+  size_t proximaLida = 0;
+  FonteDeTuplas fonte = [&](Tupla &tupla) {
+    if (proximaLida < emMemoria.size()) {
+      tupla = move(emMemoria[proximaLida++]);
+      return true;
+    }
+    Tupla *atual = cursor.atual();
+    if (atual == nullptr)
+      return false;
+    tupla = move(*atual);
+    cursor.avancar();
+    return true;
+  };
+  bool ok = true;
+  if (geracaoRuns == GeracaoRuns::BLOCOS) {
+    vector<Tupla> bloco;
+    Tupla tupla;
+    while (ok && fonte(tupla)) {
+      bloco.push_back(move(tupla));
+      if (bloco.size() == capacidade) {
+        runs.push_back(prefixoRuns + "_run_" + to_string(runs.size()) +
+                       ".tmp");
+        ok = gerarRunEmBloco(bloco, runs.back(), indiceChave, comoTexto, io);
+        bloco.clear();
+      }
+    }
+    if (ok && !bloco.empty()) {
+      runs.push_back(prefixoRuns + "_run_" + to_string(runs.size()) + ".tmp");
+      ok = gerarRunEmBloco(bloco, runs.back(), indiceChave, comoTexto, io);
+    }
+  } else {
+    ok = gerarRunsPorSubstituicao(fonte, paginasMemoria, prefixoRuns + "_run_",
+                                  indiceChave, comoTexto, runs, io);
+  }
+  emMemoria.clear();
+  if (!ok)
+    return;
+
+  // O merge final, em proximaPagina(), tem uma página por run e uma de saída
+  const size_t fanIn = static_cast<size_t>(paginasMemoria - 1);
+  vector<PassoDeMerge> passos;
+  bool passosOk = intercalarEmPassos(runs, fanIn, prefixoRuns, indiceChave,
+                                     comoTexto, threads, passos);
+  for (const PassoDeMerge &passo : passos)
+    io += passo.io;
+  if (passosOk)
+    intercalador.abrir(runs, indiceChave, &io, comoTexto);
+}
+
+Pagina Ordenacao::proximaPagina() {
+  Pagina saida;
+  if (runs.empty()) {
+    while (!saida.isFull() && proximaEmMemoria < emMemoria.size())
+      saida.adicionarTupla(move(emMemoria[proximaEmMemoria++]));
+    return saida;
+  }
+  while (!saida.isFull()) {
+    Tupla *tupla = intercalador.atual();
+    if (tupla == nullptr)
+      break;
+    saida.adicionarTupla(move(*tupla));
+    intercalador.avancar();
+  }
+  return saida;
+}
+
+void Ordenacao::fechar() {
+  intercalador.fechar();
+  for (const string &run : runs)
+    remove(run.c_str());
+  runs.clear();
+  emMemoria.clear();
+  entrada->fechar();
+}
+
+// JuncaoMerge
+
+JuncaoMerge::JuncaoMerge(unique_ptr<Iterador> entradaEsquerda,
+                         unique_ptr<Iterador> entradaDireita,
+                         const string &colunaEsquerda,
+                         const string &colunaDireita)
+    : esquerda(move(entradaEsquerda)), direita(move(entradaDireita)),
+      indiceEsquerda(esquerda->indiceColuna(colunaEsquerda)),
+      indiceDireita(direita->indiceColuna(colunaDireita)) {
+  nomesColunas = esquerda->colunas();
+  nomesColunas.insert(nomesColunas.end(), direita->colunas().begin(),
+                      direita->colunas().end());
+  tiposColunas = esquerda->tipos();
+  tiposColunas.insert(tiposColunas.end(), direita->tipos().begin(),
+                      direita->tipos().end());
+  if (indiceEsquerda == -1 || indiceDireita == -1) {
+    cerr << "Erro: Chave de junção não encontrada em uma das entradas."
+         << endl;
+    return;
+  }
+  TipoColuna tipo1 = esquerda->tipos()[indiceEsquerda];
+  TipoColuna tipo2 = direita->tipos()[indiceDireita];
+  chaveComoTexto = tipo1 != tipo2 && (tipo1 == TipoColuna::TEXTO ||
+                                      tipo2 == TipoColuna::TEXTO);
+}
+
+void JuncaoMerge::abrir() {
+  esquerda->abrir();
+  direita->abrir();
+  cursorEsquerda = CursorDeTuplas(esquerda.get());
+  cursorDireita = CursorDeTuplas(direita.get());
+  grupoDireita.clear();
+  proximaDoGrupo = 0;
+}
+
+Pagina JuncaoMerge::proximaPagina() {
+  Pagina saida;
+  if (indiceEsquerda == -1 || indiceDireita == -1)
+    return saida;
+  while (!saida.isFull()) {
+    Tupla *t1 = cursorEsquerda.atual();
+    if (proximaDoGrupo < grupoDireita.size()) {
+      saida.adicionarTupla(
+          juntarTuplas(*t1, grupoDireita[proximaDoGrupo++]));
+      continue;
+    }
+    if (!grupoDireita.empty()) {
+      // A tupla da esquerda já foi juntada com o grupo todo; a seguinte usa o
+      // mesmo grupo se tiver a mesma chave
+      cursorEsquerda.avancar();
+      t1 = cursorEsquerda.atual();
+      if (t1 && valorIgual(getColunaValue(*t1, indiceEsquerda),
+                           getColunaValue(grupoDireita[0], indiceDireita),
+                           chaveComoTexto)) {
+        proximaDoGrupo = 0;
+        continue;
+      }
+      grupoDireita.clear();
+      proximaDoGrupo = 0;
+    }
+
+    // Avança a entrada de menor chave até as chaves serem iguais
+    Tupla *t2 = cursorDireita.atual();
+    while (t1 && t2) {
+      const Valor &chave1 = getColunaValue(*t1, indiceEsquerda);
+      const Valor &chave2 = getColunaValue(*t2, indiceDireita);
+      if (valorMenor(chave1, chave2, chaveComoTexto)) {
+        cursorEsquerda.avancar();
+        t1 = cursorEsquerda.atual();
+      } else if (valorMenor(chave2, chave1, chaveComoTexto)) {
+        cursorDireita.avancar();
+        t2 = cursorDireita.atual();
+      } else {
+        break;
+      }
+    }
+    if (!t1 || !t2)
+      break; // Uma das entradas acabou
+
+    // Coleta as tuplas da direita com a chave de t1
+    const Valor &chave = getColunaValue(*t1, indiceEsquerda);
+    while (t2 &&
+           valorIgual(getColunaValue(*t2, indiceDireita), chave, chaveComoTexto)) {
+      grupoDireita.push_back(move(*t2));
+      cursorDireita.avancar();
+      t2 = cursorDireita.atual();
+    }
+  }
+  return saida;
+}
+
+void JuncaoMerge::fechar() {
+  grupoDireita.clear();
+  esquerda->fechar();
+  direita->fechar();
+}
+
+// JuncaoHash
+
+JuncaoHash::JuncaoHash(unique_ptr<Iterador> entradaEsquerda,
+                       unique_ptr<Iterador> entradaDireita,
+                       const string &colunaEsquerda,
+                       const string &colunaDireita, int paginas)
+    : esquerda(move(entradaEsquerda)), direita(move(entradaDireita)),
+      indiceEsquerda(esquerda->indiceColuna(colunaEsquerda)),
+      indiceDireita(direita->indiceColuna(colunaDireita)),
+      paginasMemoria(max(3, paginas)) {
+  nomesColunas = esquerda->colunas();
+  nomesColunas.insert(nomesColunas.end(), direita->colunas().begin(),
+                      direita->colunas().end());
+  tiposColunas = esquerda->tipos();
+  tiposColunas.insert(tiposColunas.end(), direita->tipos().begin(),
+                      direita->tipos().end());
+  if (indiceEsquerda == -1 || indiceDireita == -1) {
+    cerr << "Erro: Chave de junção não encontrada em uma das entradas."
+         << endl;
+    return;
+  }
+  // Texto e número se comparam pela representação em texto, e o hash precisa
+  // seguir a mesma regra
+  TipoColuna tipo1 = esquerda->tipos()[indiceEsquerda];
+  TipoColuna tipo2 = direita->tipos()[indiceDireita];
+  chaveComoTexto = tipo1 != tipo2 && (tipo1 == TipoColuna::TEXTO ||
+                                      tipo2 == TipoColuna::TEXTO);
+}
+
+void JuncaoHash::construirTabelaHash() {
+  tabelaHash.clear();
+  tabelaHash.reserve(construcao.size());
+  for (size_t i = 0; i < construcao.size(); ++i) {
+    tabelaHash.emplace(
+        hashValor(getColunaValue(construcao[i], indiceDireita), chaveComoTexto),
+        i);
+  }
+}
+
+void JuncaoHash::abrir() {
+  esquerda->abrir();
+  direita->abrir();
+  construcao.clear();
+  tabelaHash.clear();
+  particionado = false;
+  pendentes.clear();
+  parAtual = ParDeParticoes();
+  correspondencias.clear();
+  proximaCorrespondencia = 0;
+  cursorEsquerda = CursorDeTuplas(esquerda.get());
+  if (indiceEsquerda == -1 || indiceDireita == -1)
+    return;
+
+  // Construção: uma página para a sondagem e uma para a saída
+  const size_t capacidade =
+      static_cast<size_t>(paginasMemoria - 2) * MAX_TUPLES_PER_PAGE;
+  CursorDeTuplas cursorDireita(direita.get());
+  while (construcao.size() < capacidade) {
+    Tupla *tupla = cursorDireita.atual();
+    if (tupla == nullptr)
+      break;
+    construcao.push_back(move(*tupla));
+    cursorDireita.avancar();
+  }
+  if (cursorDireita.atual() == nullptr) {
+    construirTabelaHash(); // Coube: a esquerda é sondada em pipeline
+    return;
+  }
+
+  // Não coube: particiona as duas entradas e junta partição a partição
+  particionado = true;
+  size_t proximaLida = 0;
+  FonteDeTuplas fonteDireita = [&](Tupla &tupla) {
+    if (proximaLida < construcao.size()) {
+      tupla = move(construcao[proximaLida++]);
+      return true;
+    }
+    Tupla *atual = cursorDireita.atual();
+    if (atual == nullptr)
+      return false;
+    tupla = move(*atual);
+    cursorDireita.avancar();
+    return true;
+  };
+  FonteDeTuplas fonteEsquerda = [&](Tupla &tupla) {
+    Tupla *atual = cursorEsquerda.atual();
+    if (atual == nullptr)
+      return false;
+    tupla = move(*atual);
+    cursorEsquerda.avancar();
+    return true;
+  };
+  // Sem nenhum par para juntar, o resultado é vazio
+  if (dividir(fonteEsquerda, fonteDireita, novoPrefixoTemporario("hash"), 0))
+    proximaParticao();
+}
+
+// Distribui as tuplas da entrada em paginasMemoria - 1 partições
+// <prefixo>_<i>.tmp no nível (ver Particionador)
+bool JuncaoHash::particionar(Particionador &particionador,
+                             const FonteDeTuplas &entrada, int indiceChave,
+                             const string &prefixo, int nivel) {
+  bool ok = particionador.abrir(prefixo, paginasMemoria - 1, indiceChave,
+                                chaveComoTexto, nivel, &io);
+  Tupla tupla;
+  while (ok && entrada(tupla))
+    particionador.adicionar(move(tupla));
+  return particionador.fechar() && ok;
+}
+
+// Particiona as duas entradas no nível e guarda os pares com tuplas dos dois
+// lados para serem juntados; as partições dos demais são apagadas
+bool JuncaoHash::dividir(const FonteDeTuplas &fonteEsquerda,
+                         const FonteDeTuplas &fonteDireita,
+                         const string &prefixo, int nivel) {
+  Particionador porDireita, porEsquerda;
+  bool ok = particionar(porDireita, fonteDireita, indiceDireita,
+                        prefixo + "_d", nivel) &&
+            particionar(porEsquerda, fonteEsquerda, indiceEsquerda,
+                        prefixo + "_e", nivel);
+  for (size_t i = 0; i < porDireita.arquivos().size(); ++i) {
+    if (ok && porEsquerda.paginas()[i] > 0 && porDireita.paginas()[i] > 0) {
+      pendentes.push_back({prefixo + "_" + to_string(i),
+                           porEsquerda.arquivos()[i], porDireita.arquivos()[i],
+                           porEsquerda.paginas()[i], porDireita.paginas()[i],
+                           nivel + 1});
+      continue;
+    }
+    remove(porDireita.arquivos()[i].c_str());
+    if (i < porEsquerda.arquivos().size())
+      remove(porEsquerda.arquivos()[i].c_str());
+  }
+  return ok;
+}
+
+// Passa para o próximo par: carrega a partição da direita na tabela hash e
+// abre a da esquerda para a sondagem. Uma partição da direita maior que a
+// memória é dividida de novo no nível seguinte; a partir de
+// MAX_NIVEL_PARTICAO (chaves muito repetidas) é carregada mesmo assim.
+// false quando não há mais pares.
+bool JuncaoHash::proximaParticao() {
+  while (!pendentes.empty()) {
+    parAtual = pendentes.back();
+    pendentes.pop_back();
+    if (parAtual.paginasDireita > paginasMemoria - 2 &&
+        parAtual.nivel < MAX_NIVEL_PARTICAO) {
+      bool erroEsquerda = false, erroDireita = false;
+      vector<string> esquerdaDoPar{parAtual.esquerda};
+      vector<string> direitaDoPar{parAtual.direita};
+      dividir(fonteDeArquivos(esquerdaDoPar, io, erroEsquerda),
+              fonteDeArquivos(direitaDoPar, io, erroDireita), parAtual.prefixo,
+              parAtual.nivel);
+      removerParAtual();
+      continue;
+    }
+    if (parAtual.paginasDireita > paginasMemoria - 2) {
+      cerr << "Aviso: Partição de " << parAtual.paginasDireita
+           << " páginas não coube na memória após " << parAtual.nivel
+           << " particionamentos; juntando em memória." << endl;
+    }
+
+    construcao.clear();
+    ifstream construcaoArquivo(parAtual.direita, ios::binary);
+    Pagina pagina;
+    while (!(pagina = lerPaginaDeStream(construcaoArquivo, io)).isEmpty()) {
+      for (int i = 0; i < pagina.qtd_tuplas_ocup; ++i)
+        construcao.push_back(move(pagina.tuplas[i]));
+    }
+    construirTabelaHash();
+
+    sondagem.clear();
+    sondagem.open(parAtual.esquerda, ios::binary);
+    paginaSondagem = Pagina();
+    posicaoSondagem = 0;
+    if (!sondagem.is_open()) {
+      cerr << "Erro ao abrir arquivo de partição: " << parAtual.esquerda
+           << endl;
+      removerParAtual();
+      continue;
+    }
+    return true;
+  }
+  return false;
+}
+
+// Fecha a sondagem e apaga as partições do par atual
+void JuncaoHash::removerParAtual() {
+  sondagem.close();
+  if (!parAtual.esquerda.empty()) {
+    remove(parAtual.esquerda.c_str());
+    remove(parAtual.direita.c_str());
+  }
+  parAtual = ParDeParticoes();
+}
+
+// Próxima tupla da esquerda: do filho, em pipeline, ou das partições, uma
+// depois da outra
+bool JuncaoHash::proximaSondagem(Tupla &tupla) {
+  if (!particionado) {
+    Tupla *atual = cursorEsquerda.atual();
+    if (atual == nullptr)
+      return false;
+    tupla = move(*atual);
+    cursorEsquerda.avancar();
+    return true;
+  }
+  while (true) {
+    if (posicaoSondagem < paginaSondagem.qtd_tuplas_ocup) {
+      tupla = move(paginaSondagem.tuplas[posicaoSondagem++]);
+      return true;
+    }
+    paginaSondagem = lerPaginaDeStream(sondagem, io);
+    posicaoSondagem = 0;
+    if (!paginaSondagem.isEmpty())
+      continue;
+    removerParAtual();
+    if (!proximaParticao())
+      return false;
+  }
+}
+
+Pagina JuncaoHash::proximaPagina() {
+  Pagina saida;
+  if (indiceEsquerda == -1 || indiceDireita == -1)
+    return saida;
+  while (!saida.isFull()) {
+    if (proximaCorrespondencia < correspondencias.size()) {
+      saida.adicionarTupla(juntarTuplas(
+          tuplaSondagem,
+          construcao[correspondencias[proximaCorrespondencia++]]));
+      continue;
+    }
+    if (!proximaSondagem(tuplaSondagem))
+      break;
+    correspondencias.clear();
+    proximaCorrespondencia = 0;
+    const Valor &chave = getColunaValue(tuplaSondagem, indiceEsquerda);
+    auto faixa = tabelaHash.equal_range(hashValor(chave, chaveComoTexto));
+    for (auto it = faixa.first; it != faixa.second; ++it) {
+      if (valorIgual(getColunaValue(construcao[it->second], indiceDireita),
+                     chave, chaveComoTexto))
+        correspondencias.push_back(it->second);
+    }
+  }
+  return saida;
+}
+
+void JuncaoHash::fechar() {
+  removerParAtual();
+  for (const ParDeParticoes &par : pendentes) {
+    remove(par.esquerda.c_str());
+    remove(par.direita.c_str());
+  }
+  pendentes.clear();
+  construcao.clear();
+  tabelaHash.clear();
+  correspondencias.clear();
+  esquerda->fechar();
+  direita->fechar();
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "operador.h" // MEMORY_LIMIT_PAGES
+#include "ordenacao_externa.h"
+#include "particionamento.h"
+#include "pagina.h"
+#include "tabela.h"
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Planos de consulta no modelo de iteradores (Volcano). Cada operador produz
+// páginas de tuplas sob demanda: abrir() prepara a execução, proximaPagina()
+// devolve a próxima página do resultado (vazia no fim) e fechar() libera
+// arquivos e memória. Os operadores se compõem em árvore, cada um puxando as
+// páginas dos filhos, e a consulta roda em pipeline: só a Ordenacao (runs) e a
+// JuncaoHash (partições, quando a entrada de construção não cabe na memória)
+// gravam resultados intermediários em disco.
+//
+//   JuncaoMerge(Ordenacao(Varredura(vinho), "uva_id"),
+//               Ordenacao(Filtro(Varredura(uva), "ano_colheita",
+//                                Comparacao::MAIOR, Valor(2000LL)),
+//                         "uva_id"),
+//               "uva_id", "uva_id")
+class Iterador {
+public:
+  virtual ~Iterador() = default;
+
+  virtual void abrir() = 0;
+  virtual Pagina proximaPagina() = 0;
+  virtual void fechar() = 0;
+
+  // Esquema da saída: nome e tipo de cada coluna
+  const vector<string> &colunas() const { return nomesColunas; }
+  const vector<TipoColuna> &tipos() const { return tiposColunas; }
+  // Posição da coluna na saída (a primeira com o nome); -1 se não existir
+  int indiceColuna(const string &coluna) const;
+  // E/S de página executadas por este operador e pelos de baixo
+  virtual int numIOExecutados() const { return io; }
+
+protected:
+  vector<string> nomesColunas;
+  vector<TipoColuna> tiposColunas;
+  int io = 0;
+};
+
+// Leitura tupla a tupla das páginas de um Iterador
+class CursorDeTuplas {
+public:
+  explicit CursorDeTuplas(Iterador *entrada = nullptr) : entrada(entrada) {}
+
+  // Tupla atual, que pode ser movida antes de avancar(); nullptr no fim
+  Tupla *atual();
+  void avancar() { posicao++; }
+
+private:
+  Iterador *entrada;
+  Pagina pagina;
+  int posicao = 0;
+  bool fim = false;
+};
+
+// Lê as páginas de uma Tabela já carregada (data/<tabela>/pagina_i.pag),
+// uma E/S por página
+class Varredura : public Iterador {
+public:
+  explicit Varredura(const Tabela &tabela);
+
+  void abrir() override;
+  Pagina proximaPagina() override;
+  void fechar() override {}
+
+private:
+  string diretorio;
+  int numPaginas;
+  int proxima = 0;
+};
+
+enum class Comparacao { IGUAL, DIFERENTE, MENOR, MENOR_IGUAL, MAIOR, MAIOR_IGUAL };
+
+// Tuplas da entrada que satisfazem o predicado, em páginas cheias
+class Filtro : public Iterador {
+public:
+  Filtro(unique_ptr<Iterador> entrada,
+         function<bool(const Tupla &)> predicado);
+  // coluna <comparacao> valor, com a ordem de compararValores
+  Filtro(unique_ptr<Iterador> entrada, const string &coluna,
+         Comparacao comparacao, const Valor &valor);
+
+  void abrir() override;
+  Pagina proximaPagina() override;
+  void fechar() override;
+  int numIOExecutados() const override { return entrada->numIOExecutados(); }
+
+private:
+  unique_ptr<Iterador> entrada;
+  function<bool(const Tupla &)> predicado;
+  CursorDeTuplas cursor;
+};
+
+// Só as colunas pedidas, na ordem pedida
+class Projecao : public Iterador {
+public:
+  Projecao(unique_ptr<Iterador> entrada, const vector<string> &colunas);
+
+  void abrir() override { entrada->abrir(); }
+  Pagina proximaPagina() override;
+  void fechar() override { entrada->fechar(); }
+  int numIOExecutados() const override { return entrada->numIOExecutados(); }
+
+private:
+  unique_ptr<Iterador> entrada;
+  vector<int> indices;
+  // A coluna pode ser movida da tupla de entrada: é o último uso do índice.
+  // Uma coluna pedida mais de uma vez é copiada nos usos anteriores.
+  vector<bool> moverColuna;
+};
+
+// Ordenação externa da entrada pela coluna, com as mesmas peças do
+// externalSort do Operador (ver ordenacao_externa.h). abrir() gera os runs
+// (por seleção por substituição ou em blocos de paginasMemoria - 1 páginas)
+// e faz os passos de merge, com os grupos de cada passo em até threads
+// workers, até restarem paginasMemoria - 1 runs; o merge final é feito sob
+// demanda em proximaPagina(), sem gravar o resultado. Uma entrada que cabe em
+// paginasMemoria - 1 páginas é ordenada em memória, sem E/S. Com comoTexto,
+// ordena pelo texto da chave (ver compararValores), como pede a JuncaoMerge
+// de uma coluna texto com uma numérica.
+class Ordenacao : public Iterador {
+public:
+  Ordenacao(unique_ptr<Iterador> entrada, const string &coluna,
+            int paginasMemoria = MEMORY_LIMIT_PAGES, bool comoTexto = false,
+            GeracaoRuns geracaoRuns = GeracaoRuns::SELECAO_SUBSTITUICAO,
+            int threads = 1);
+
+  void abrir() override;
+  Pagina proximaPagina() override;
+  void fechar() override;
+  int numIOExecutados() const override {
+    return io + entrada->numIOExecutados();
+  }
+
+private:
+  unique_ptr<Iterador> entrada;
+  int indiceChave;
+  int paginasMemoria;
+  bool comoTexto;
+  GeracaoRuns geracaoRuns;
+  int threads;
+  string prefixoRuns; // Único por Ordenacao
+  vector<string> runs;
+  vector<Tupla> emMemoria;
+  size_t proximaEmMemoria = 0;
+  IntercaladorDeRuns intercalador;
+};
+
+// Merge join por igualdade. As duas entradas precisam vir ordenadas pelas
+// colunas de junção (por exemplo, de uma Ordenacao); se uma coluna é texto e
+// a outra numérica, as chaves são comparadas pelo texto e as duas entradas
+// precisam vir ordenadas com comoTexto. As tuplas da direita com a chave
+// atual ficam em memória enquanto são juntadas com as da esquerda. A saída
+// tem as colunas da esquerda seguidas das da direita.
+class JuncaoMerge : public Iterador {
+public:
+  JuncaoMerge(unique_ptr<Iterador> esquerda, unique_ptr<Iterador> direita,
+              const string &colunaEsquerda, const string &colunaDireita);
+
+  void abrir() override;
+  Pagina proximaPagina() override;
+  void fechar() override;
+  int numIOExecutados() const override {
+    return esquerda->numIOExecutados() + direita->numIOExecutados();
+  }
+
+private:
+  unique_ptr<Iterador> esquerda, direita;
+  int indiceEsquerda, indiceDireita;
+  bool chaveComoTexto = false; // Colunas de junção texto x número
+  CursorDeTuplas cursorEsquerda, cursorDireita;
+  vector<Tupla> grupoDireita; // Tuplas da direita com a chave atual
+  size_t proximaDoGrupo = 0;
+};
+
+// Junção hash por igualdade, com a direita como entrada de construção. Se
+// ela couber em paginasMemoria - 2 páginas, a esquerda é sondada em
+// pipeline; senão as duas entradas são divididas em paginasMemoria - 1
+// partições em disco pelo hash da chave e cada par é juntado em memória. Uma
+// partição da direita que ainda não cabe é dividida de novo, com outra
+// semente, como no Operador, até MAX_NIVEL_PARTICAO níveis. A saída tem as
+// colunas da esquerda seguidas das da direita.
+class JuncaoHash : public Iterador {
+public:
+  JuncaoHash(unique_ptr<Iterador> esquerda, unique_ptr<Iterador> direita,
+             const string &colunaEsquerda, const string &colunaDireita,
+             int paginasMemoria = MEMORY_LIMIT_PAGES);
+
+  void abrir() override;
+  Pagina proximaPagina() override;
+  void fechar() override;
+  int numIOExecutados() const override {
+    return io + esquerda->numIOExecutados() + direita->numIOExecutados();
+  }
+
+private:
+  unique_ptr<Iterador> esquerda, direita;
+  int indiceEsquerda, indiceDireita;
+  int paginasMemoria;
+  bool chaveComoTexto = false; // Colunas de junção texto x número
+
+  vector<Tupla> construcao;
+  unordered_multimap<size_t, size_t> tabelaHash;
+  CursorDeTuplas cursorEsquerda;
+
+  // Par de partições em disco com o mesmo hash da chave, quando a direita
+  // não cabe na memória
+  struct ParDeParticoes {
+    string prefixo; // Das partições do par no nível seguinte
+    string esquerda, direita;
+    int paginasEsquerda = 0, paginasDireita = 0;
+    int nivel = 0; // Do próximo particionamento
+  };
+  bool particionado = false;
+  vector<ParDeParticoes> pendentes; // Pares ainda não juntados
+  ParDeParticoes parAtual;
+  ifstream sondagem; // Partição da esquerda em leitura
+  Pagina paginaSondagem;
+  int posicaoSondagem = 0;
+
+  Tupla tuplaSondagem;
+  vector<size_t> correspondencias; // Em construcao, para tuplaSondagem
+  size_t proximaCorrespondencia = 0;
+
+  void construirTabelaHash();
+  bool particionar(Particionador &particionador, const FonteDeTuplas &entrada,
+                   int indiceChave, const string &prefixo, int nivel);
+  bool dividir(const FonteDeTuplas &fonteEsquerda,
+               const FonteDeTuplas &fonteDireita, const string &prefixo,
+               int nivel);
+  bool proximaParticao();
+  void removerParAtual();
+  bool proximaSondagem(Tupla &tupla);
+};
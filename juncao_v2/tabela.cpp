@@ -2,15 +2,21 @@
 #include "pagina.h"
 #include "tupla.h"
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <unordered_set>
 
 using namespace std;
 
-Tabela::Tabela(const string &nomeArquivo) {
+Tabela::Tabela(const string &nomeArquivo,
+               const vector<TipoColuna> &tiposDeclarados) {
   this->nomeArquivo = nomeArquivo;
   this->qtd_pags = 0;
   this->qtd_cols = 0;
+  this->col_tipos = tiposDeclarados;
 }
 
 void Tabela::carregarDados() {
@@ -28,6 +34,8 @@ void Tabela::carregarDados() {
   // Lê o cabeçalho
   vector<string> colunas;
   if (getline(arquivo, linha)) {
+    if (!linha.empty() && linha.back() == '\r')
+      linha.pop_back(); // CSV com fim de linha \r\n
     stringstream ss(linha);
     string coluna;
     while (getline(ss, coluna, ',')) {
@@ -37,12 +45,12 @@ void Tabela::carregarDados() {
     qtd_cols = colunas.size();
   }
 
-  // Lê os dados e armazena em páginas
-  Pagina paginaAtual;
-  int tam_pagina = 10; // Exemplo: 10 linhas por página
-  int linhas_na_pagina = 0;
-
+  // Lê as linhas como texto; os tipos das colunas só são conhecidos depois
+  // de ver todos os valores
+  vector<vector<string>> linhas;
   while (getline(arquivo, linha)) {
+    if (!linha.empty() && linha.back() == '\r')
+      linha.pop_back();
     stringstream ss(linha);
     string valor;
     vector<string> linhaDados;
@@ -50,28 +58,87 @@ void Tabela::carregarDados() {
       linhaDados.push_back(valor);
     }
     if (!linhaDados.empty()) {
-      Tupla tupla(linhaDados); // Supondo que Tupla tem um construtor que aceita
-                               // vector<string>
-      paginaAtual.adicionarTupla(tupla);
-      linhas_na_pagina++;
+      linhas.push_back(linhaDados);
+    }
+  }
+
+  // Esquema: tipos declarados ou, para cada coluna, o tipo mais específico
+  // que serve para todos os valores (INTEIRO < REAL < TEXTO)
+  if (!col_tipos.empty() && col_tipos.size() != static_cast<size_t>(qtd_cols)) {
+    cerr << "Aviso: " << col_tipos.size() << " tipos declarados para "
+         << qtd_cols << " colunas em " << nomeArquivo
+         << "; os tipos serão inferidos." << endl;
+    col_tipos.clear();
+  }
+  if (col_tipos.empty()) {
+    col_tipos.assign(qtd_cols, TipoColuna::INTEIRO);
+    for (const auto &linhaDados : linhas) {
+      for (int c = 0; c < qtd_cols; ++c) {
+        if (col_tipos[c] == TipoColuna::TEXTO)
+          continue;
+        TipoColuna tipo = static_cast<size_t>(c) < linhaDados.size()
+                              ? inferirTipo(linhaDados[c])
+                              : TipoColuna::TEXTO;
+        col_tipos[c] = max(col_tipos[c], tipo);
+      }
+    }
+  }
+
+  // Converte cada valor uma única vez e armazena em páginas. A página é
+  // fechada com MAX_TUPLES_PER_PAGE linhas ou quando a próxima não cabe mais
+  // nos seus TAMANHO_PAGINA_BYTES bytes
+  Pagina paginaAtual;
+  int valoresInvalidos = 0;
+  size_t numLinha = 0;
+
+  for (const auto &linhaDados : linhas) {
+    numLinha++;
+    vector<Valor> valores(linhaDados.size());
+    for (size_t c = 0; c < linhaDados.size(); ++c) {
+      TipoColuna tipo = c < col_tipos.size() ? col_tipos[c] : TipoColuna::TEXTO;
+      if (!converterValor(linhaDados[c], tipo, valores[c]))
+        valoresInvalidos++;
     }
-    if (linhas_na_pagina == tam_pagina) {
+    Tupla tupla(valores);
+    if (!paginaAtual.cabe(tupla) && !paginaAtual.isEmpty()) {
       pags.push_back(paginaAtual);
       paginaAtual = Pagina();
-      linhas_na_pagina = 0;
       qtd_pags++;
     }
+    if (!paginaAtual.cabe(tupla)) {
+      // Nem numa página vazia: a tabela não pode ser gravada sem perder
+      // linhas e fica vazia
+      cerr << "Erro: A linha " << numLinha << " de " << nomeArquivo
+           << " não cabe em uma página de " << TAMANHO_PAGINA_BYTES
+           << " bytes; a tabela não foi carregada." << endl;
+      pags.clear();
+      qtd_pags = 0;
+      paginaAtual = Pagina();
+      break;
+    }
+    paginaAtual.adicionarTupla(std::move(tupla));
   }
-  if (linhas_na_pagina > 0) {
+  if (!paginaAtual.isEmpty()) {
     pags.push_back(paginaAtual);
     qtd_pags++;
   }
+  if (valoresInvalidos > 0) {
+    cerr << "Aviso: " << valoresInvalidos << " valores de " << nomeArquivo
+         << " não correspondem ao tipo declarado e ficaram como texto."
+         << endl;
+  }
   salvarPaginasEmDisco(); // Salva as páginas em disco após carregar
 }
 
 void Tabela::imprimir() const {
   cout << "Tabela: " << nomeArquivo << "\n";
   cout << "Quantidade de colunas: " << qtd_cols << "\n";
+  cout << "Esquema:";
+  for (size_t c = 0; c < col_names.size(); ++c) {
+    cout << (c == 0 ? " " : ", ") << col_names[c] << " ("
+         << (c < col_tipos.size() ? nomeTipo(col_tipos[c]) : "texto") << ")";
+  }
+  cout << "\n";
   cout << "Quantidade de páginas: " << qtd_pags << "\n";
 
   for (const auto &pagina : pags) {
@@ -81,21 +148,75 @@ void Tabela::imprimir() const {
   }
 }
 
+long long Tabela::qtdTuplas() const {
+  long long total = 0;
+  for (const auto &pagina : pags) {
+    total += pagina.qtd_tuplas_ocup;
+  }
+  return total;
+}
+
+long long Tabela::estimarValoresDistintos(int coluna) const {
+  unordered_set<size_t> hashes;
+  for (const auto &pagina : pags) {
+    for (int i = 0; i < pagina.qtd_tuplas_ocup; ++i) {
+      const auto &cols = pagina.tuplas[i].cols;
+      if (coluna >= 0 && static_cast<size_t>(coluna) < cols.size())
+        hashes.insert(hashValor(cols[coluna]));
+    }
+  }
+  return static_cast<long long>(hashes.size());
+}
+
 void Tabela::salvarPaginasEmDisco() const {
   string dirName = "data/" + nomeArquivo.substr(0, nomeArquivo.find("."));
   string command = "mkdir -p " + dirName; // Criar diretório se não existir
   system(command.c_str());
 
   for (size_t i = 0; i < pags.size(); ++i) {
-    string pageFileName = dirName + "/pagina_" + to_string(i) + ".txt";
-    ofstream outFile(pageFileName);
+    string pageFileName = dirName + "/pagina_" + to_string(i) + ".pag";
+    // Serializa antes de abrir o arquivo para não deixar uma página vazia em
+    // disco; carregarDados só monta páginas que cabem
+    char buffer[TAMANHO_PAGINA_BYTES];
+    if (!pags[i].serializar(buffer)) {
+      cerr << "Erro: As tuplas da página " << i << " de " << nomeArquivo
+           << " não cabem em " << TAMANHO_PAGINA_BYTES << " bytes." << endl;
+      continue;
+    }
+    // Uma página igual à que já está em disco não é regravada: a data dos
+    // arquivos diz se o índice da junção com índice está atualizado
+    {
+      char emDisco[TAMANHO_PAGINA_BYTES];
+      ifstream anterior(pageFileName, ios::binary);
+      if (anterior.read(emDisco, TAMANHO_PAGINA_BYTES) &&
+          memcmp(emDisco, buffer, TAMANHO_PAGINA_BYTES) == 0)
+        continue;
+    }
+    ofstream outFile(pageFileName, ios::binary);
     if (!outFile.is_open()) {
       cerr << "Erro ao criar arquivo de página: " << pageFileName << endl;
       continue;
     }
-    outFile << pags[i].toString();
+    outFile.write(buffer, TAMANHO_PAGINA_BYTES);
     outFile.close();
   }
+
+  // Páginas de uma carga anterior com mais linhas deixam de fazer parte da
+  // tabela. Os índices sobre ela também, já que apontam para essas linhas e
+  // nenhuma das páginas que ficaram é mais nova que eles
+  bool paginasRemovidas = false;
+  for (size_t i = pags.size();; ++i) {
+    string pageFileName = dirName + "/pagina_" + to_string(i) + ".pag";
+    if (!filesystem::remove(pageFileName))
+      break;
+    paginasRemovidas = true;
+  }
+  if (paginasRemovidas) {
+    for (const auto &entry : filesystem::directory_iterator(dirName)) {
+      if (entry.path().filename().string().rfind("indice_", 0) == 0)
+        filesystem::remove(entry.path());
+    }
+  }
   cout << "Páginas da tabela " << nomeArquivo << " salvas em " << dirName
        << endl;
 }
@@ -2,6 +2,7 @@
 #define TABELA_H
 
 #include "pagina.h"
+#include "valor.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -15,13 +16,21 @@ public:
   int qtd_pags;
   int qtd_cols;
   vector<string> col_names; // Adicionado para armazenar nomes das colunas
+  vector<TipoColuna> col_tipos; // Esquema: tipo de cada coluna
 
-  Tabela(const string &nomeArquivo);
+  // Sem tipos declarados (ou com quantidade diferente da de colunas), o tipo
+  // de cada coluna é inferido dos valores na carga.
+  Tabela(const string &nomeArquivo,
+         const vector<TipoColuna> &tiposDeclarados = {});
 
   void carregarDados();
   void imprimir() const;
+  long long qtdTuplas() const;
+  // Chaves distintas na coluna, contadas pelo hash dos valores (colisões
+  // podem reduzir um pouco a contagem)
+  long long estimarValoresDistintos(int coluna) const;
   void salvarPaginasEmDisco()
       const; // Novo método para salvar páginas individualmente
 };
 
-#endif // TABELA_H
\ No newline at end of file
+#endif // TABELA_H
@@ -1,18 +1,19 @@
+#pragma once
+
+#include "valor.h"
 #include <string>
 #include <vector>
-#pragma once
 
 using namespace std;
 class Tupla {
 public:
-  vector<string> cols;
+  vector<Valor> cols; // Um valor tipado por coluna, na ordem do esquema
 
   Tupla() = default;
   Tupla(size_t qtd_cols);
-  Tupla(const vector<string> &valores);
+  Tupla(const vector<Valor> &valores);
   void imprimir() const;
   bool operator<(const Tupla &other) const;
   bool operator==(const Tupla &other) const;
   std::string toString() const;
-  static Tupla fromString(const std::string &s);
 };
@@ -1,62 +1,42 @@
 #include "utils.h"
+#include <filesystem>
 #include <iostream>
-#include <sstream>
 
 // Função para ler um bloco de tuplas de um ifstream (simulando leitura de
 // páginas)
 std::vector<Tupla> lerBlocoDeTuplas(std::ifstream &arquivo, int num_paginas,
                                     int &io_count) {
   std::vector<Tupla> tuplasDoBloco;
-  std::string linha;
-  int tuplasLidas = 0;
-
   for (int p = 0; p < num_paginas; ++p) {
-    bool paginaLida = false;
-    for (int i = 0; i < MAX_TUPLES_PER_PAGE; ++i) {
-      if (std::getline(arquivo, linha)) {
-        if (!linha.empty()) {
-          tuplasDoBloco.push_back(Tupla::fromString(linha));
-          tuplasLidas++;
-          paginaLida = true;
-        }
-      } else {
-        break; // Fim do arquivo
-      }
-    }
-    if (paginaLida) {
-      io_count++; // Contabiliza leitura de página
+    Pagina pagina = lerPaginaDeStream(arquivo, io_count);
+    if (pagina.isEmpty())
+      break; // Fim do arquivo
+    for (int i = 0; i < pagina.qtd_tuplas_ocup; ++i) {
+      tuplasDoBloco.push_back(pagina.tuplas[i]);
     }
-    if (!arquivo)
-      break; // Se o arquivo terminou no meio de uma página
   }
   return tuplasDoBloco;
 }
 
 // Função auxiliar para obter o valor de uma coluna de uma tupla
-std::string getColunaValue(const Tupla &tupla, int indiceColuna) {
+const Valor &getColunaValue(const Tupla &tupla, int indiceColuna) {
+  static const Valor vazio = std::string();
   if (indiceColuna >= 0 &&
       static_cast<size_t>(indiceColuna) < tupla.cols.size()) {
     return tupla.cols[indiceColuna];
   }
-  return ""; // Retorna string vazia se o índice for inválido
+  return vazio; // Retorna string vazia se o índice for inválido
 }
 
-// Novas funções para I/O em nível de página
+// Funções para I/O em nível de página: uma leitura ou escrita de
+// TAMANHO_PAGINA_BYTES bytes por página
 Pagina lerPaginaDeStream(std::ifstream &stream, int &io_count) {
-  Pagina p;
-  std::string line;
-  bool pageRead = false;
-  for (int i = 0; i < MAX_TUPLES_PER_PAGE; ++i) {
-    if (std::getline(stream, line)) {
-      if (!line.empty()) {
-        p.adicionarTupla(Tupla::fromString(line));
-        pageRead = true;
-      }
-    } else {
-      break; // Fim do arquivo
-    }
+  char buffer[TAMANHO_PAGINA_BYTES];
+  if (!stream.read(buffer, TAMANHO_PAGINA_BYTES)) {
+    return Pagina(); // Fim do arquivo (ou página incompleta)
   }
-  if (pageRead) {
+  Pagina p = Pagina::desserializar(buffer);
+  if (!p.isEmpty()) {
     io_count++; // Contabiliza uma leitura de página
   }
   return p;
@@ -64,11 +44,29 @@ Pagina lerPaginaDeStream(std::ifstream &stream, int &io_count) {
 
 void escreverPaginaEmStream(std::ofstream &stream, const Pagina &pagina,
                             int &io_count) {
-  for (int i = 0; i < pagina.qtd_tuplas_ocup; ++i) {
-    stream << pagina.tuplas[i].toString() << std::endl;
+  if (pagina.qtd_tuplas_ocup == 0) {
+    return; // Só contabiliza se algo foi realmente escrito
   }
-  if (pagina.qtd_tuplas_ocup >
-      0) {      // Só contabiliza se algo foi realmente escrito
-    io_count++; // Contabiliza uma escrita de página
+  char buffer[TAMANHO_PAGINA_BYTES];
+  if (!pagina.serializar(buffer)) {
+    std::cerr << "Erro: As tuplas não cabem em uma página de "
+              << TAMANHO_PAGINA_BYTES << " bytes." << std::endl;
+    stream.setstate(std::ios::failbit); // Quem grava vê a falha no stream
+    return;
   }
+  stream.write(buffer, TAMANHO_PAGINA_BYTES);
+  io_count++; // Contabiliza uma escrita de página
+}
+
+Pagina lerPaginaNumero(std::ifstream &arquivo, long long numero,
+                       int &io_count) {
+  arquivo.clear();
+  arquivo.seekg(numero * TAMANHO_PAGINA_BYTES);
+  return lerPaginaDeStream(arquivo, io_count);
+}
+
+long long numeroDePaginas(const std::string &arquivo) {
+  std::error_code erro;
+  std::uintmax_t bytes = std::filesystem::file_size(arquivo, erro);
+  return erro ? 0 : static_cast<long long>(bytes / TAMANHO_PAGINA_BYTES);
 }
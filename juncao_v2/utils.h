@@ -5,17 +5,25 @@
 #include <string>
 #include <vector>
 
-// Função para ler uma página de um arquivo
-Pagina lerPaginaDeArquivo(std::ifstream &arquivo, int &io_count);
+// Arquivos de páginas (runs e arquivos ordenados) são sequências de páginas
+// binárias de TAMANHO_PAGINA_BYTES bytes, abertos com ios::binary.
+
+// Função para ler um bloco de até num_paginas páginas de tuplas de um arquivo
+std::vector<Tupla> lerBlocoDeTuplas(std::ifstream &arquivo, int num_paginas,
+                                    int &io_count);
+
+// Função auxiliar para obter o valor de uma coluna de uma tupla (sem cópia)
+const Valor &getColunaValue(const Tupla &tupla, int indiceColuna);
+
+// Função para ler a próxima página de um arquivo; vazia no fim do arquivo
+Pagina lerPaginaDeStream(std::ifstream &stream, int &io_count);
 
 // Função para escrever uma página em um arquivo
-void escreverPaginaEmArquivo(std::ofstream &arquivo, const Pagina &pagina,
-                             int &io_count);
+void escreverPaginaEmStream(std::ofstream &stream, const Pagina &pagina,
+                            int &io_count);
 
-// Função para ler todas as tuplas de um arquivo (para runs)
-std::vector<Tupla> lerTodasTuplasDeArquivo(const std::string &nomeArquivo,
-                                           int &io_count);
+// Lê a página numero do arquivo; vazia se ela não existir
+Pagina lerPaginaNumero(std::ifstream &arquivo, long long numero, int &io_count);
 
-// Função para escrever um vetor de tuplas em um arquivo (para runs)
-void escreverTuplasEmArquivo(const std::string &nomeArquivo,
-                             const std::vector<Tupla> &tuplas, int &io_count);
+// Número de páginas de um arquivo de páginas (run ou arquivo ordenado)
+long long numeroDePaginas(const std::string &arquivo);
@@ -0,0 +1,126 @@
+#include "valor.h"
+#include <charconv>
+#include <cstdint>
+#include <functional>
+
+using namespace std;
+
+const char *nomeTipo(TipoColuna tipo) {
+  switch (tipo) {
+  case TipoColuna::INTEIRO:
+    return "inteiro";
+  case TipoColuna::REAL:
+    return "real";
+  case TipoColuna::TEXTO:
+    return "texto";
+  }
+  return "";
+}
+
+static bool lerInteiro(const string &texto, long long &saida) {
+  const char *fim = texto.data() + texto.size();
+  auto r = from_chars(texto.data(), fim, saida);
+  return !texto.empty() && r.ec == errc() && r.ptr == fim;
+}
+
+static bool lerReal(const string &texto, double &saida) {
+  const char *fim = texto.data() + texto.size();
+  auto r = from_chars(texto.data(), fim, saida);
+  return !texto.empty() && r.ec == errc() && r.ptr == fim;
+}
+
+bool converterValor(const string &texto, TipoColuna tipo, Valor &valor) {
+  if (tipo == TipoColuna::INTEIRO) {
+    long long inteiro;
+    if (lerInteiro(texto, inteiro)) {
+      valor = inteiro;
+      return true;
+    }
+  } else if (tipo == TipoColuna::REAL) {
+    double real;
+    if (lerReal(texto, real)) {
+      valor = real;
+      return true;
+    }
+  } else {
+    valor = texto;
+    return true;
+  }
+  valor = texto;
+  return false;
+}
+
+TipoColuna inferirTipo(const string &texto) {
+  // Só escolhe um tipo numérico se a conversão preserva o texto: "007" ou
+  // "1.50" continuam texto, para que a saída da junção seja igual à entrada.
+  long long inteiro;
+  if (lerInteiro(texto, inteiro) && to_string(inteiro) == texto)
+    return TipoColuna::INTEIRO;
+  double real;
+  if (lerReal(texto, real) && valorParaTexto(Valor(real)) == texto)
+    return TipoColuna::REAL;
+  return TipoColuna::TEXTO;
+}
+
+string valorParaTexto(const Valor &valor) {
+  if (const long long *inteiro = get_if<long long>(&valor))
+    return to_string(*inteiro);
+  if (const double *real = get_if<double>(&valor)) {
+    char buffer[32];
+    auto r = to_chars(buffer, buffer + sizeof(buffer), *real);
+    return string(buffer, r.ptr);
+  }
+  return get<string>(valor);
+}
+
+int compararValores(const Valor &a, const Valor &b, bool comoTexto) {
+  if (comoTexto && !(holds_alternative<string>(a) && holds_alternative<string>(b)))
+    return valorParaTexto(a).compare(valorParaTexto(b));
+  if (a.index() == b.index()) {
+    if (const long long *ia = get_if<long long>(&a)) {
+      long long ib = get<long long>(b);
+      return *ia < ib ? -1 : *ia > ib ? 1 : 0;
+    }
+    if (const double *da = get_if<double>(&a)) {
+      double db = get<double>(b);
+      return *da < db ? -1 : *da > db ? 1 : 0;
+    }
+    return get<string>(a).compare(get<string>(b));
+  }
+  bool numeroA = !holds_alternative<string>(a);
+  bool numeroB = !holds_alternative<string>(b);
+  if (numeroA && numeroB) {
+    double da = holds_alternative<long long>(a) ? get<long long>(a) : get<double>(a);
+    double db = holds_alternative<long long>(b) ? get<long long>(b) : get<double>(b);
+    return da < db ? -1 : da > db ? 1 : 0;
+  }
+  // Número antes de texto: comparar pela representação em texto tornaria a
+  // ordem intransitiva (9 < 10, 10 < "10x", mas "10x" < 9) e as ordenações
+  // externas sairiam fora de ordem
+  return numeroA ? -1 : 1;
+}
+
+size_t hashValor(const Valor &valor, bool comoTexto) {
+  if (comoTexto)
+    return hash<string>()(valorParaTexto(valor));
+  if (const long long *inteiro = get_if<long long>(&valor))
+    return hash<long long>()(*inteiro);
+  if (const double *real = get_if<double>(&valor)) {
+    // Reais com valor inteiro têm o hash do inteiro: 3 e 3.0 são iguais
+    if (*real >= -9.2e18 && *real <= 9.2e18 &&
+        static_cast<double>(static_cast<long long>(*real)) == *real)
+      return hash<long long>()(static_cast<long long>(*real));
+    return hash<double>()(*real);
+  }
+  return hash<string>()(get<string>(valor));
+}
+
+size_t particaoDaChave(const Valor &chave, bool comoTexto, int nivel,
+                       size_t numParticoes) {
+  uint64_t x = static_cast<uint64_t>(hashValor(chave, comoTexto)) +
+               0x9e3779b97f4a7c15ULL * static_cast<uint64_t>(nivel + 1);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return static_cast<size_t>(x % numParticoes);
+}
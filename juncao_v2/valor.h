@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace std;
+
+// Tipos de coluna do esquema de uma Tabela
+enum class TipoColuna { INTEIRO, REAL, TEXTO };
+
+// Valor de uma coluna, convertido uma única vez na carga da tabela
+using Valor = variant<long long, double, string>;
+
+const char *nomeTipo(TipoColuna tipo);
+
+// Converte o texto para o tipo pedido. Se o texto não for um número válido
+// para INTEIRO/REAL, devolve false e o valor fica como texto.
+bool converterValor(const string &texto, TipoColuna tipo, Valor &valor);
+
+// Tipo mais específico que representa o texto sem alterá-lo ao ser impresso:
+// INTEIRO, REAL ou TEXTO.
+TipoColuna inferirTipo(const string &texto);
+
+string valorParaTexto(const Valor &valor);
+
+// <0, 0 ou >0. Inteiros e reais se comparam numericamente e todo número vem
+// antes de todo texto (um valor que não converteu para o tipo declarado da
+// coluna), de forma que a ordem é total e nunca há número igual a texto. Com
+// comoTexto, todos os valores são comparados pelo texto: é a ordem em que se
+// ordenam as chaves de uma junção texto x número, para que o merge veja os
+// dois lados na mesma ordem.
+int compararValores(const Valor &a, const Valor &b, bool comoTexto = false);
+
+// Hash compatível com valorIgual: inteiros e reais iguais têm o mesmo hash.
+// Com comoTexto, usa a representação em texto, que é como compararValores
+// compara texto com número nesse caso.
+size_t hashValor(const Valor &valor, bool comoTexto = false);
+
+// Partição da chave entre numParticoes nas junções hash, no nível de
+// particionamento nivel (0 no primeiro). O hash passa pelo finalizador do
+// splitmix64 com uma semente por nível: as partições usam todos os bits
+// (inteiros pequenos têm hash igual ao próprio valor) e as tuplas de uma
+// partição voltam a se espalhar quando ela é particionada de novo.
+size_t particaoDaChave(const Valor &chave, bool comoTexto, int nivel,
+                       size_t numParticoes);
+
+// Caminho rápido das ordenações e junções: chaves inteiras são comparadas
+// diretamente, sem passar por compararValores.
+inline bool valorMenor(const Valor &a, const Valor &b, bool comoTexto = false) {
+  const long long *ia = get_if<long long>(&a);
+  const long long *ib = get_if<long long>(&b);
+  if (ia && ib && !comoTexto)
+    return *ia < *ib;
+  return compararValores(a, b, comoTexto) < 0;
+}
+
+inline bool valorIgual(const Valor &a, const Valor &b, bool comoTexto = false) {
+  const long long *ia = get_if<long long>(&a);
+  const long long *ib = get_if<long long>(&b);
+  if (ia && ib && !comoTexto)
+    return *ia == *ib;
+  return compararValores(a, b, comoTexto) == 0;
+}
@@ -0,0 +1,140 @@
+#include "operador.h"
+#include "plano.h"
+#include "tabela.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Verificações das junções: cada caso gera as tabelas, roda todos os
+// algoritmos do Operador e o plano equivalente de iteradores e compara a
+// quantidade de tuplas com a contada em memória. Sai com 1 se algum
+// resultado divergir. Uso: make verificar
+
+static int falhas = 0;
+
+static void conferir(const string &caso, const string &algoritmo,
+                     long long obtidas, long long esperadas) {
+  bool ok = obtidas == esperadas;
+  cout << (ok ? "ok    " : "FALHOU") << " " << caso << " / " << algoritmo
+       << ": " << obtidas << " tuplas";
+  if (!ok) {
+    cout << " (esperadas " << esperadas << ")";
+    falhas++;
+  }
+  cout << "\n";
+}
+
+// CSV id,k com a chave k de cada linha
+static void gravarTabela(const string &arquivo, const vector<string> &chaves) {
+  ofstream csv(arquivo);
+  csv << "id,k\n";
+  for (size_t i = 0; i < chaves.size(); ++i)
+    csv << i << "," << chaves[i] << "\n";
+}
+
+static long long tuplasDoPlano(Iterador &plano) {
+  long long tuplas = 0;
+  plano.abrir();
+  for (Pagina pagina = plano.proximaPagina(); !pagina.isEmpty();
+       pagina = plano.proximaPagina())
+    tuplas += pagina.qtd_tuplas_ocup;
+  plano.fechar();
+  return tuplas;
+}
+
+static void verificarJuncao(const string &caso, const vector<string> &chaves1,
+                            const vector<string> &chaves2,
+                            const vector<TipoColuna> &tipos1,
+                            const vector<TipoColuna> &tipos2) {
+  string arquivo1 = caso + "_a.csv", arquivo2 = caso + "_b.csv";
+  gravarTabela(arquivo1, chaves1);
+  gravarTabela(arquivo2, chaves2);
+
+  // Pelo texto das chaves: os valores que não convertem ficam como texto e
+  // só se juntam com o mesmo texto
+  map<string, long long> contagem;
+  for (const string &chave : chaves2)
+    contagem[chave]++;
+  long long esperadas = 0;
+  for (const string &chave : chaves1)
+    esperadas += contagem[chave];
+
+  const AlgoritmoJuncao algoritmos[] = {AlgoritmoJuncao::SORT_MERGE,
+                                        AlgoritmoJuncao::HASH,
+                                        AlgoritmoJuncao::BLOCO_ANINHADO};
+  for (AlgoritmoJuncao algoritmo : algoritmos) {
+    Tabela tabela1{arquivo1, tipos1};
+    Tabela tabela2{arquivo2, tipos2};
+    tabela1.carregarDados();
+    tabela2.carregarDados();
+    Operador op{tabela1, tabela2, "k", "k", algoritmo};
+    op.definirPaginasMemoria(3);
+    op.definirArquivoResultado("");
+    op.executar();
+    conferir(caso, Operador::nomeAlgoritmo(algoritmo), op.numTuplasGeradas(),
+             esperadas);
+  }
+
+  bool comoTexto = tipos1[1] != tipos2[1] && (tipos1[1] == TipoColuna::TEXTO ||
+                                              tipos2[1] == TipoColuna::TEXTO);
+  Tabela tabela1{arquivo1, tipos1};
+  Tabela tabela2{arquivo2, tipos2};
+  tabela1.carregarDados();
+  tabela2.carregarDados();
+  JuncaoMerge merge(
+      make_unique<Ordenacao>(make_unique<Varredura>(tabela1), "k", 3,
+                             comoTexto),
+      make_unique<Ordenacao>(make_unique<Varredura>(tabela2), "k", 3,
+                             comoTexto),
+      "k", "k");
+  conferir(caso, "plano JuncaoMerge", tuplasDoPlano(merge), esperadas);
+  JuncaoHash hash(make_unique<Varredura>(tabela1),
+                  make_unique<Varredura>(tabela2), "k", "k", 3);
+  conferir(caso, "plano JuncaoHash", tuplasDoPlano(hash), esperadas);
+
+  for (const string &arquivo : {arquivo1, arquivo2}) {
+    filesystem::remove(arquivo);
+    filesystem::remove(arquivo + "_ordenado.pag");
+  }
+  filesystem::remove_all("data/" + caso + "_a");
+  filesystem::remove_all("data/" + caso + "_b");
+}
+
+int main() {
+  mt19937 gerador(7);
+  uniform_int_distribution<int> chave(0, 400);
+  bernoulli_distribution invalida(0.18);
+  auto gerarChaves = [&](size_t quantidade, bool comTexto) {
+    vector<string> chaves;
+    for (size_t i = 0; i < quantidade; ++i) {
+      string texto = to_string(chave(gerador));
+      chaves.push_back(comTexto && invalida(gerador) ? texto + "x" : texto);
+    }
+    return chaves;
+  };
+
+  // Coluna declarada INTEIRO com ~18% de valores como "123x", que ficam como
+  // texto: a ordenação externa precisa de uma ordem total entre números e
+  // texto para que o sort-merge encontre todos os pares
+  verificarJuncao("verificacao_mista", gerarChaves(800, true),
+                  gerarChaves(600, true),
+                  {TipoColuna::INTEIRO, TipoColuna::INTEIRO},
+                  {TipoColuna::INTEIRO, TipoColuna::INTEIRO});
+  // Coluna texto x coluna inteira: as chaves são comparadas pelo texto em
+  // todos os algoritmos
+  verificarJuncao("verificacao_texto", gerarChaves(800, true),
+                  gerarChaves(600, false),
+                  {TipoColuna::INTEIRO, TipoColuna::TEXTO},
+                  {TipoColuna::INTEIRO, TipoColuna::INTEIRO});
+
+  cout << (falhas == 0 ? "Todas as verificações passaram."
+                       : to_string(falhas) + " verificações falharam.")
+       << endl;
+  return falhas == 0 ? 0 : 1;
+}